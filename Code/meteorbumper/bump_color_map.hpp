@@ -1,8 +1,13 @@
 #pragma once
 
+#include "bump_die.hpp"
+#include "bump_span.hpp"
+
 #include <glm/glm.hpp>
 
+#include <algorithm>
 #include <map>
+#include <vector>
 
 namespace bump
 {
@@ -14,5 +19,56 @@ namespace bump
 
 	float catmull_rom(float p0, float p1, float p2, float p3, float t);
 	float get_size_from_map(std::map<float, float> const& size_map, float a);
+
+	inline glm::vec4 get_value_from_map(std::map<float, glm::vec4> const& map, float a) { return get_color_from_map(map, a); }
+	inline float get_value_from_map(std::map<float, float> const& map, float a) { return get_size_from_map(map, a); }
+
+	// a color / size map baked into a fixed number of evenly spaced samples over [0, 1].
+	// evaluation is a clamp, an index and a lerp (no map lookup or spline evaluation).
+	template<class T>
+	class curve_lut
+	{
+	public:
+
+		curve_lut() = default;
+
+		explicit curve_lut(std::map<float, T> const& map, std::size_t resolution = 256)
+		{
+			die_if(resolution < 2);
+
+			if (map.empty())
+				return;
+
+			m_samples.reserve(resolution);
+
+			for (auto i = std::size_t{ 0 }; i != resolution; ++i)
+				m_samples.push_back(get_value_from_map(map, float(i) / float(resolution - 1)));
+		}
+
+		bool is_empty() const { return m_samples.empty(); }
+
+		T evaluate(float a) const
+		{
+			die_if(is_empty());
+
+			auto const x = std::clamp(a, 0.f, 1.f) * float(m_samples.size() - 1);
+			auto const i = std::min(std::size_t(x), m_samples.size() - 2);
+
+			return glm::mix(m_samples[i], m_samples[i + 1], x - float(i));
+		}
+
+		// note: a and output must be the same size.
+		void evaluate(span<float const> a, span<T> output) const
+		{
+			die_if(a.size() != output.size());
+
+			for (auto i = std::size_t{ 0 }; i != a.size(); ++i)
+				output.at(i) = evaluate(a.at(i));
+		}
+
+	private:
+
+		std::vector<T> m_samples;
+	};
 	
 } // bump
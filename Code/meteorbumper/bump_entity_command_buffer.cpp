@@ -0,0 +1,103 @@
+#include "bump_entity_command_buffer.hpp"
+
+#include "bump_narrow_cast.hpp"
+
+#include <Tracy.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace bump
+{
+
+	entity_command_buffer::lane::lane(entity_command_buffer& buffer, std::uint32_t index):
+		m_buffer(&buffer),
+		m_index(index),
+		m_reserved_count(0) { }
+
+	void entity_command_buffer::lane::push(command_type command)
+	{
+		m_commands.push_back(std::move(command));
+	}
+
+	entity_command_buffer::reserved_entity entity_command_buffer::lane::create()
+	{
+		auto const id = reserved_entity{ m_index, m_reserved_count++ };
+
+		push([buffer = m_buffer, id] (entt::registry& registry)
+		{
+			buffer->m_created[id.m_lane][id.m_index] = registry.create();
+		});
+
+		return id;
+	}
+
+	void entity_command_buffer::lane::destroy(entt::entity id)
+	{
+		push([id] (entt::registry& registry)
+		{
+			if (registry.valid(id))
+				registry.destroy(id);
+		});
+	}
+
+	void entity_command_buffer::lane::destroy(reserved_entity id)
+	{
+		push([buffer = m_buffer, id] (entt::registry& registry)
+		{
+			auto const entity = buffer->get_entity(id);
+
+			if (registry.valid(entity))
+				registry.destroy(entity);
+		});
+	}
+
+	entity_command_buffer::entity_command_buffer(std::size_t lane_count):
+		m_apply_commands(lane_count),
+		m_created(lane_count)
+	{
+		die_if(lane_count == 0);
+
+		m_lanes.reserve(lane_count);
+
+		for (auto i = std::size_t{ 0 }; i != lane_count; ++i)
+			m_lanes.push_back(lane(*this, narrow_cast<std::uint32_t>(i)));
+	}
+
+	void entity_command_buffer::apply(entt::registry& registry)
+	{
+		ZoneScopedN("entity_command_buffer::apply()");
+
+		// take everything first, so anything recorded while applying is left for the next call
+		for (auto i = std::size_t{ 0 }; i != m_lanes.size(); ++i)
+		{
+			std::swap(m_lanes[i].m_commands, m_apply_commands[i]);
+			m_created[i].assign(m_lanes[i].m_reserved_count, entt::null);
+			m_lanes[i].m_reserved_count = 0;
+		}
+
+		for (auto& commands : m_apply_commands)
+		{
+			for (auto& c : commands)
+				c(registry);
+
+			commands.clear();
+		}
+	}
+
+	bool entity_command_buffer::is_empty() const
+	{
+		return std::all_of(m_lanes.begin(), m_lanes.end(), [] (lane const& l) { return l.is_empty(); });
+	}
+
+	entt::entity entity_command_buffer::get_entity(reserved_entity id) const
+	{
+		die_if(id.m_lane >= m_created.size() || id.m_index >= m_created[id.m_lane].size());
+
+		auto const entity = m_created[id.m_lane][id.m_index];
+		die_if(entity == entt::null); // used in an earlier lane than the one that reserved it
+
+		return entity;
+	}
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "bump_die.hpp"
+
+#include <entt.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace bump
+{
+
+	// records changes to the registry (from collider callbacks, worker threads, etc.) to be applied later in one batch.
+	// commands are recorded into lanes. a lane must only be recorded to by one thread at a time (e.g. one lane per worker).
+	// apply() runs lane 0's commands in order, then lane 1's, etc., so the result doesn't depend on thread timing.
+	// apply() must only be called when nothing is recording, and nothing else is using the registry.
+	class entity_command_buffer
+	{
+	public:
+
+		using command_type = std::function<void(entt::registry&)>;
+
+		// an entity that's created when the buffer is applied.
+		// note: can only be used in the lane that reserved it, or a later one (it doesn't exist until its lane is applied).
+		struct reserved_entity
+		{
+			std::uint32_t m_lane;
+			std::uint32_t m_index;
+		};
+
+		class lane
+		{
+		public:
+
+			void push(command_type command);
+
+			reserved_entity create();
+			void destroy(entt::entity id);
+			void destroy(reserved_entity id);
+
+			// IdT is entt::entity or reserved_entity
+			template<class ComponentT, class IdT, class... Args>
+			void emplace(IdT id, Args&&... args);
+
+			bool is_empty() const { return m_commands.empty(); }
+
+		private:
+
+			friend class entity_command_buffer;
+
+			lane(entity_command_buffer& buffer, std::uint32_t index);
+
+			entity_command_buffer* m_buffer;
+			std::uint32_t m_index;
+			std::uint32_t m_reserved_count; // entities reserved since the last apply()
+			std::vector<command_type> m_commands;
+		};
+
+		explicit entity_command_buffer(std::size_t lane_count = 1);
+
+		entity_command_buffer(entity_command_buffer const&) = delete;
+		entity_command_buffer& operator=(entity_command_buffer const&) = delete;
+		entity_command_buffer(entity_command_buffer&&) = delete;
+		entity_command_buffer& operator=(entity_command_buffer&&) = delete;
+
+		std::size_t get_lane_count() const { return m_lanes.size(); }
+		lane& get_lane(std::size_t index) { die_if(index >= m_lanes.size()); return m_lanes[index]; }
+
+		// record to lane 0 (i.e. from the main thread)
+		void push(command_type command) { m_lanes.front().push(std::move(command)); }
+		reserved_entity create() { return m_lanes.front().create(); }
+		void destroy(entt::entity id) { m_lanes.front().destroy(id); }
+		void destroy(reserved_entity id) { m_lanes.front().destroy(id); }
+
+		template<class ComponentT, class IdT, class... Args>
+		void emplace(IdT id, Args&&... args) { m_lanes.front().template emplace<ComponentT>(id, std::forward<Args>(args)...); }
+
+		// applies the recorded commands, and clears the buffer.
+		// note: commands recorded while applying are kept for the next call.
+		void apply(entt::registry& registry);
+
+		bool is_empty() const;
+
+	private:
+
+		entt::entity get_entity(entt::entity id) const { return id; }
+		entt::entity get_entity(reserved_entity id) const; // only while applying
+
+		std::vector<lane> m_lanes;
+		std::vector<std::vector<command_type>> m_apply_commands; // per lane
+		std::vector<std::vector<entt::entity>> m_created; // per lane, the entities created for the reserved entities
+	};
+
+	template<class ComponentT, class IdT, class... Args>
+	void entity_command_buffer::lane::emplace(IdT id, Args&&... args)
+	{
+		push([buffer = m_buffer, id, component = ComponentT{ std::forward<Args>(args)... }] (entt::registry& registry)
+		{
+			auto const entity = buffer->get_entity(id);
+
+			if (registry.valid(entity))
+				registry.emplace_or_replace<ComponentT>(entity, component);
+		});
+	}
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "bump_entity_pool.hpp"
+
+#include "bump_die.hpp"
+
+#include <Tracy.hpp>
+
+namespace bump
+{
+
+	entity_pool::entity_pool(entt::registry& registry):
+		m_registry(registry) { }
+
+	entity_pool::~entity_pool()
+	{
+		clear();
+	}
+
+	entt::entity entity_pool::create()
+	{
+		if (m_inactive.empty())
+		{
+			++m_stats.m_created;
+			return m_registry.create();
+		}
+
+		auto id = m_inactive.back();
+		m_inactive.pop_back();
+
+		m_registry.remove<inactive_tag>(id);
+		++m_stats.m_recycled;
+
+		return id;
+	}
+
+	void entity_pool::release(entt::entity id)
+	{
+		die_if(!m_registry.valid(id));
+		die_if(m_registry.has<inactive_tag>(id));
+
+		m_registry.emplace<inactive_tag>(id);
+		m_inactive.push_back(id);
+		++m_stats.m_released;
+	}
+
+	void entity_pool::clear()
+	{
+		ZoneScopedN("entity_pool::clear()");
+
+		m_registry.destroy(m_inactive.begin(), m_inactive.end());
+		m_stats.m_destroyed += m_inactive.size();
+		m_inactive.clear();
+	}
+
+} // bump
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <entt.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace bump
+{
+
+	class inactive_tag { }; // empty tag type to identify pooled entities that aren't currently in use
+
+	// recycles short-lived entities instead of creating and destroying them.
+	// released entities keep their components (so recycling doesn't touch the component pools),
+	// and are marked with an inactive_tag, which hot views should exclude.
+	class entity_pool
+	{
+	public:
+
+		struct churn_stats
+		{
+			std::size_t m_created = 0;   // entities created in the registry
+			std::size_t m_recycled = 0;  // entities reused from the pool
+			std::size_t m_released = 0;  // entities returned to the pool
+			std::size_t m_destroyed = 0; // entities destroyed in the registry
+		};
+
+		explicit entity_pool(entt::registry& registry);
+
+		entity_pool(entity_pool const&) = delete;
+		entity_pool& operator=(entity_pool const&) = delete;
+		entity_pool(entity_pool&&) = delete;
+		entity_pool& operator=(entity_pool&&) = delete;
+
+		~entity_pool();
+
+		// note: recycled entities still have the components they were released with (use emplace_or_replace to reset them).
+		entt::entity create();
+		void release(entt::entity id);
+
+		void clear(); // destroys the inactive entities
+
+		std::size_t get_inactive_count() const { return m_inactive.size(); }
+
+		churn_stats const& get_stats() const { return m_stats; }
+		void reset_stats() { m_stats = churn_stats(); }
+
+	private:
+
+		entt::registry& m_registry;
+		std::vector<entt::entity> m_inactive;
+		churn_stats m_stats;
+	};
+
+} // bump
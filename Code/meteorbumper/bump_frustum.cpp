@@ -0,0 +1,88 @@
+#include "bump_frustum.hpp"
+
+#include "bump_die.hpp"
+
+#include <algorithm>
+
+namespace bump
+{
+
+	frustum::frustum():
+		m_x{ }, m_y{ }, m_z{ }, m_d{ }
+	{
+
+	}
+
+	frustum::frustum(glm::mat4 const& view_projection)
+	{
+		// gribb / hartmann: the planes are sums / differences of the rows of the matrix (glm is column major, so m[c][r])
+		auto const row = [&] (int r) { return glm::vec4(view_projection[0][r], view_projection[1][r], view_projection[2][r], view_projection[3][r]); };
+
+		auto const planes = std::array<glm::vec4, 6>
+		{
+			row(3) + row(0), // left
+			row(3) - row(0), // right
+			row(3) + row(1), // bottom
+			row(3) - row(1), // top
+			row(3) + row(2), // near
+			row(3) - row(2), // far
+		};
+
+		for (auto i = std::size_t{ 0 }; i != planes.size(); ++i)
+		{
+			auto const p = planes[i] / glm::length(glm::vec3(planes[i]));
+
+			m_x[i] = p.x;
+			m_y[i] = p.y;
+			m_z[i] = p.z;
+			m_d[i] = p.w;
+		}
+	}
+
+	bool frustum::is_sphere_visible(glm::vec3 center, float radius) const
+	{
+		for (auto i = std::size_t{ 0 }; i != m_d.size(); ++i)
+			if (m_x[i] * center.x + m_y[i] * center.y + m_z[i] * center.z + m_d[i] < -radius)
+				return false;
+
+		return true;
+	}
+
+	void frustum::cull_spheres(span<glm::vec3 const> centers, span<float const> radii, std::vector<std::uint32_t>& visible) const
+	{
+		die_if(centers.size() != radii.size());
+
+		auto const batch_size = std::size_t{ 8 };
+
+		for (auto first = std::size_t{ 0 }; first < centers.size(); first += batch_size)
+		{
+			auto const count = std::min(batch_size, centers.size() - first);
+
+			// gather the batch (the tail of the last batch is padded with empty spheres at the origin)
+			float x[batch_size] = { }, y[batch_size] = { }, z[batch_size] = { }, r[batch_size] = { };
+
+			for (auto i = std::size_t{ 0 }; i != count; ++i)
+			{
+				auto const& c = centers.data()[first + i];
+
+				x[i] = c.x;
+				y[i] = c.y;
+				z[i] = c.z;
+				r[i] = radii.data()[first + i];
+			}
+
+			// test every sphere in the batch against each plane
+			std::uint32_t inside[batch_size];
+			std::fill(std::begin(inside), std::end(inside), 1u);
+
+			for (auto p = std::size_t{ 0 }; p != m_d.size(); ++p)
+				for (auto i = std::size_t{ 0 }; i != batch_size; ++i)
+					inside[i] &= std::uint32_t(m_x[p] * x[i] + m_y[p] * y[i] + m_z[p] * z[i] + m_d[p] >= -r[i]);
+
+			for (auto i = std::size_t{ 0 }; i != count; ++i)
+				if (inside[i])
+					visible.push_back(std::uint32_t(first + i));
+		}
+	}
+	
+} // bump
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "bump_span.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace bump
+{
+
+	// the six clip planes of a view projection matrix (normals point inwards, so a point is inside if dot(n, p) + d >= 0 for all planes).
+	class frustum
+	{
+	public:
+
+		frustum();
+		explicit frustum(glm::mat4 const& view_projection);
+
+		bool is_sphere_visible(glm::vec3 center, float radius) const;
+
+		// appends the indices of the spheres that are at least partly inside the frustum to visible.
+		// note: spheres are tested in fixed size batches against all the planes at once (laid out so the compiler can vectorize it).
+		void cull_spheres(span<glm::vec3 const> centers, span<float const> radii, std::vector<std::uint32_t>& visible) const;
+
+	private:
+
+		// plane components stored separately (x, y, z, d) for batch testing
+		std::array<float, 6> m_x, m_y, m_z, m_d;
+	};
+	
+} // bump
\ No newline at end of file
@@ -39,8 +39,8 @@ namespace bump
 				{ "crosshair", { "crosshair.vert", "crosshair.frag" } },
 				{ "player_laser", { "player_laser.vert", "player_laser.geom", "g_buffers_write.frag", "player_laser.frag" } },
 				{ "fps_counter", { "fps_counter.vert", "fps_counter.frag" } },
-				{ "powerup_depth", { "default_material_depth.vert", "default_material_depth.frag" } },
-				{ "powerup", { "default_material.vert", "g_buffers_write.frag", "default_material.frag" } },
+				{ "powerup_depth", { "default_material_instanced_depth.vert", "default_material_depth.frag" } },
+				{ "powerup", { "default_material_instanced.vert", "g_buffers_write.frag", "default_material.frag" } },
 				{ "tone_mapping", { "tone_mapping.vert", "tone_mapping.frag" } },
 				{ "light_directional", { "light_directional.vert", "g_buffers_read.frag", "lighting.frag", "light_directional.frag" } },
 				{ "light_point", { "light_point.vert", "g_buffers_read.frag", "lighting.frag", "light_point.frag" } },
@@ -61,7 +61,6 @@ namespace bump
 				{ "powerup_shield", "powerup_shield.mbp_model" },
 				{ "powerup_armor", "powerup_armor.mbp_model" },
 				{ "powerup_lasers", "powerup_lasers.mbp_model" },
-				{ "point_light", "point_light.mbp_model" },
 				{ "asteroid_fragment_0", "asteroid_fragment_0.mbp_model" },
 				{ "asteroid_fragment_1", "asteroid_fragment_1.mbp_model" },
 				{ "asteroid_fragment_2", "asteroid_fragment_2.mbp_model" },
@@ -3,11 +3,16 @@
 #include "bump_die.hpp"
 #include "bump_ends_with.hpp"
 #include "bump_game_app.hpp"
+#include "bump_gl_program_cache.hpp"
+#include "bump_hash.hpp"
 #include "bump_load_gl_cubemap.hpp"
 #include "bump_log.hpp"
+#include "bump_time.hpp"
 
 #include <array>
 #include <fstream>
+#include <optional>
+#include <unordered_map>
 
 namespace bump
 {
@@ -47,6 +52,31 @@ namespace bump
 				return GL_VERTEX_SHADER;
 			}
 
+			std::string get_gl_string(GLenum name)
+			{
+				auto const str = reinterpret_cast<char const*>(glGetString(name));
+				return str ? std::string(str) : std::string();
+			}
+
+			// program binaries are only valid for the driver that created them
+			std::uint64_t get_driver_hash()
+			{
+				auto hash = fnv1a_64(get_gl_string(GL_VENDOR));
+				hash = fnv1a_64(get_gl_string(GL_RENDERER), hash);
+				hash = fnv1a_64(get_gl_string(GL_VERSION), hash);
+				hash = fnv1a_64(get_gl_string(GL_SHADING_LANGUAGE_VERSION), hash);
+				return hash;
+			}
+
+			// shared by every program that uses the file (the stage is given by the file extension,
+			// so the file name is enough to identify it). only compiled if a program needs compiling.
+			struct shader_file
+			{
+				std::string m_source;
+				GLenum m_type;
+				std::optional<gl::shader_object> m_object;
+			};
+
 		} // unnamed
 		
 		assets load_assets(app& app, 
@@ -106,43 +136,124 @@ namespace bump
 
 			// load shaders:
 			{
-				for (auto const& metadata : shaders)
+				auto const start_time = high_res_clock_t::now();
+
+				auto const use_binaries = gl::shader_program::is_program_binary_supported();
+				auto const driver_hash = use_binaries ? get_driver_hash() : std::uint64_t{ 0 };
+				auto cache = gl::program_cache("shader_cache.bin");
+
+				auto cached_count = std::size_t{ 0 };
+				auto compiled_count = std::size_t{ 0 };
+
+				auto binary_time = high_res_duration_t{ 0 };
+				auto compile_time = high_res_duration_t{ 0 };
+				auto link_time = high_res_duration_t{ 0 };
+
+				auto files = std::unordered_map<std::string, shader_file>();
+
+				auto const get_file = [&] (std::string const& filename) -> shader_file&
 				{
-					auto objects = std::vector<gl::shader_object>();
+					auto f = files.find(filename);
 
-					for (auto const& file : metadata.m_filenames)
+					if (f == files.end())
+						f = files.insert({ filename, shader_file{ read_file_to_string("data/shaders/" + filename), get_shader_type(filename), std::nullopt } }).first;
+
+					return f->second;
+				};
+
+				auto const get_object = [&] (std::string const& filename, std::string const& shader_name) -> gl::shader_object const&
+				{
+					auto& file = get_file(filename);
+
+					if (!file.m_object)
 					{
-						auto source = read_file_to_string("data/shaders/" + file);
-						auto type = get_shader_type(file);
+						auto const start = high_res_clock_t::now();
 
-						auto object = gl::shader_object(type);
-						object.set_source(source);
+						auto& object = file.m_object.emplace(file.m_type);
+						object.set_source(file.m_source);
 
 						if (!object.compile())
 						{
-							log_error("Failed to compile shader object: " + file + " for shader asset: " + metadata.m_name);
+							log_error("Failed to compile shader object: " + filename + " for shader asset: " + shader_name);
 							log_error(object.get_log());
 						}
 
-						objects.push_back(std::move(object));
+						compile_time += high_res_clock_t::now() - start;
 					}
 
-					die_if(!std::all_of(objects.begin(), objects.end(), [] (gl::shader_object const& o) { return o.is_compiled(); }));
+					return *file.m_object;
+				};
+
+				for (auto const& metadata : shaders)
+				{
+					// the key changes if any of the sources (or the driver) change
+					auto key = driver_hash;
+
+					for (auto const& filename : metadata.m_filenames)
+					{
+						key = fnv1a_64(filename, key);
+						key = fnv1a_64(get_file(filename).m_source, key);
+					}
 
 					auto shader = gl::shader_program();
 
-					for (auto const& object : objects)
-						shader.attach(object);
+					if (use_binaries)
+					{
+						if (auto const binary = cache.find(metadata.m_name, key))
+						{
+							auto const start = high_res_clock_t::now();
+							auto const loaded = shader.set_binary(*binary);
+							binary_time += high_res_clock_t::now() - start;
+
+							if (loaded)
+							{
+								++cached_count;
+
+								if (!out.m_shaders.insert({ metadata.m_name, std::move(shader) }).second)
+								{
+									log_error("load_assets(): duplicate shader id: " + metadata.m_name);
+									die();
+								}
+
+								continue;
+							}
+
+							// rejected by the driver. compile it, and replace the cached binary.
+							shader = gl::shader_program();
+						}
+					}
+
+					auto objects = std::vector<gl::shader_object const*>();
+
+					for (auto const& filename : metadata.m_filenames)
+						objects.push_back(&get_object(filename, metadata.m_name));
+
+					die_if(!std::all_of(objects.begin(), objects.end(), [] (gl::shader_object const* o) { return o->is_compiled(); }));
+
+					for (auto const object : objects)
+						shader.attach(*object);
+
+					if (use_binaries)
+						shader.set_binary_retrievable_hint(true);
+
+					auto const link_start = high_res_clock_t::now();
+					auto const linked = shader.link();
+					link_time += high_res_clock_t::now() - link_start;
 					
-					if (!shader.link())
+					if (!linked)
 					{
 						log_error("Failed to link shader program: " + metadata.m_name);
 						log_error(shader.get_log());
 						die();
 					}
 
-					for (auto const& object : objects)
-						shader.detach(object);
+					for (auto const object : objects)
+						shader.detach(*object);
+
+					++compiled_count;
+
+					if (use_binaries)
+						cache.insert(metadata.m_name, key, shader.get_binary());
 					
 					if (!out.m_shaders.insert({ metadata.m_name, std::move(shader) }).second)
 					{
@@ -150,6 +261,18 @@ namespace bump
 						die();
 					}
 				}
+
+				if (use_binaries)
+					cache.save();
+
+				auto const to_ms = [] (high_res_duration_t d) { return std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(d).count()) + " ms"; };
+
+				auto const object_count = std::count_if(files.begin(), files.end(), [] (auto const& f) { return f.second.m_object.has_value(); });
+				auto const cache_status = use_binaries ? std::string(compiled_count == 0 ? "warm" : "cold") : std::string("binary cache not supported");
+
+				log_info("load_assets(): loaded " + std::to_string(shaders.size()) + " shaders in " + to_ms(high_res_clock_t::now() - start_time) + " (" + cache_status + ": " +
+					std::to_string(cached_count) + " from binary cache, " + std::to_string(compiled_count) + " linked from " + std::to_string(object_count) + " of " + std::to_string(files.size()) + " shader files)");
+				log_info("load_assets(): shader compile: " + to_ms(compile_time) + ", link: " + to_ms(link_time) + ", binary load: " + to_ms(binary_time));
 			}
 
 			// load models:
@@ -5,6 +5,7 @@
 #include "bump_game_player.hpp"
 #include "bump_game_powerups.hpp"
 #include "bump_mbp_model.hpp"
+#include "bump_narrow_cast.hpp"
 #include "bump_physics.hpp"
 #include "bump_random.hpp"
 #include "bump_transform.hpp"
@@ -15,6 +16,9 @@
 #include <Tracy.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
 #include <random>
 
@@ -24,86 +28,223 @@ namespace bump
 	namespace game
 	{
 
-		asteroid_renderable::asteroid_renderable(mbp_model const& model, gl::shader_program const& depth_shader, gl::shader_program const& shader):
+		namespace
+		{
+
+			// where an instance is visible (instances visible in neither pass aren't uploaded)
+			auto const visible_in_scene = std::uint8_t{ 1 };
+			auto const visible_in_depth = std::uint8_t{ 2 };
+			auto const visible_in_both = std::uint8_t{ visible_in_scene | visible_in_depth };
+
+			// instances of each mesh are grouped by visibility: [ scene only | both | depth only ] (see asteroid_renderable::map_instances())
+			std::array<std::size_t, 4> get_group_offsets(std::size_t first_instance, std::array<std::size_t, 4> const& counts)
+			{
+				auto offsets = std::array<std::size_t, 4>{ };
+				offsets[visible_in_scene] = first_instance;
+				offsets[visible_in_both] = first_instance + counts[visible_in_scene];
+				offsets[visible_in_depth] = first_instance + counts[visible_in_scene] + counts[visible_in_both];
+				return offsets;
+			}
+
+			asteroid_renderable::instance_counts get_instance_counts(std::array<std::size_t, 4> const& counts)
+			{
+				return { counts[visible_in_scene], counts[visible_in_both], counts[visible_in_depth] };
+			}
+
+		} // unnamed
+
+		asteroid_renderable::asteroid_renderable(std::vector<std::reference_wrapper<const mbp_model>> const& models, gl::shader_program const& depth_shader, gl::shader_program const& shader):
+			m_multi_draw(models.size() > 1 && gl::renderer::is_multi_draw_indirect_supported()),
 			m_depth_shader(depth_shader),
 			m_depth_in_VertexPosition(depth_shader.get_attribute_location("in_VertexPosition")),
-			m_depth_in_MVP(depth_shader.get_attribute_location("in_MVP")),
+			m_depth_in_Transform(depth_shader.get_attribute_location("in_Transform")),
 			m_depth_in_Scale(depth_shader.get_attribute_location("in_Scale")),
+			m_depth_u_ViewProjection(depth_shader.get_uniform_location("u_ViewProjection")),
 			m_shader(shader),
 			m_in_VertexPosition(shader.get_attribute_location("in_VertexPosition")),
 			m_in_VertexNormal(shader.get_attribute_location("in_VertexNormal")),
-			m_in_MVP(shader.get_attribute_location("in_MVP")),
-			m_in_NormalMatrix(shader.get_attribute_location("in_NormalMatrix")),
+			m_in_Transform(shader.get_attribute_location("in_Transform")),
 			m_in_Color(shader.get_attribute_location("in_Color")),
-			m_in_Scale(shader.get_attribute_location("in_Scale"))
+			m_in_Scale(shader.get_attribute_location("in_Scale")),
+			m_u_ViewProjection(shader.get_uniform_location("u_ViewProjection")),
+			m_u_View(shader.get_uniform_location("u_View"))
 		{
-			// setup mesh buffers
-			die_if(model.m_submeshes.size() != 1);
+			die_if(models.empty());
 
-			auto const& mesh = model.m_submeshes.front();
+			// merge the meshes into one set of buffers
+			auto vertices = std::vector<float>();
+			auto normals = std::vector<float>();
+			auto indices = std::vector<std::uint32_t>();
+
+			for (auto const& m : models)
+			{
+				auto const& model = m.get();
+				die_if(model.m_submeshes.size() != 1);
+
+				auto const& mesh = model.m_submeshes.front().m_mesh;
+				die_if(mesh.m_normals.size() != mesh.m_vertices.size());
+
+				// note: indices aren't changed. the base vertex is added when drawing.
+				m_meshes.push_back({ indices.size(), mesh.m_indices.size(), narrow_cast<GLint>(vertices.size() / 3), bump::get_bounding_radius(model) });
+
+				vertices.insert(vertices.end(), mesh.m_vertices.begin(), mesh.m_vertices.end());
+				normals.insert(normals.end(), mesh.m_normals.begin(), mesh.m_normals.end());
+				indices.insert(indices.end(), mesh.m_indices.begin(), mesh.m_indices.end());
+			}
+
+			m_counts.resize(m_meshes.size());
 
 			// set up vertex buffers
-			m_vertices.set_data(GL_ARRAY_BUFFER, mesh.m_mesh.m_vertices.data(), 3, mesh.m_mesh.m_vertices.size() / 3, GL_STATIC_DRAW);
-			m_depth_vertex_array.set_array_buffer(m_depth_in_VertexPosition, m_vertices);
-			m_vertex_array.set_array_buffer(m_in_VertexPosition, m_vertices);
-			m_normals.set_data(GL_ARRAY_BUFFER, mesh.m_mesh.m_normals.data(), 3, mesh.m_mesh.m_normals.size() / 3, GL_STATIC_DRAW);
-			m_vertex_array.set_array_buffer(m_in_VertexNormal, m_normals);
-			m_indices.set_data(GL_ELEMENT_ARRAY_BUFFER, mesh.m_mesh.m_indices.data(), 1, mesh.m_mesh.m_indices.size(), GL_STATIC_DRAW);
-			m_depth_vertex_array.set_index_buffer(m_indices);
-			m_vertex_array.set_index_buffer(m_indices);
-
-			// set up instance buffers
-			m_transforms.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 16, 0, GL_STREAM_DRAW);
-			m_depth_vertex_array.set_array_buffer(m_depth_in_MVP, m_transforms, 4, 4, 1);
-			m_vertex_array.set_array_buffer(m_in_MVP, m_transforms, 4, 4, 1);
-			m_normal_matrices.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 9, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_NormalMatrix, m_normal_matrices, 3, 3, 1);
-			m_colors.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_Color, m_colors, 1);
-			m_scales.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 1, 0, GL_STREAM_DRAW);
-			m_depth_vertex_array.set_array_buffer(m_depth_in_Scale, m_scales, 1);
-			m_vertex_array.set_array_buffer(m_in_Scale, m_scales, 1);
+			m_vertices.set_data(GL_ARRAY_BUFFER, vertices.data(), 3, vertices.size() / 3, GL_STATIC_DRAW);
+			m_normals.set_data(GL_ARRAY_BUFFER, normals.data(), 3, normals.size() / 3, GL_STATIC_DRAW);
+			m_indices.set_data(GL_ELEMENT_ARRAY_BUFFER, indices.data(), 1, indices.size(), GL_STATIC_DRAW);
+
+			auto const vertex_array_count = m_multi_draw ? std::size_t{ 1 } : m_meshes.size();
+
+			m_depth_vertex_arrays.resize(vertex_array_count);
+			m_vertex_arrays.resize(vertex_array_count);
+
+			for (auto i = std::size_t{ 0 }; i != vertex_array_count; ++i)
+			{
+				m_depth_vertex_arrays[i].set_array_buffer(m_depth_in_VertexPosition, m_vertices);
+				m_depth_vertex_arrays[i].set_index_buffer(m_indices);
+				m_vertex_arrays[i].set_array_buffer(m_in_VertexPosition, m_vertices);
+				m_vertex_arrays[i].set_array_buffer(m_in_VertexNormal, m_normals);
+				m_vertex_arrays[i].set_index_buffer(m_indices);
+			}
+
+			// note: the instance attributes are set up by the render queue's backend when drawing
 		}
 
-		void asteroid_renderable::render_depth(gl::renderer& renderer, camera_matrices const&, std::vector<glm::mat4> const& transforms, std::vector<float> const& scales)
+		span<asteroid_instance> asteroid_renderable::map_instances(span<instance_counts const> counts)
 		{
-			// upload instance data to buffers
-			m_transforms.set_data(GL_ARRAY_BUFFER, glm::value_ptr(transforms.front()), 16, transforms.size(), GL_STREAM_DRAW);
-			m_scales.set_data(GL_ARRAY_BUFFER, scales.data(), 1, scales.size(), GL_STREAM_DRAW);
+			static_assert(sizeof(asteroid_instance) == sizeof(float) * 20, "Unexpected instance size.");
+
+			die_if(counts.size() != m_meshes.size());
+
+			std::copy(counts.begin(), counts.end(), m_counts.begin());
 
-			// render
-			renderer.set_program(m_depth_shader);
-			renderer.set_vertex_array(m_depth_vertex_array);
+			auto instance_count = std::size_t{ 0 };
 
-			renderer.draw_indexed(GL_TRIANGLES, m_indices.get_element_count(), m_indices.get_component_type(), transforms.size());
+			for (auto const& c : m_counts)
+				instance_count += c.m_scene_only + c.m_both + c.m_depth_only;
+
+			m_frame_instances.resize(instance_count);
+
+			return { m_frame_instances.data(), m_frame_instances.size() };
+		}
+
+		void asteroid_renderable::render_depth(gl::render_queue& queue, camera_matrices const& matrices)
+		{
+			submit(queue, matrices, true);
+		}
 
-			renderer.clear_vertex_array();
-			renderer.clear_program();
+		void asteroid_renderable::render_scene(gl::render_queue& queue, camera_matrices const& matrices)
+		{
+			submit(queue, matrices, false);
 		}
 
-		void asteroid_renderable::render_scene(gl::renderer& renderer, camera_matrices const&, std::vector<glm::mat4> const& transforms, std::vector<glm::mat3> const& normal_matrices, std::vector<glm::vec3> const& colors, std::vector<float> const& scales)
+		void asteroid_renderable::submit(gl::render_queue& queue, camera_matrices const& matrices, bool depth_pass)
 		{
-			// upload instance data to buffers
-			m_transforms.set_data(GL_ARRAY_BUFFER, glm::value_ptr(transforms.front()), 16, transforms.size(), GL_STREAM_DRAW);
-			m_normal_matrices.set_data(GL_ARRAY_BUFFER, glm::value_ptr(normal_matrices.front()), 9, normal_matrices.size(), GL_STREAM_DRAW);
-			m_colors.set_data(GL_ARRAY_BUFFER, glm::value_ptr(colors.front()), 3, colors.size(), GL_STREAM_DRAW);
-			m_scales.set_data(GL_ARRAY_BUFFER, scales.data(), 1, scales.size(), GL_STREAM_DRAW);
+			auto const& shader = depth_pass ? m_depth_shader : m_shader;
+			auto& vertex_arrays = depth_pass ? m_depth_vertex_arrays : m_vertex_arrays;
+
+			// the range of each mesh's instances drawn by this pass (the depth pass skips the scene only group, the scene pass skips the depth only group)
+			auto const get_first = [&] (instance_counts const& c) { return depth_pass ? c.m_scene_only : std::size_t{ 0 }; };
+			auto const get_count = [&] (instance_counts const& c) { return depth_pass ? c.m_both + c.m_depth_only : c.m_scene_only + c.m_both; };
+
+			auto const add_uniforms_and_attributes = [&] ()
+			{
+				if (depth_pass)
+				{
+					queue.add_uniform(m_depth_u_ViewProjection, matrices.m_view_projection);
+
+					queue.add_instance_attribute(m_depth_in_Transform, offsetof(asteroid_instance, m_transform), 4, 4);
+					queue.add_instance_attribute(m_depth_in_Scale, offsetof(asteroid_instance, m_scale), 1, 1);
+				}
+				else
+				{
+					queue.add_uniform(m_u_ViewProjection, matrices.m_view_projection);
+					queue.add_uniform(m_u_View, matrices.m_view);
+
+					queue.add_instance_attribute(m_in_Transform, offsetof(asteroid_instance, m_transform), 4, 4);
+					queue.add_instance_attribute(m_in_Color, offsetof(asteroid_instance, m_color), 3, 1);
+					queue.add_instance_attribute(m_in_Scale, offsetof(asteroid_instance, m_scale), 1, 1);
+				}
+			};
+
+			if (m_multi_draw)
+			{
+				// one command per mesh. the base instance in each command picks out the mesh's instances in the packet's instance data.
+				m_frame_commands.clear();
+
+				auto instance_count = std::size_t{ 0 };
+
+				for (auto i = std::size_t{ 0 }; i != m_meshes.size(); ++i)
+				{
+					auto const& m = m_meshes[i];
+					auto const count = get_count(m_counts[i]);
+
+					if (count == 0)
+						continue;
+
+					m_frame_commands.push_back({ GLuint(m.m_index_count), GLuint(count), GLuint(m.m_first_index), m.m_base_vertex, GLuint(instance_count) });
+					instance_count += count;
+				}
+
+				if (m_frame_commands.empty()) // everything culled
+					return;
+
+				auto const instances = queue.add_instances<asteroid_instance>(instance_count);
+				auto out = instances.begin();
+				auto first_instance = std::size_t{ 0 };
+
+				for (auto const& c : m_counts)
+				{
+					out = std::copy_n(m_frame_instances.begin() + first_instance + get_first(c), get_count(c), out);
+					first_instance += c.m_scene_only + c.m_both + c.m_depth_only;
+				}
+
+				add_uniforms_and_attributes();
+
+				auto& vertex_array = vertex_arrays.front();
+
+				queue.submit_indexed_indirect(gl::render_queue::make_sort_key(shader.get_id(), vertex_array.get_id()), shader, vertex_array,
+					GL_TRIANGLES, m_indices.get_component_type(), { m_frame_commands.data(), m_frame_commands.size() });
+
+				return;
+			}
 
-			// render
-			renderer.set_program(m_shader);
-			renderer.set_vertex_array(m_vertex_array);
+			auto first_instance = std::size_t{ 0 };
 
-			renderer.draw_indexed(GL_TRIANGLES, m_indices.get_element_count(), m_indices.get_component_type(), transforms.size());
+			for (auto i = std::size_t{ 0 }; i != m_meshes.size(); ++i)
+			{
+				auto const& m = m_meshes[i];
+				auto const& c = m_counts[i];
+				auto const count = get_count(c);
+
+				if (count != 0)
+				{
+					auto const instances = queue.add_instances<asteroid_instance>(count);
+					std::copy_n(m_frame_instances.begin() + first_instance + get_first(c), count, instances.begin());
+
+					add_uniforms_and_attributes();
+
+					auto& vertex_array = vertex_arrays[i];
 
-			renderer.clear_vertex_array();
-			renderer.clear_program();
+					queue.submit_indexed(gl::render_queue::make_sort_key(shader.get_id(), vertex_array.get_id()), shader, vertex_array,
+						GL_TRIANGLES, m.m_index_count, m_indices.get_component_type(), count, m.m_first_index, m.m_base_vertex);
+				}
+
+				first_instance += c.m_scene_only + c.m_both + c.m_depth_only;
+			}
 		}
 
-		
-		asteroid_field::asteroid_field(entt::registry& registry, powerups& powerups, mbp_model const& model, std::vector<std::reference_wrapper<const mbp_model>> const& fragment_models, gl::shader_program const& depth_shader, gl::shader_program const& shader, gl::shader_program const& hit_shader):
+		asteroid_field::asteroid_field(entt::registry& registry, particle_system& particles, powerups& powerups, mbp_model const& model, std::vector<std::reference_wrapper<const mbp_model>> const& fragment_models, gl::shader_program const& depth_shader, gl::shader_program const& shader):
 			m_registry(registry),
 			m_powerups(powerups),
-			m_renderable(model, depth_shader, shader),
+			m_asteroids(get_asteroid_group(registry)),
+			m_renderable({ std::cref(model) }, depth_shader, shader),
 			m_rng(std::random_device()()),
 			m_wave_number(0),
 			m_asteroid_type_probability{
@@ -114,13 +255,14 @@ namespace bump
 				{ asteroid_type::SMALL, { 0.5f, 30.f, 200.f } },
 				{ asteroid_type::MEDIUM, { 1.f, 80.f, 750.f } },
 				{ asteroid_type::LARGE, { 2.f, 150.f, 2000.f } } },
-			m_hit_effects(registry, hit_shader),
-			m_explosion_max_lifetime(high_res_duration_from_seconds(3.5f))
+			m_hit_effects(particles),
+			m_explosion_max_lifetime(high_res_duration_from_seconds(3.5f)),
+			m_fragment_damping(0.1f),
+			m_fragment_renderable(fragment_models, depth_shader, shader)
 		{
-			for (auto const& m : fragment_models)
-				m_fragment_renderables.emplace_back(m, depth_shader, shader);
-			
-			m_fragment_renderable_instance_data.resize(m_fragment_renderables.size());
+			m_fragment_group_counts.resize(m_fragment_renderable.get_mesh_count());
+			m_fragment_group_cursors.resize(m_fragment_renderable.get_mesh_count());
+			m_fragment_instance_counts.resize(m_fragment_renderable.get_mesh_count());
 
 			for (auto const& m : fragment_models)
 				m_fragment_renderable_transforms.push_back(m.get().m_transform);
@@ -146,13 +288,16 @@ namespace bump
 				m_hit_effects.set_random_velocity({ 10.f, 10.f, 10.f });
 				m_hit_effects.set_max_lifetime(high_res_duration_from_seconds(4.0f));
 				m_hit_effects.set_max_lifetime_random(high_res_duration_from_seconds(1.f));
-				m_hit_effects.set_color_update_fn(make_color_update_fn(m_hit_effects, color_map));
-				m_hit_effects.set_size_update_fn(make_size_update_fn(m_hit_effects, size_map));
+				m_hit_effects.set_color_curve(color_map);
+				m_hit_effects.set_size_curve(size_map);
+				m_hit_effects.set_burst_budget(150); // spread big pile-ups over a few frames
+				m_hit_effects.set_burst_merge_radius(2.f);
 				m_hit_effects.set_blend_mode(gl::renderer::blending::BLEND);
 				m_hit_effects.set_shadows_enabled(true);
 			}
 
 			spawn_wave();
+			update_asteroid_transforms();
 		}
 
 		asteroid_field::~asteroid_field()
@@ -161,40 +306,35 @@ namespace bump
 
 			for (auto id : view)
 				m_registry.destroy(id);
-
-			for (auto const& e : m_asteroid_explosions)
-				for (auto id : e.m_fragments)
-					m_registry.destroy(id);
 		}
 
 		void asteroid_field::update(high_res_duration_t dt)
 		{
-			// update fragment lifetimes and remove expired fragments
+			// update explosion lifetimes, remove expired fragments and calculate fragment transforms
 			{
-				auto view = m_registry.view<asteroid_fragment_data>();
-
 				for (auto i = m_asteroid_explosions.begin(); i != m_asteroid_explosions.end(); )
 				{
+					i->m_lifetime += dt;
+
 					auto last = std::remove_if(i->m_fragments.begin(), i->m_fragments.end(),
-						[&] (entt::entity id)
-						{
-							auto& data = view.get<asteroid_fragment_data>(id);
-							data.m_lifetime += dt;
-
-							auto destroy = (data.m_lifetime >= data.m_max_lifetime);
-							
-							if (destroy)
-								m_registry.destroy(id);
-							
-							return destroy;
-						});
+						[&] (asteroid_fragment_data const& f) { return i->m_lifetime >= f.m_max_lifetime; });
 
 					i->m_fragments.erase(last, i->m_fragments.end());
 
 					if (i->m_fragments.empty())
+					{
 						i = m_asteroid_explosions.erase(i);
-					else
-						++i;
+						continue;
+					}
+
+					auto const age_s = high_res_duration_to_seconds(i->m_lifetime);
+
+					i->m_fragment_transforms.clear();
+
+					for (auto const& f : i->m_fragments)
+						i->m_fragment_transforms.push_back(f.get_transform(age_s, m_fragment_damping));
+
+					++i;
 				}
 			}
 
@@ -212,8 +352,8 @@ namespace bump
 
 			auto destroyed_data = std::vector<destroyed_asteroid_data>();
 
-			m_registry.view<asteroid_data, physics::rigidbody>().each(
-				[&] (entt::entity e, asteroid_data& data, physics::rigidbody& rigidbody)
+			m_asteroids.each(
+				[&] (entt::entity e, asteroid_data& data, physics::rigidbody& rigidbody, physics::collider&)
 				{
 					if (data.m_hp < 0)
 					{
@@ -294,23 +434,18 @@ namespace bump
 
 				// add explosion
 				{
-					auto const fragment_count = m_fragment_renderables.size();
+					auto const fragment_count = m_fragment_renderable.get_mesh_count();
 
-					auto fragment_ids = std::vector<entt::entity>();
-					fragment_ids.reserve(fragment_count);
+					auto explosion = asteroid_explosion_data{ destroyed.m_color, destroyed.m_scale };
+					explosion.m_fragments.reserve(fragment_count);
+					explosion.m_fragment_transforms.reserve(fragment_count);
 
 					for (auto i = std::size_t{ 0 }; i != fragment_count; ++i)
 					{
-						auto id = m_registry.create();
-
-						auto& data = m_registry.emplace<asteroid_fragment_data>(id);
+						auto data = asteroid_fragment_data();
 						data.m_model_index = i;
-						data.m_lifetime = high_res_duration_t{ 0 };
 						data.m_max_lifetime = high_res_duration_from_seconds(random::scale(m_rng, high_res_duration_to_seconds(m_explosion_max_lifetime), high_res_duration_to_seconds(m_explosion_max_lifetime) * 0.5f));
 
-						auto const mass = random::scale(m_rng, 25.f, 5.f);
-						auto const size = glm::vec3(random::scale(m_rng, 10.f, 5.f), random::scale(m_rng, 10.f, 5.f), random::scale(m_rng, 10.f, 5.f));
-
 						auto transform = m_fragment_renderable_transforms[i];
 						set_position(transform, get_position(transform) * destroyed.m_scale);
 						transform = destroyed.m_transform * transform;
@@ -325,160 +460,193 @@ namespace bump
 						auto const ang_magnitude = random::scale(m_rng, 2.5f, 1.f);
 						auto const ang_velocity = ang_axis * ang_magnitude;
 
-						auto& rigidbody = m_registry.emplace<physics::rigidbody>(id);
-						rigidbody.set_mass(mass);
-						rigidbody.set_local_inertia_tensor(physics::make_cuboid_inertia_tensor(mass, size));
-						rigidbody.set_position(position);
-						rigidbody.set_velocity(velocity);
-						rigidbody.set_angular_velocity(ang_velocity);
+						data.m_position = position;
+						data.m_velocity = velocity;
+						data.m_rotation_axis = (glm::length(ang_velocity) > 0.f) ? glm::normalize(ang_velocity) : glm::vec3(0.f, 1.f, 0.f);
+						data.m_rotation_speed = glm::length(ang_velocity);
 
-						fragment_ids.push_back(id);
+						explosion.m_fragments.push_back(data);
+						explosion.m_fragment_transforms.push_back(data.get_transform(0.f, m_fragment_damping));
 					}
 
-					m_asteroid_explosions.push_back({ destroyed.m_color, destroyed.m_scale, std::move(fragment_ids) });
+					m_asteroid_explosions.push_back(std::move(explosion));
 				}
 			}
-			
-			for (auto p : m_frame_hit_positions)
-			{
-				auto m = glm::mat4(1.f);
-				set_position(m, p);
-
-				m_hit_effects.set_origin(m);
-				m_hit_effects.spawn_once(15);
-			}
-			m_frame_hit_positions.clear();
 
 			m_hit_effects.update(dt);
 
 			if (is_wave_complete())
 				spawn_wave();
+
+			update_asteroid_transforms();
+		}
+
+		void asteroid_field::update_instances(camera_matrices const& scene_matrices, camera_matrices const& light_matrices)
+		{
+			ZoneScopedN("asteroid_field::update_instances()");
+
+			auto const scene_frustum = bump::frustum(scene_matrices.m_view_projection);
+			auto const light_frustum = bump::frustum(light_matrices.m_view_projection);
+
+			update_asteroid_instances(scene_frustum, light_frustum);
+			update_fragment_instances(scene_frustum, light_frustum);
 		}
 
-		void asteroid_field::render_depth(gl::renderer& renderer, camera_matrices const& matrices)
+		void asteroid_field::render_depth(gl::render_queue& queue, camera_matrices const& matrices)
 		{
 			ZoneScopedN("asteroid_field::render_depth()");
 
-			// render asteroids
-			{
-				auto view = m_registry.view<asteroid_data, physics::rigidbody>();
+			m_renderable.render_depth(queue, matrices);
+			m_fragment_renderable.render_depth(queue, matrices);
+		}
+		
+		void asteroid_field::render_scene(gl::render_queue& queue, camera_matrices const& matrices)
+		{
+			ZoneScopedN("asteroid_field::render_scene()");
 
-				if (!view.empty())
-				{
-					for (auto id : view)
-					{
-						auto [a, rb] = view.get<asteroid_data, physics::rigidbody>(id);
-						auto const transform = rb.get_transform();
-						m_renderable_instance_data.m_transforms.push_back(matrices.model_view_projection_matrix(transform));
-						m_renderable_instance_data.m_scales.push_back(a.m_model_scale);
-					}
+			m_renderable.render_scene(queue, matrices);
+			m_fragment_renderable.render_scene(queue, matrices);
+		}
+		
+		glm::mat4 asteroid_field::asteroid_fragment_data::get_transform(float age_s, float damping) const
+		{
+			// velocity decays as v(t) = v0 * e^(-kt), so the distance travelled is v0 * (1 - e^(-kt)) / k
+			auto const d = (damping > 0.f) ? (1.f - std::exp(-damping * age_s)) / damping : age_s;
 
-					m_renderable.render_depth(renderer, matrices, m_renderable_instance_data.m_transforms, m_renderable_instance_data.m_scales);
+			auto transform = glm::translate(glm::mat4(1.f), m_position + m_velocity * d);
+			transform *= glm::mat4_cast(glm::angleAxis(m_rotation_speed * d, m_rotation_axis));
+			return transform;
+		}
 
-					m_renderable_instance_data.clear();
-				}
-			}
+		void asteroid_field::update_asteroid_transforms()
+		{
+			ZoneScopedN("asteroid_field::update_asteroid_transforms()");
+
+			m_asteroid_transforms.resize(m_asteroids.size());
+
+			for (auto i = std::size_t{ 0 }; i != m_asteroids.size(); ++i)
+				m_asteroid_transforms[i] = m_asteroids.get<physics::rigidbody>(m_asteroids[i]).get_transform();
+		}
+
+		void asteroid_field::cull(frustum const& scene_frustum, frustum const& light_frustum)
+		{
+			auto const centers = span<glm::vec3 const>(m_cull_data.m_centers.data(), m_cull_data.m_centers.size());
+			auto const radii = span<float const>(m_cull_data.m_radii.data(), m_cull_data.m_radii.size());
+
+			m_cull_data.m_visibility.assign(centers.size(), std::uint8_t{ 0 });
+
+			scene_frustum.cull_spheres(centers, radii, m_cull_data.m_visible);
+
+			for (auto i : m_cull_data.m_visible)
+				m_cull_data.m_visibility[i] |= visible_in_scene;
+
+			light_frustum.cull_spheres(centers, radii, m_cull_data.m_visible);
+
+			for (auto i : m_cull_data.m_visible)
+				m_cull_data.m_visibility[i] |= visible_in_depth;
+		}
+
+		void asteroid_field::update_asteroid_instances(frustum const& scene_frustum, frustum const& light_frustum)
+		{
+			ZoneScopedN("asteroid_field::update_asteroid_instances()");
 
-			// render fragments
+			die_if(m_asteroid_transforms.size() != m_asteroids.size());
+
+			m_cull_data.clear();
+
+			for (auto i = std::size_t{ 0 }; i != m_asteroids.size(); ++i)
 			{
-				auto view = m_registry.view<asteroid_fragment_data, physics::rigidbody>();
+				auto const& a = m_asteroids.get<asteroid_data>(m_asteroids[i]);
+				m_cull_data.m_centers.push_back(get_position(m_asteroid_transforms[i]));
+				m_cull_data.m_radii.push_back(m_renderable.get_bounding_radius(0) * a.m_model_scale);
+			}
 
-				if (!view.empty())
-				{
-					for (auto const& e : m_asteroid_explosions)
-					{
-						for (auto id : e.m_fragments)
-						{
-							auto [f, rb] = view.get<asteroid_fragment_data, physics::rigidbody>(id);
-							auto const transform = rb.get_transform();
-
-							auto& data = m_fragment_renderable_instance_data[f.m_model_index];
-							data.m_transforms.push_back(matrices.model_view_projection_matrix(transform));
-							data.m_scales.push_back(e.m_model_scale);
-						}
-					}
+			cull(scene_frustum, light_frustum);
 
-					for (auto i = std::size_t{ 0 }; i != m_fragment_renderables.size(); ++i)
-					{
-						auto const& data = m_fragment_renderable_instance_data[i];
-						m_fragment_renderables[i].render_depth(renderer, matrices, data.m_transforms, data.m_scales);
-					}
+			auto counts = std::array<std::size_t, 4>{ };
 
-					for (auto& i : m_fragment_renderable_instance_data)
-						i.clear();
-				}
+			for (auto v : m_cull_data.m_visibility)
+				++counts[v];
+
+			auto const instance_counts = get_instance_counts(counts);
+			auto const instances = m_renderable.map_instances({ &instance_counts, 1 }).data();
+			auto cursors = get_group_offsets(0, counts);
+
+			for (auto i = std::size_t{ 0 }; i != m_asteroids.size(); ++i)
+			{
+				auto const v = m_cull_data.m_visibility[i];
+
+				if (v == 0)
+					continue;
+
+				auto const& a = m_asteroids.get<asteroid_data>(m_asteroids[i]);
+				instances[cursors[v]++] = { m_asteroid_transforms[i], a.m_color, a.m_model_scale };
 			}
 		}
-		
-		void asteroid_field::render_scene(gl::renderer& renderer, camera_matrices const& matrices)
+
+		void asteroid_field::update_fragment_instances(frustum const& scene_frustum, frustum const& light_frustum)
 		{
-			ZoneScopedN("asteroid_field::render_scene()");
+			ZoneScopedN("asteroid_field::update_fragment_instances()");
+
+			m_visible_fragments.clear();
 
-			// render asteroids
+			for (auto& c : m_fragment_group_counts)
+				c.fill(0);
+
+			// cull fragments, and count instances per mesh
+			for (auto e = std::size_t{ 0 }; e != m_asteroid_explosions.size(); ++e)
 			{
-				auto view = m_registry.view<asteroid_data, physics::rigidbody>();
+				auto const& explosion = m_asteroid_explosions[e];
+
+				m_cull_data.clear();
 
-				if (!view.empty())
+				for (auto i = std::size_t{ 0 }; i != explosion.m_fragments.size(); ++i)
 				{
-					for (auto id : view)
-					{
-						auto [a, rb] = view.get<asteroid_data, physics::rigidbody>(id);
-						auto const transform = rb.get_transform();
-						m_renderable_instance_data.m_transforms.push_back(matrices.model_view_projection_matrix(transform));
-						m_renderable_instance_data.m_normal_matrices.push_back(matrices.normal_matrix(transform));
-						m_renderable_instance_data.m_colors.push_back(a.m_color);
-						m_renderable_instance_data.m_scales.push_back(a.m_model_scale);
-					}
+					auto const radius = m_fragment_renderable.get_bounding_radius(explosion.m_fragments[i].m_model_index);
+					m_cull_data.m_centers.push_back(get_position(explosion.m_fragment_transforms[i]));
+					m_cull_data.m_radii.push_back(radius * explosion.m_model_scale);
+				}
+
+				cull(scene_frustum, light_frustum);
+
+				for (auto i = std::size_t{ 0 }; i != explosion.m_fragments.size(); ++i)
+				{
+					auto const v = m_cull_data.m_visibility[i];
 
-					m_renderable.render_scene(renderer, matrices, m_renderable_instance_data.m_transforms, m_renderable_instance_data.m_normal_matrices, m_renderable_instance_data.m_colors, m_renderable_instance_data.m_scales);
+					if (v == 0)
+						continue;
 
-					m_renderable_instance_data.clear();
+					m_visible_fragments.push_back({ std::uint32_t(e), std::uint32_t(i), v });
+					++m_fragment_group_counts[explosion.m_fragments[i].m_model_index][v];
 				}
 			}
 
-			// render fragments
+			// write instance data (all the meshes share one instance array)
+			auto first_instance = std::size_t{ 0 };
+
+			for (auto i = std::size_t{ 0 }; i != m_fragment_group_counts.size(); ++i)
 			{
-				auto view = m_registry.view<asteroid_fragment_data, physics::rigidbody>();
+				auto const& counts = m_fragment_group_counts[i];
+				m_fragment_instance_counts[i] = get_instance_counts(counts);
+				m_fragment_group_cursors[i] = get_group_offsets(first_instance, counts);
+				first_instance += counts[visible_in_scene] + counts[visible_in_both] + counts[visible_in_depth];
+			}
 
-				if (!view.empty())
-				{
-					for (auto const& e : m_asteroid_explosions)
-					{
-						for (auto id : e.m_fragments)
-						{
-							auto [f, rb] = view.get<asteroid_fragment_data, physics::rigidbody>(id);
-							auto const transform = rb.get_transform();
-
-							auto& data = m_fragment_renderable_instance_data[f.m_model_index];
-							data.m_transforms.push_back(matrices.model_view_projection_matrix(transform));
-							data.m_normal_matrices.push_back(matrices.normal_matrix(transform));
-							data.m_colors.push_back(e.m_color);
-							data.m_scales.push_back(e.m_model_scale);
-						}
-					}
+			auto const instances = m_fragment_renderable.map_instances({ m_fragment_instance_counts.data(), m_fragment_instance_counts.size() }).data();
 
-					for (auto i = std::size_t{ 0 }; i != m_fragment_renderables.size(); ++i)
-					{
-						auto const& data = m_fragment_renderable_instance_data[i];
-						m_fragment_renderables[i].render_scene(renderer, matrices, data.m_transforms, data.m_normal_matrices, data.m_colors, data.m_scales);
-					}
+			for (auto const& f : m_visible_fragments)
+			{
+				auto const& e = m_asteroid_explosions[f.m_explosion];
+				auto const m = e.m_fragments[f.m_fragment].m_model_index;
+				auto const c = m_fragment_group_cursors[m][f.m_visibility]++;
 
-					for (auto& i : m_fragment_renderable_instance_data)
-						i.clear();
-				}
+				instances[c] = { e.m_fragment_transforms[f.m_fragment], e.m_color, e.m_model_scale };
 			}
 		}
-		
-		void asteroid_field::render_particles(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map)
-		{
-			ZoneScopedN("asteroid_field::render_particles()");
 
-			m_hit_effects.render(renderer, light_matrices, matrices, shadow_map);
-		}
-		
 		bool asteroid_field::is_wave_complete() const
 		{
-			return m_registry.view<asteroid_data>().empty();
+			return m_asteroids.empty();
 		}
 
 		void asteroid_field::spawn_wave()
@@ -559,8 +727,7 @@ namespace bump
 					data.m_hp -= damage.m_damage;
 				}
 
-				if (!m_registry.has<particle_effect::particle_data>(other))
-					m_frame_hit_positions.push_back(hit.m_point);
+				m_hit_effects.spawn_burst(hit.m_point, 15);
 			};
 
 			collider.set_callback(callback);
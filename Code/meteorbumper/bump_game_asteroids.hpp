@@ -1,13 +1,20 @@
 #pragma once
 
+#include "bump_frustum.hpp"
 #include "bump_game_particle_effect.hpp"
 #include "bump_gl.hpp"
+#include "bump_physics.hpp"
+#include "bump_span.hpp"
 #include "bump_time.hpp"
 
 #include <entt.hpp>
 #include <glm/glm.hpp>
 
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <random>
+#include <vector>
 
 namespace bump
 {
@@ -20,57 +27,104 @@ namespace bump
 
 		class powerups;
 
+		// per instance data, used by both the depth and scene passes.
+		// note: must match the instance attributes in asteroid.vert and asteroid_depth.vert.
+		struct asteroid_instance
+		{
+			glm::mat4 m_transform; // world space
+			glm::vec3 m_color;
+			float m_scale;
+		};
+
+		// draws instances of one or more meshes (e.g. all the asteroid fragments).
+		// the meshes share one set of vertex and index buffers. if multi-draw indirect is supported, each pass is drawn
+		// with one glMultiDrawElementsIndirect call (one command per mesh). otherwise there's one draw call per mesh.
 		class asteroid_renderable
 		{
 		public:
 
-			asteroid_renderable(mbp_model const& model, gl::shader_program const& depth_shader, gl::shader_program const& shader);
+			asteroid_renderable(std::vector<std::reference_wrapper<const mbp_model>> const& models, gl::shader_program const& depth_shader, gl::shader_program const& shader);
 
-			void render_depth(gl::renderer& renderer, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms, std::vector<float> const& scales);
-			void render_scene(gl::renderer& renderer, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms, std::vector<glm::mat3> const& normal_matrices, std::vector<glm::vec3> const& colors, std::vector<float> const& scales);
+			// number of instances of a mesh in each visibility group
+			struct instance_counts
+			{
+				std::size_t m_scene_only = 0;
+				std::size_t m_both = 0;
+				std::size_t m_depth_only = 0;
+			};
+
+			// instance data is written once per frame, and each pass copies the instances it draws into its render queue.
+			// instances are grouped by mesh (in model order), then by where they're visible: [ scene only | both | depth only ].
+			// the scene pass draws the first two groups of each mesh, and the depth pass draws the last two.
+			span<asteroid_instance> map_instances(span<instance_counts const> counts); // one per mesh
+
+			void render_depth(gl::render_queue& queue, camera_matrices const& matrices);
+			void render_scene(gl::render_queue& queue, camera_matrices const& matrices);
+
+			std::size_t get_mesh_count() const { return m_meshes.size(); }
+			float get_bounding_radius(std::size_t mesh_index) const { return m_meshes.at(mesh_index).m_bounding_radius; } // at a scale of 1
 
 		private:
 
+			struct mesh_data
+			{
+				std::size_t m_first_index;
+				std::size_t m_index_count;
+				GLint m_base_vertex;
+				float m_bounding_radius;
+			};
+
+			void submit(gl::render_queue& queue, camera_matrices const& matrices, bool depth_pass);
+
+			std::vector<mesh_data> m_meshes;
+			std::vector<instance_counts> m_counts; // this frame's counts (one per mesh)
+			std::vector<asteroid_instance> m_frame_instances;
+			std::vector<gl::draw_indexed_indirect_command> m_frame_commands; // multi-draw only
+
+			bool m_multi_draw;
+
 			// depth rendering stuff:
 			gl::shader_program const& m_depth_shader;
 
 			GLint m_depth_in_VertexPosition;
-			GLint m_depth_in_MVP;
+			GLint m_depth_in_Transform;
 			GLint m_depth_in_Scale;
-			
-			gl::vertex_array m_depth_vertex_array;
+			GLint m_depth_u_ViewProjection;
 
 			// scene rendering stuff:
 			gl::shader_program const& m_shader;
 
 			GLint m_in_VertexPosition;
 			GLint m_in_VertexNormal;
-			GLint m_in_MVP;
-			GLint m_in_NormalMatrix;
+			GLint m_in_Transform;
 			GLint m_in_Color;
 			GLint m_in_Scale;
+			GLint m_u_ViewProjection;
+			GLint m_u_View;
 			
 			gl::buffer m_vertices;
 			gl::buffer m_normals;
 			gl::buffer m_indices;
-			gl::buffer m_transforms;
-			gl::buffer m_normal_matrices;
-			gl::buffer m_colors;
-			gl::buffer m_scales;
-			gl::vertex_array m_vertex_array;
+
+			// one vertex array per mesh (or just one for all the meshes with multi-draw)
+			std::vector<gl::vertex_array> m_depth_vertex_arrays;
+			std::vector<gl::vertex_array> m_vertex_arrays;
 		};
 		
 		class asteroid_field
 		{
 		public:
 
-			explicit asteroid_field(entt::registry& registry, powerups& powerups, mbp_model const& model, std::vector<std::reference_wrapper<const mbp_model>> const& fragment_models, gl::shader_program const& depth_shader, gl::shader_program const& shader, gl::shader_program const& hit_shader);
+			explicit asteroid_field(entt::registry& registry, particle_system& particles, powerups& powerups, mbp_model const& model, std::vector<std::reference_wrapper<const mbp_model>> const& fragment_models, gl::shader_program const& depth_shader, gl::shader_program const& shader);
 			~asteroid_field();
 
 			void update(high_res_duration_t dt);
-			void render_depth(gl::renderer& renderer, camera_matrices const& matrices);
-			void render_scene(gl::renderer& renderer, camera_matrices const& matrices);
-			void render_particles(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map);
+
+			// culls and writes instance data for both render passes. call once per frame, before rendering.
+			void update_instances(camera_matrices const& scene_matrices, camera_matrices const& light_matrices);
+
+			void render_depth(gl::render_queue& queue, camera_matrices const& matrices);
+			void render_scene(gl::render_queue& queue, camera_matrices const& matrices);
 
 			enum class asteroid_type { LARGE, MEDIUM, SMALL };
 
@@ -82,6 +136,10 @@ namespace bump
 				float m_model_scale = 1.f;
 			};
 
+			// note: owns asteroid_data. must be the only group that does (for packed iteration with the physics components).
+			using asteroid_group = entt::group<entt::exclude_t<>, entt::get_t<physics::rigidbody, physics::collider>, asteroid_data>;
+			static asteroid_group get_asteroid_group(entt::registry& registry) { return registry.group<asteroid_data>(entt::get<physics::rigidbody, physics::collider>); }
+
 		private:
 
 			bool is_wave_complete() const;
@@ -103,19 +161,13 @@ namespace bump
 
 			entt::registry& m_registry;
 			powerups& m_powerups;
+			asteroid_group m_asteroids;
 
-			struct renderable_instance_data
-			{
-				void clear() { m_transforms.clear(); m_normal_matrices.clear(); m_colors.clear(); m_scales.clear(); }
+			void update_asteroid_transforms();
 
-				std::vector<glm::mat4> m_transforms;
-				std::vector<glm::mat3> m_normal_matrices;
-				std::vector<glm::vec3> m_colors;
-				std::vector<float> m_scales;
-			};
+			std::vector<glm::mat4> m_asteroid_transforms; // world transforms in m_asteroids order (calculated once per update, and used by both render passes)
 
 			asteroid_renderable m_renderable;
-			renderable_instance_data m_renderable_instance_data;
 
 			struct asteroid_type_data
 			{
@@ -131,28 +183,67 @@ namespace bump
 			std::map<asteroid_type, asteroid_type_data> m_asteroid_type_data;
 
 			particle_effect m_hit_effects;
-			std::vector<glm::vec3> m_frame_hit_positions;
 
+			// note: fragments aren't entities, and don't go through the physics system.
+			// they store their initial state, and the transform is calculated from the explosion age.
 			struct asteroid_fragment_data
 			{
 				std::size_t m_model_index;
-				high_res_duration_t m_lifetime;
 				high_res_duration_t m_max_lifetime;
+
+				glm::vec3 m_position; // initial state
+				glm::vec3 m_velocity;
+				glm::vec3 m_rotation_axis;
+				float m_rotation_speed;
+
+				glm::mat4 get_transform(float age_s, float damping) const;
 			};
 
 			struct asteroid_explosion_data
 			{
 				glm::vec3 m_color = glm::vec3(1.f);
 				float m_model_scale = 1.f;
-				std::vector<entt::entity> m_fragments;
+				high_res_duration_t m_lifetime = high_res_duration_t{ 0 };
+				std::vector<asteroid_fragment_data> m_fragments;
+				std::vector<glm::mat4> m_fragment_transforms; // updated each frame
 			};
 
 			std::vector<asteroid_explosion_data> m_asteroid_explosions;
 			high_res_duration_t m_explosion_max_lifetime;
+			float m_fragment_damping;
 
-			std::vector<asteroid_renderable> m_fragment_renderables;
-			std::vector<renderable_instance_data> m_fragment_renderable_instance_data;
+			asteroid_renderable m_fragment_renderable; // one mesh per fragment model
 			std::vector<glm::mat4> m_fragment_renderable_transforms;
+
+			// visible fragments from all explosions, with the number of instances per mesh in each visibility group
+			struct fragment_index
+			{
+				std::uint32_t m_explosion;
+				std::uint32_t m_fragment;
+				std::uint8_t m_visibility;
+			};
+
+			std::vector<fragment_index> m_visible_fragments;
+			std::vector<std::array<std::size_t, 4>> m_fragment_group_counts; // indexed by visibility flags
+			std::vector<std::array<std::size_t, 4>> m_fragment_group_cursors;
+			std::vector<asteroid_renderable::instance_counts> m_fragment_instance_counts;
+
+			// bounding spheres for frustum culling (one per instance), and where each instance is visible
+			struct cull_data
+			{
+				void clear() { m_centers.clear(); m_radii.clear(); m_visible.clear(); m_visibility.clear(); }
+
+				std::vector<glm::vec3> m_centers;
+				std::vector<float> m_radii;
+				std::vector<std::uint32_t> m_visible; // scratch
+				std::vector<std::uint8_t> m_visibility; // per instance (see visibility flags in the .cpp)
+			};
+
+			void cull(frustum const& scene_frustum, frustum const& light_frustum); // m_centers and m_radii to m_visibility
+			void update_asteroid_instances(frustum const& scene_frustum, frustum const& light_frustum);
+			void update_fragment_instances(frustum const& scene_frustum, frustum const& light_frustum);
+
+			cull_data m_cull_data;
 		};
 
 	} // game
@@ -5,6 +5,9 @@
 
 #include <Tracy.hpp>
 
+#include <algorithm>
+#include <cstddef>
+
 namespace bump
 {
 	
@@ -66,53 +69,42 @@ namespace bump
 			}
 		}
 
-		void basic_renderable::render_depth(gl::renderer& renderer, camera_matrices const& matrices)
+		void basic_renderable::render_depth(gl::render_queue& queue, camera_matrices const& matrices)
 		{
 			ZoneScopedN("basic_renderable::render_depth()");
 
 			auto mvp = matrices.model_view_projection_matrix(m_transform);
 
-			renderer.set_program(*m_depth_shader);
-
 			for (auto i = std::size_t{ 0 }; i != m_depth_vertex_arrays.size(); ++i)
 			{
-				renderer.set_uniform_4x4f(m_depth_u_MVP, mvp);
-				renderer.set_vertex_array(m_depth_vertex_arrays[i]);
+				auto& vertex_array = m_depth_vertex_arrays[i];
 
-				renderer.draw_indexed(GL_TRIANGLES, m_submeshes[i].m_indices.get_element_count(), m_submeshes[i].m_indices.get_component_type());
+				queue.add_uniform(m_depth_u_MVP, mvp);
 
-				renderer.clear_vertex_array();
+				queue.submit_indexed(gl::render_queue::make_sort_key(m_depth_shader->get_id(), vertex_array.get_id()), *m_depth_shader, vertex_array,
+					GL_TRIANGLES, m_submeshes[i].m_indices.get_element_count(), m_submeshes[i].m_indices.get_component_type());
 			}
-
-			renderer.clear_program();
 		}
 		
-		void basic_renderable::render(gl::renderer& renderer, camera_matrices const& matrices)
+		void basic_renderable::render(gl::render_queue& queue, camera_matrices const& matrices)
 		{
 			ZoneScopedN("basic_renderable::render()");
 
 			auto mvp = matrices.model_view_projection_matrix(m_transform);
 			auto n = matrices.normal_matrix(m_transform);
 
-			renderer.set_program(*m_shader);
-
-			for (auto const& submesh : m_submeshes)
+			for (auto& submesh : m_submeshes)
 			{
-				renderer.set_uniform_4x4f(m_u_MVP, mvp);
-				renderer.set_uniform_3x3f(m_u_NormalMatrix, n);
-				renderer.set_uniform_3f(m_u_Color, submesh.m_color);
-				renderer.set_uniform_1f(m_u_Metallic, submesh.m_metallic);
-				renderer.set_uniform_1f(m_u_Roughness, submesh.m_roughness);
-				renderer.set_uniform_1f(m_u_Emissive, submesh.m_emissive);
-
-				renderer.set_vertex_array(submesh.m_vertex_array);
-
-				renderer.draw_indexed(GL_TRIANGLES, submesh.m_indices.get_element_count(), submesh.m_indices.get_component_type());
-
-				renderer.clear_vertex_array();
+				queue.add_uniform(m_u_MVP, mvp);
+				queue.add_uniform(m_u_NormalMatrix, n);
+				queue.add_uniform(m_u_Color, submesh.m_color);
+				queue.add_uniform(m_u_Metallic, submesh.m_metallic);
+				queue.add_uniform(m_u_Roughness, submesh.m_roughness);
+				queue.add_uniform(m_u_Emissive, submesh.m_emissive);
+
+				queue.submit_indexed(gl::render_queue::make_sort_key(m_shader->get_id(), submesh.m_vertex_array.get_id()), *m_shader, submesh.m_vertex_array,
+					GL_TRIANGLES, submesh.m_indices.get_element_count(), submesh.m_indices.get_component_type());
 			}
-
-			renderer.clear_program();
 		}
 		
 		basic_renderable_instanced::basic_renderable_instanced(gl::shader_program const& depth_shader, gl::shader_program const& shader, mbp_model const& model):
@@ -129,9 +121,6 @@ namespace bump
 			m_u_Roughness(shader.get_uniform_location("u_Roughness")),
 			m_u_Emissive(shader.get_uniform_location("u_Emissive"))
 		{
-			m_buffer_mvp_matrices.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 16, 0, GL_STREAM_DRAW);
-			m_buffer_normal_matrices.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 9, 0, GL_STREAM_DRAW);
-
 			for (auto const& submesh : model.m_submeshes)
 			{
 				auto depth_vertex_array = gl::vertex_array();
@@ -165,83 +154,65 @@ namespace bump
 				depth_vertex_array.set_index_buffer(s.m_indices);
 				s.m_vertex_array.set_index_buffer(s.m_indices);
 
-				depth_vertex_array.set_array_buffer(m_depth_in_MVP, m_buffer_mvp_matrices, 4, 4, 1);
-				s.m_vertex_array.set_array_buffer(m_in_MVP, m_buffer_mvp_matrices, 4, 4, 1);
-				s.m_vertex_array.set_array_buffer(m_in_NormalMatrix, m_buffer_normal_matrices, 3, 3, 1);
+				// note: the instance attributes are set up by the render queue's backend when drawing
 
 				m_depth_vertex_arrays.push_back(std::move(depth_vertex_array));
 				m_submeshes.push_back(std::move(s));
 			}
 		}
 
-		void basic_renderable_instanced::render_depth(gl::renderer& renderer, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms)
+		void basic_renderable_instanced::render_depth(gl::render_queue& queue, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms)
 		{
 			ZoneScopedN("basic_renderable_instanced::render_depth()");
 
 			auto const instance_count = transforms.size();
 			if (instance_count == 0) return;
 
-			m_frame_mvp_matrices.reserve(instance_count);
+			m_frame_depth_instances.clear();
 
 			for (auto const& t : transforms)
-				m_frame_mvp_matrices.push_back(matrices.model_view_projection_matrix(t));
-			
-			m_buffer_mvp_matrices.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_mvp_matrices.front()), 16, instance_count, GL_STREAM_DRAW);
-			m_frame_mvp_matrices.clear();
-
-			renderer.set_program(*m_depth_shader);
+				m_frame_depth_instances.push_back({ matrices.model_view_projection_matrix(t) });
 
 			for (auto i = std::size_t{ 0 }; i != m_depth_vertex_arrays.size(); ++i)
 			{
-				renderer.set_vertex_array(m_depth_vertex_arrays[i]);
+				auto& vertex_array = m_depth_vertex_arrays[i];
 
-				renderer.draw_indexed(GL_TRIANGLES, m_submeshes[i].m_indices.get_element_count(), m_submeshes[i].m_indices.get_component_type(), instance_count);
+				auto const instances = queue.add_instances<depth_instance>(instance_count);
+				std::copy(m_frame_depth_instances.begin(), m_frame_depth_instances.end(), instances.begin());
+				queue.add_instance_attribute(m_depth_in_MVP, offsetof(depth_instance, m_mvp), 4, 4);
 
-				renderer.clear_vertex_array();
+				queue.submit_indexed(gl::render_queue::make_sort_key(m_depth_shader->get_id(), vertex_array.get_id()), *m_depth_shader, vertex_array,
+					GL_TRIANGLES, m_submeshes[i].m_indices.get_element_count(), m_submeshes[i].m_indices.get_component_type(), instance_count);
 			}
-
-			renderer.clear_program();
 		}
 
-		void basic_renderable_instanced::render(gl::renderer& renderer, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms)
+		void basic_renderable_instanced::render(gl::render_queue& queue, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms)
 		{
 			ZoneScopedN("basic_renderable_instanced::render()");
 
 			auto const instance_count = transforms.size();
 			if (instance_count == 0) return;
 
-			m_frame_mvp_matrices.reserve(instance_count);
-			m_frame_normal_matrices.reserve(instance_count);
+			m_frame_instances.clear();
 
 			for (auto const& t : transforms)
-			{
-				m_frame_mvp_matrices.push_back(matrices.model_view_projection_matrix(t));
-				m_frame_normal_matrices.push_back(matrices.normal_matrix(t));
-			}
-			
-			m_buffer_mvp_matrices.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_mvp_matrices.front()), 16, instance_count, GL_STREAM_DRAW);
-			m_buffer_normal_matrices.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_normal_matrices.front()), 9, instance_count, GL_STREAM_DRAW);
-
-			m_frame_mvp_matrices.clear();
-			m_frame_normal_matrices.clear();
-
-			renderer.set_program(*m_shader);
+				m_frame_instances.push_back({ matrices.model_view_projection_matrix(t), matrices.normal_matrix(t) });
 
-			for (auto const& submesh : m_submeshes)
+			for (auto& submesh : m_submeshes)
 			{
-				renderer.set_uniform_3f(m_u_Color, submesh.m_color);
-				renderer.set_uniform_1f(m_u_Metallic, submesh.m_metallic);
-				renderer.set_uniform_1f(m_u_Roughness, submesh.m_roughness);
-				renderer.set_uniform_1f(m_u_Emissive, submesh.m_emissive);
-
-				renderer.set_vertex_array(submesh.m_vertex_array);
-
-				renderer.draw_indexed(GL_TRIANGLES, submesh.m_indices.get_element_count(), submesh.m_indices.get_component_type(), instance_count);
-
-				renderer.clear_vertex_array();
+				auto const instances = queue.add_instances<instance>(instance_count);
+				std::copy(m_frame_instances.begin(), m_frame_instances.end(), instances.begin());
+				queue.add_instance_attribute(m_in_MVP, offsetof(instance, m_mvp), 4, 4);
+				queue.add_instance_attribute(m_in_NormalMatrix, offsetof(instance, m_normal_matrix), 3, 3);
+
+				queue.add_uniform(m_u_Color, submesh.m_color);
+				queue.add_uniform(m_u_Metallic, submesh.m_metallic);
+				queue.add_uniform(m_u_Roughness, submesh.m_roughness);
+				queue.add_uniform(m_u_Emissive, submesh.m_emissive);
+
+				queue.submit_indexed(gl::render_queue::make_sort_key(m_shader->get_id(), submesh.m_vertex_array.get_id()), *m_shader, submesh.m_vertex_array,
+					GL_TRIANGLES, submesh.m_indices.get_element_count(), submesh.m_indices.get_component_type(), instance_count);
 			}
-
-			renderer.clear_program();
 		}
 		
 	} // game
@@ -26,8 +26,8 @@ namespace bump
 			basic_renderable(basic_renderable&&) = default;
 			basic_renderable& operator=(basic_renderable&&) = default;
 
-			void render_depth(gl::renderer& renderer, camera_matrices const& matrices);
-			void render(gl::renderer& renderer, camera_matrices const& matrices);
+			void render_depth(gl::render_queue& queue, camera_matrices const& matrices);
+			void render(gl::render_queue& queue, camera_matrices const& matrices);
 
 			void set_transform(glm::mat4 const& transform) { m_transform = transform; }
 			glm::mat4 get_transform() const { return m_transform; }
@@ -78,10 +78,10 @@ namespace bump
 			basic_renderable_instanced& operator=(basic_renderable_instanced const&) = delete;
 			
 			basic_renderable_instanced(basic_renderable_instanced&&) = default;
-			basic_renderable_instanced& operator=(basic_renderable_instanced&&) = default;
+			basic_renderable_instanced& operator=(basic_renderable_instanced&&) = delete;
 
-			void render_depth(gl::renderer& renderer, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms);
-			void render(gl::renderer& renderer, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms);
+			void render_depth(gl::render_queue& queue, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms);
+			void render(gl::render_queue& queue, camera_matrices const& matrices, std::vector<glm::mat4> const& transforms);
 
 		private:
 
@@ -101,8 +101,21 @@ namespace bump
 			GLint m_u_Roughness;
 			GLint m_u_Emissive;
 
-			gl::buffer m_buffer_mvp_matrices;
-			gl::buffer m_buffer_normal_matrices;
+			// per instance data (copied into the render queue for each submesh).
+			// note: must match the instance attributes in the shaders.
+			struct depth_instance
+			{
+				glm::mat4 m_mvp;
+			};
+
+			struct instance
+			{
+				glm::mat4 m_mvp;
+				glm::mat3 m_normal_matrix;
+			};
+
+			std::vector<depth_instance> m_frame_depth_instances;
+			std::vector<instance> m_frame_instances;
 
 			struct submesh_data
 			{
@@ -118,9 +131,6 @@ namespace bump
 			};
 
 			std::vector<submesh_data> m_submeshes;
-
-			std::vector<glm::mat4> m_frame_mvp_matrices;
-			std::vector<glm::mat3> m_frame_normal_matrices;
 		};
 
 	} // game
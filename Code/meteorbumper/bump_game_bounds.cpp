@@ -52,14 +52,14 @@ namespace bump
 			}
 		}
 
-		void bounds::render_depth(gl::renderer& renderer, camera_matrices const& matrices)
+		void bounds::render_depth(gl::render_queue& queue, camera_matrices const& matrices)
 		{
-			m_bouy.render_depth(renderer, matrices, m_bouy_transforms);
+			m_bouy.render_depth(queue, matrices, m_bouy_transforms);
 		}
 
-		void bounds::render_scene(gl::renderer& renderer, camera_matrices const& matrices)
+		void bounds::render_scene(gl::render_queue& queue, camera_matrices const& matrices)
 		{
-			m_bouy.render(renderer, matrices, m_bouy_transforms);
+			m_bouy.render(queue, matrices, m_bouy_transforms);
 		}
 
 		bounds::~bounds()
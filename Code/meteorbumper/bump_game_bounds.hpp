@@ -25,8 +25,8 @@ namespace bump
 
 			explicit bounds(entt::registry& registry, float radius, gl::shader_program const& bouy_depth_shader, gl::shader_program const& bouy_shader, mbp_model const& bouy_model);
 
-			void render_depth(gl::renderer& renderer, camera_matrices const& matrices);
-			void render_scene(gl::renderer& renderer, camera_matrices const& matrices);
+			void render_depth(gl::render_queue& queue, camera_matrices const& matrices);
+			void render_scene(gl::render_queue& queue, camera_matrices const& matrices);
 
 			~bounds();
 
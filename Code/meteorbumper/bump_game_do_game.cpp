@@ -1,6 +1,7 @@
 #include "bump_game.hpp"
 
 #include "bump_camera.hpp"
+#include "bump_entity_command_buffer.hpp"
 #include "bump_game_app.hpp"
 #include "bump_game_asteroids.hpp"
 #include "bump_game_bounds.hpp"
@@ -9,6 +10,7 @@
 #include "bump_game_indicators.hpp"
 #include "bump_game_particle_effect.hpp"
 #include "bump_game_particle_field.hpp"
+#include "bump_game_particle_system.hpp"
 #include "bump_game_player.hpp"
 #include "bump_game_powerups.hpp"
 #include "bump_game_skybox.hpp"
@@ -34,14 +36,20 @@ namespace bump
 		gamestate do_game(app& app)
 		{
 			auto registry = entt::registry();
+			auto commands = entity_command_buffer();
 			auto physics_system = physics::physics_system(registry);
+			auto particles = particle_system(physics_system, app.m_assets.m_shaders.at("particle_effect"));
+
+			auto scene_queue = gl::render_queue();
+			auto shadow_queue = gl::render_queue();
+			auto render_backend = gl::renderer_backend(app.m_renderer);
 			
 			auto gbuf = lighting::gbuffers(app.m_window.get_size());
 			auto shadow_rt = lighting::shadow_rendertarget(glm::ivec2{ 1920, 1080 });
 			auto lighting_rt = lighting::lighting_rendertarget(app.m_window.get_size(), gbuf.m_depth_stencil);
 			auto lighting = lighting::lighting_system(registry, 
 				app.m_assets.m_shaders.at("light_directional"), 
-				app.m_assets.m_shaders.at("light_point"), app.m_assets.m_models.at("point_light"),
+				app.m_assets.m_shaders.at("light_point"),
 				app.m_assets.m_shaders.at("light_emissive"));
 			auto tone_map_blit = lighting::tone_map_quad(app.m_assets.m_shaders.at("tone_mapping"));
 
@@ -83,7 +91,7 @@ namespace bump
 			
 			auto skybox = game::skybox(app.m_assets.m_models.at("skybox"), app.m_assets.m_shaders.at("skybox"), app.m_assets.m_cubemaps.at("skybox"));
 
-			auto player = game::player(registry, app.m_assets);
+			auto player = game::player(registry, commands, particles, app.m_assets);
 
 			auto powerups = game::powerups(registry, app.m_assets.m_shaders.at("powerup_depth"), app.m_assets.m_shaders.at("powerup"), app.m_assets.m_models.at("powerup_shield"), app.m_assets.m_models.at("powerup_armor"), app.m_assets.m_models.at("powerup_lasers"));
 
@@ -99,7 +107,7 @@ namespace bump
 			for (auto const& n : asteroid_fragment_names)
 				asteroid_fragment_models.emplace_back(app.m_assets.m_models.at(n));
 			
-			auto asteroids = asteroid_field(registry, powerups, app.m_assets.m_models.at("asteroid"), asteroid_fragment_models, app.m_assets.m_shaders.at("asteroid_depth"), app.m_assets.m_shaders.at("asteroid"), app.m_assets.m_shaders.at("particle_effect"));
+			auto asteroids = asteroid_field(registry, particles, powerups, app.m_assets.m_models.at("asteroid"), asteroid_fragment_models, app.m_assets.m_shaders.at("asteroid_depth"), app.m_assets.m_shaders.at("asteroid"));
 
 			auto const bounds_radius = 300.f;
 			auto bounds = game::bounds(registry, bounds_radius, app.m_assets.m_shaders.at("bouy_depth"),app.m_assets.m_shaders.at("bouy"), app.m_assets.m_models.at("bouy"));
@@ -108,7 +116,7 @@ namespace bump
 			space_dust.set_base_color_rgb({ 0.25, 0.20, 0.15 });
 			space_dust.set_color_variation_hsv({ 0.05, 0.25, 0.05 });
 
-			auto indicators = game::indicators(registry, app.m_assets.m_shaders.at("indicator"));
+			auto indicators = game::indicators(registry, physics_system, app.m_assets.m_shaders.at("indicator"));
 
 			auto crosshair = game::crosshair(app.m_assets.m_shaders.at("crosshair"));
 			crosshair.m_position = glm::vec2
@@ -183,8 +191,11 @@ namespace bump
 						if (player.m_health.is_alive())
 							player.m_controls.apply(registry.get<physics::rigidbody>(player.m_entity), crosshair, glm::vec2(app.m_window.get_size()), camera_matrices(scene_camera));
 
+						particles.begin_frame();
+
 						// physics:
 						physics_system.update(dt);
+						commands.apply(registry);
 
 						// update player state:
 						player.update(dt);
@@ -241,35 +252,14 @@ namespace bump
 					}
 					
 					auto& renderer = app.m_renderer;
+					renderer.reset_state_stats();
+
 					auto scene_matrices = camera_matrices(scene_camera);
 					auto ui_matrices = camera_matrices(ui_camera);
 
-					renderer.set_framebuffer(gbuf.m_framebuffer);
-
-					renderer.clear_color_buffers({ 0.f, 0.f, 0.f, 1.f });
-					renderer.clear_depth_buffers();
-					renderer.set_viewport({ 0, 0 }, glm::uvec2(app.m_window.get_size()));
-					
-					// render scene
-					{
-						ZoneScopedN("MainLoop - Render Scene");
-
-						bounds.render_scene(renderer, scene_matrices);
-						asteroids.render_scene(renderer, scene_matrices);
-						player.render_scene(renderer, scene_matrices);
-						powerups.render_scene(renderer, scene_matrices);
-					}
-
-					renderer.set_framebuffer(shadow_rt.m_framebuffer);
-					renderer.set_viewport({ 0, 0 }, glm::uvec2(shadow_rt.m_texture.get_size()));
-					renderer.clear_depth_buffers();
-
+					// set up light camera for shadows
 					auto light_matrices = camera_matrices();
-
-					// render depth for shadows
 					{
-						ZoneScopedN("MainLoop - Render Shadow Depth");
-
 						// unproject screen corner to world space
 						auto corner_screen = glm::vec4{ 0.f, 0.f, 1.f, 1.f };
 						auto corner_clip = scene_matrices.m_inv_viewport * corner_screen;
@@ -315,16 +305,54 @@ namespace bump
 						light_camera.m_viewport.m_size = glm::vec2(shadow_rt.m_texture.get_size());
 
 						light_matrices = camera_matrices(light_camera);
+					}
+
+					// cull and write instance data for the scene and shadow passes
+					asteroids.update_instances(scene_matrices, light_matrices);
+
+					renderer.set_framebuffer(gbuf.m_framebuffer);
+
+					renderer.clear_color_buffers({ 0.f, 0.f, 0.f, 1.f });
+					renderer.clear_depth_buffers();
+					renderer.set_viewport({ 0, 0 }, glm::uvec2(app.m_window.get_size()));
+					
+					// render scene
+					{
+						ZoneScopedN("MainLoop - Render Scene");
+
+						scene_queue.clear();
+
+						bounds.render_scene(scene_queue, scene_matrices);
+						asteroids.render_scene(scene_queue, scene_matrices);
+						player.render_scene(scene_queue, scene_matrices);
+						powerups.render_scene(scene_queue, scene_matrices);
+
+						scene_queue.sort();
+						scene_queue.execute(render_backend);
+					}
+
+					renderer.set_framebuffer(shadow_rt.m_framebuffer);
+					renderer.set_viewport({ 0, 0 }, glm::uvec2(shadow_rt.m_texture.get_size()));
+					renderer.clear_depth_buffers();
+
+					// render depth for shadows
+					{
+						ZoneScopedN("MainLoop - Render Shadow Depth");
 
 						// render scene
-						renderer.set_face_culling(gl::renderer::face_culling::COUNTER_CLOCKWISE);
+						shadow_queue.clear();
+
+						auto state = gl::render_queue::render_state();
+						state.m_face_culling = gl::renderer::face_culling::COUNTER_CLOCKWISE;
+						shadow_queue.set_state(state);
 
-						//bounds.render_depth(renderer, light_matrices);
-						asteroids.render_depth(renderer, light_matrices);
-						player.render_depth(renderer, light_matrices);
-						powerups.render_depth(renderer, light_matrices);
+						//bounds.render_depth(shadow_queue, light_matrices);
+						asteroids.render_depth(shadow_queue, light_matrices);
+						player.render_depth(shadow_queue, light_matrices);
+						powerups.render_depth(shadow_queue, light_matrices);
 
-						renderer.set_face_culling(gl::renderer::face_culling::CLOCKWISE);
+						shadow_queue.sort();
+						shadow_queue.execute(render_backend);
 					}
 
 					renderer.set_framebuffer(lighting_rt.m_framebuffer);
@@ -339,8 +367,8 @@ namespace bump
 					
 					// render particles
 					{
-						asteroids.render_particles(renderer, light_matrices, scene_matrices, shadow_rt.m_texture);
-						player.render_particles(renderer, light_matrices, scene_matrices, shadow_rt.m_texture);
+						player.render_particles(renderer, scene_matrices);
+						particles.render(renderer, light_matrices, scene_matrices, shadow_rt.m_texture);
 						space_dust.render_particles(renderer, scene_matrices);
 					}
 
@@ -380,6 +408,16 @@ namespace bump
 						ZoneScopedN("MainLoop - Swap Buffers ");
 						app.m_window.swap_buffers();
 					}
+
+					gl::stream_buffer::end_frame();
+
+					// renderer state changes this frame
+					TracyPlot("GL state calls issued", std::int64_t(renderer.get_state_stats().m_issued));
+					TracyPlot("GL state calls elided", std::int64_t(renderer.get_state_stats().m_elided));
+
+					// point lights this frame
+					TracyPlot("Point lights visible", std::int64_t(lighting.get_point_light_stats().m_visible));
+					TracyPlot("Point lights culled", std::int64_t(lighting.get_point_light_stats().get_culled()));
 				}
 
 				timer.tick();
@@ -34,7 +34,7 @@ namespace bump
 			auto lighting_rt = lighting::lighting_rendertarget(app.m_window.get_size(), gbuf.m_depth_stencil);
 			auto lighting = lighting::lighting_system(registry, 
 				app.m_assets.m_shaders.at("light_directional"), 
-				app.m_assets.m_shaders.at("light_point"), app.m_assets.m_models.at("point_light"),
+				app.m_assets.m_shaders.at("light_point"),
 				app.m_assets.m_shaders.at("light_emissive"));
 			auto tone_map_blit = lighting::tone_map_quad(app.m_assets.m_shaders.at("tone_mapping"));
 
@@ -71,6 +71,8 @@ namespace bump
 			auto skybox = game::skybox(app.m_assets.m_models.at("skybox"), app.m_assets.m_shaders.at("skybox"), app.m_assets.m_cubemaps.at("skybox"));
 
 			auto asteroid = basic_renderable(app.m_assets.m_shaders.at("start_asteroid_depth"), app.m_assets.m_shaders.at("start_asteroid"), app.m_assets.m_models.at("asteroid"));
+			auto scene_queue = gl::render_queue();
+			auto render_backend = gl::renderer_backend(app.m_renderer);
 
 			auto space_dust = particle_field(app.m_assets.m_shaders.at("particle_field"), 5.f, 20);
 			space_dust.set_base_color_rgb({ 0.25, 0.20, 0.15 });
@@ -158,7 +160,9 @@ namespace bump
 					
 					// render scene
 					{
-						asteroid.render(renderer, scene_matrices);
+						scene_queue.clear();
+						asteroid.render(scene_queue, scene_matrices);
+						scene_queue.execute(render_backend);
 					}
 
 					renderer.set_framebuffer(shadow_rt.m_framebuffer);
@@ -172,7 +176,7 @@ namespace bump
 						// ... set light matrices
 
 						// render scene depth
-						//asteroid.render_depth(renderer, light_matrices);
+						//asteroid.render_depth(shadow_queue, light_matrices);
 					}
 
 					renderer.set_framebuffer(lighting_rt.m_framebuffer);
@@ -210,6 +214,8 @@ namespace bump
 					}
 
 					app.m_window.swap_buffers();
+
+					gl::stream_buffer::end_frame();
 				}
 
 				timer.tick();
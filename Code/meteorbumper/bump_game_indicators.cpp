@@ -16,8 +16,9 @@ namespace bump
 	namespace game
 	{
 		
-		indicators::indicators(entt::registry& registry, gl::shader_program const& shader):
+		indicators::indicators(entt::registry& registry, physics::physics_system const& physics_system, gl::shader_program const& shader):
 			m_registry(registry),
+			m_physics_system(physics_system),
 			m_shader(shader),
 			m_in_VertexPosition(shader.get_attribute_location("in_VertexPosition")),
 			m_in_Direction(shader.get_attribute_location("in_Direction")),
@@ -25,12 +26,7 @@ namespace bump
 			m_u_MVP(shader.get_uniform_location("u_MVP")),
 			m_u_Size(shader.get_uniform_location("u_Size"))
 		{
-			m_buffer_positions.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 2, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_VertexPosition, m_buffer_positions, 1);
-			m_buffer_directions.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 2, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_Direction, m_buffer_directions, 1);
-			m_buffer_colors.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_Color, m_buffer_colors, 1);
+
 		}
 
 		void indicators::render(gl::renderer& renderer, glm::vec2 window_size, camera_matrices const& screen_matrices, camera_matrices const& ui_matrices)
@@ -39,12 +35,6 @@ namespace bump
 
 			auto scene_mvp = screen_matrices.model_view_projection_matrix(glm::mat4(1.f));
 
-			struct id_distance
-			{
-				entt::entity m_id;
-				float m_distance;
-			};
-
 			auto const asteroid_color = glm::vec3(0.8f);
 			auto const powerup_colors = std::map<powerups::powerup_type, glm::vec3>
 			{
@@ -55,28 +45,12 @@ namespace bump
 
 			// find closest asteroids
 			{
-				auto view = m_registry.view<asteroid_field::asteroid_data, physics::rigidbody>();
-
-				auto distances = std::vector<id_distance>();
-				distances.reserve(view.size());
-
-				for (auto id : view)
-				{
-					auto const& rb = view.get<physics::rigidbody>(id);
-					auto const distance = glm::distance(m_player_position, rb.get_position());
-					distances.push_back({ id, distance });
-				}
-
-				// find closest 5, discard the rest
-				auto const num = std::min(distances.size(), std::size_t{ 5 });
-				std::partial_sort(distances.begin(), distances.begin() + num, distances.end(),
-					[] (id_distance const& a, id_distance const& b) { return a.m_distance < b.m_distance; });
-				distances.resize(num);
+				auto const closest = m_physics_system.find_k_nearest(m_player_position, 5, physics::collision_layers::ASTEROIDS);
 
 				// add asteroids to the indicator list
-				for (auto id : distances)
+				for (auto id : closest)
 				{
-					auto const& rb = view.get<physics::rigidbody>(id.m_id);
+					auto const& rb = m_registry.get<physics::rigidbody>(id);
 
 					// get world space direction
 					auto direction = rb.get_position() - m_player_position;
@@ -99,28 +73,12 @@ namespace bump
 
 			// find closest powerups
 			{
-				auto view = m_registry.view<powerups::powerup_data, physics::rigidbody>();
-
-				auto distances = std::vector<id_distance>();
-				distances.reserve(view.size());
-
-				for (auto id : view)
-				{
-					auto const& rb = view.get<physics::rigidbody>(id);
-					auto const distance = glm::distance(m_player_position, rb.get_position());
-					distances.push_back({ id, distance });
-				}
-
-				// find closest 5, discard the rest
-				auto const num = std::min(distances.size(), std::size_t{ 5 });
-				std::partial_sort(distances.begin(), distances.begin() + num, distances.end(),
-					[] (id_distance const& a, id_distance const& b) { return a.m_distance < b.m_distance; });
-				distances.resize(num);
+				auto const closest = m_physics_system.find_k_nearest(m_player_position, 5, physics::collision_layers::POWERUPS);
 
 				// add powerups to the indicator list
-				for (auto id : distances)
+				for (auto id : closest)
 				{
-					auto [pu, rb] = view.get<powerups::powerup_data, physics::rigidbody>(id.m_id);
+					auto [pu, rb] = m_registry.get<powerups::powerup_data, physics::rigidbody>(id);
 
 					// get world space direction
 					auto direction = rb.get_position() - m_player_position;
@@ -147,10 +105,14 @@ namespace bump
 			auto instance_count = m_frame_positions.size();
 
 			static_assert(sizeof(glm::vec2) == sizeof(float) * 2, "Unexpected vector size.");
-			m_buffer_positions.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_positions.front()), 2, m_frame_positions.size(), GL_STREAM_DRAW);
-			m_buffer_directions.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_directions.front()), 2, m_frame_directions.size(), GL_STREAM_DRAW);
+			m_buffer_positions.set_data(glm::value_ptr(m_frame_positions.front()), 2, m_frame_positions.size());
+			m_buffer_directions.set_data(glm::value_ptr(m_frame_directions.front()), 2, m_frame_directions.size());
 			static_assert(sizeof(glm::vec3) == sizeof(float) * 3, "Unexpected vector size.");
-			m_buffer_colors.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_colors.front()), 3, m_frame_colors.size(), GL_STREAM_DRAW);
+			m_buffer_colors.set_data(glm::value_ptr(m_frame_colors.front()), 3, m_frame_colors.size());
+
+			m_vertex_array.set_array_buffer(m_in_VertexPosition, m_buffer_positions, 1);
+			m_vertex_array.set_array_buffer(m_in_Direction, m_buffer_directions, 1);
+			m_vertex_array.set_array_buffer(m_in_Color, m_buffer_colors, 1);
 
 			auto mvp = ui_matrices.model_view_projection_matrix(glm::mat4(1.f));
 
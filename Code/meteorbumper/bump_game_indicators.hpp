@@ -8,6 +8,8 @@ namespace bump
 {
 
 	class camera_matrices;
+
+	namespace physics { class physics_system; }
 	
 	namespace game
 	{
@@ -16,7 +18,7 @@ namespace bump
 		{
 		public:
 
-			explicit indicators(entt::registry& registry, gl::shader_program const& shader);
+			explicit indicators(entt::registry& registry, physics::physics_system const& physics_system, gl::shader_program const& shader);
 
 			void set_player_position(glm::vec3 position) { m_player_position = position; }
 
@@ -25,6 +27,7 @@ namespace bump
 		private:
 
 			entt::registry& m_registry;
+			physics::physics_system const& m_physics_system;
 
 			gl::shader_program const& m_shader;
 			GLint m_in_VertexPosition;
@@ -33,9 +36,9 @@ namespace bump
 			GLint m_u_MVP;
 			GLint m_u_Size;
 
-			gl::buffer m_buffer_positions;
-			gl::buffer m_buffer_directions;
-			gl::buffer m_buffer_colors;
+			gl::stream_buffer m_buffer_positions;
+			gl::stream_buffer m_buffer_directions;
+			gl::stream_buffer m_buffer_colors;
 			gl::vertex_array m_vertex_array;
 
 			std::vector<glm::vec2> m_frame_positions;
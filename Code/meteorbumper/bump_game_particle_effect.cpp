@@ -1,28 +1,30 @@
 #include "bump_game_particle_effect.hpp"
 
-#include "bump_camera.hpp"
 #include "bump_random.hpp"
 #include "bump_transform.hpp"
 #include "bump_physics.hpp"
 
 #include <Tracy.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace bump
 {
 	
 	namespace game
 	{
 		
-		particle_effect::particle_effect(entt::registry& registry, gl::shader_program const& shader):
-			m_registry(registry),
-			m_shader(shader),
-			m_in_Position(shader.get_attribute_location("in_Position")),
-			m_in_Color(shader.get_attribute_location("in_Color")),
-			m_in_Size(shader.get_attribute_location("in_Size")),
-			m_u_MVP(shader.get_uniform_location("u_MVP")),
-			m_u_LightViewProjMatrix(shader.get_uniform_location("u_LightViewProjMatrix")),
-			m_u_Shadows(shader.get_uniform_location("u_Shadows")),
-			m_u_EnableShadows(shader.get_uniform_location("u_EnableShadows")),
+		namespace
+		{
+
+			auto const particle_radius_m = 0.01f;
+			auto const particle_restitution = 0.5f;
+
+		} // unnamed
+
+		particle_effect::particle_effect(particle_system& particle_system):
+			m_particle_system(particle_system),
 			m_origin(glm::mat4(1.f)),
 			m_max_lifetime(high_res_duration_from_seconds(2.f)),
 			m_max_lifetime_random(high_res_duration_from_seconds(0.f)),
@@ -35,28 +37,32 @@ namespace bump
 			m_spawning_enabled(false),
 			m_spawn_period(high_res_duration_from_seconds(1.f / 100.f)),
 			m_spawn_accumulator(0),
-			m_color_update_fn(),
-			m_size_update_fn(),
+			m_color_curve(),
+			m_size_curve(),
 			m_max_particle_count(500u),
-			m_rng(std::random_device()())
+			m_burst_budget(std::numeric_limits<std::size_t>::max()),
+			m_burst_merge_radius(0.f),
+			m_merged_burst_count(0),
+			m_rng(std::random_device()(), std::random_device()())
 		{
-			m_instance_positions.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_Position, m_instance_positions, 1);
-			m_instance_colors.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 4, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_Color, m_instance_colors, 1);
-			m_instance_sizes.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 1, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_Size, m_instance_sizes, 1);
+			m_particle_system.add_effect(*this);
 		}
 
 		particle_effect::~particle_effect()
 		{
-			clear();
+			m_particle_system.remove_effect(*this);
 		}
 
 		void particle_effect::clear()
 		{
-			for (auto id : m_particles)
-				m_registry.destroy(id);
+			m_positions.clear();
+			m_velocities.clear();
+			m_lifetimes.clear();
+			m_colors.clear();
+			m_sizes.clear();
+
+			m_bursts.clear();
+			m_merged_burst_count = 0;
 		}
 
 		void particle_effect::spawn_once(std::size_t particle_count)
@@ -65,37 +71,71 @@ namespace bump
 				spawn_particle();
 		}
 
+		void particle_effect::spawn_burst(span<glm::vec3 const> origins, std::size_t count_per_origin)
+		{
+			if (count_per_origin == 0)
+				return;
+
+			for (auto const& o : origins)
+				m_bursts.push_back({ o, count_per_origin, 1 });
+		}
+
 		void particle_effect::update(high_res_duration_t dt)
 		{
+			ZoneScopedN("particle_effect::update()");
+
 			// update particle data:
 			{
-				auto view = m_registry.view<particle_data>();
+				auto const dt_s = high_res_duration_to_seconds(dt);
+
+				for (auto i = std::size_t{ 0 }; i != m_positions.size(); ++i)
+					m_positions[i] += m_velocities[i] * dt_s;
+
+				for (auto i = std::size_t{ 0 }; i != m_lifetimes.size(); ++i)
+					m_lifetimes[i] += dt;
+
+				// evaluate the curves for all particles at once
+				if (!m_color_curve.is_empty() || !m_size_curve.is_empty())
+				{
+					auto const max_lifetime_s = high_res_duration_to_seconds(m_max_lifetime);
+
+					m_frame_ages.resize(m_lifetimes.size());
 
-				for (auto id : m_particles)
+					for (auto i = std::size_t{ 0 }; i != m_lifetimes.size(); ++i)
+						m_frame_ages[i] = high_res_duration_to_seconds(m_lifetimes[i]) / max_lifetime_s;
+
+					auto const ages = span<float const>(m_frame_ages.data(), m_frame_ages.size());
+
+					if (!m_color_curve.is_empty())
+						m_color_curve.evaluate(ages, { m_colors.data(), m_colors.size() });
+
+					if (!m_size_curve.is_empty())
+						m_size_curve.evaluate(ages, { m_sizes.data(), m_sizes.size() });
+				}
+
+				// remove expired particles:
+				for (auto i = std::size_t{ 0 }; i != m_lifetimes.size(); )
 				{
-					auto& p = view.get<particle_data>(id);
-					p.m_lifetime += dt;
-					p.m_color = m_color_update_fn ? m_color_update_fn(id, p) : p.m_color;
-					p.m_size = m_size_update_fn ? m_size_update_fn(id, p) : p.m_size;
+					if (m_lifetimes[i] > m_max_lifetime)
+						remove_particle(i); // swaps the last particle into i, so don't advance
+					else
+						++i;
 				}
+			}
 
-				// destroy expired particles:
-				auto first_dead_particle = std::remove_if(m_particles.begin(), m_particles.end(),
-					[&] (entt::entity id)
-					{
-						auto const& p = view.get<particle_data>(id);
-
-						auto result = (p.m_lifetime > m_max_lifetime);
-
-						if (result)
-							m_registry.destroy(id);
-						
-						return result;
-					});
-				
-				m_particles.erase(first_dead_particle, m_particles.end());
+			// bounce off colliders
+			if (m_collision_mask != 0 && !m_positions.empty())
+			{
+				m_particle_system.get_physics_system().collide_particles(
+					{ m_positions.data(), m_positions.size() },
+					{ m_velocities.data(), m_velocities.size() },
+					particle_radius_m, particle_restitution, m_collision_mask);
 			}
 
+			// spawn queued bursts
+			if (!m_bursts.empty())
+				spawn_bursts();
+
 			// spawn new particles
 			if (m_spawning_enabled)
 			{
@@ -109,100 +149,140 @@ namespace bump
 			}
 		}
 
-		void particle_effect::render(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map)
+		void particle_effect::spawn_particle()
 		{
-			ZoneScopedN("particle_effect::render()");
-
-			if (m_particles.empty())
+			if (get_size() >= m_max_particle_count)
 				return;
 
-			auto instance_count = m_particles.size();
+			auto const dl = std::uniform_real_distribution<float>(0.f, 1.f);
+			auto const l = high_res_duration_from_seconds(high_res_duration_to_seconds(m_max_lifetime_random) * dl(m_rng));
 
-			{
-				ZoneScopedN("particle_effect::render() - get data");
+			auto const p = random::point_in_ring_3d(m_rng, 0.f, m_spawn_radius_m);
+			auto const v = m_base_velocity + m_random_velocity * random::point_in_ring_3d(m_rng, 0.f, 1.f);
 
-				m_frame_positions.reserve(instance_count);
-				m_frame_colors.reserve(instance_count);
-				m_frame_sizes.reserve(instance_count);
+			m_positions.push_back(transform_point_to_world(m_origin, p));
+			m_velocities.push_back(transform_vector_to_world(m_origin, v));
+			m_lifetimes.push_back(l);
+			auto const a = high_res_duration_to_seconds(l) / high_res_duration_to_seconds(m_max_lifetime);
+			m_colors.push_back(m_color_curve.is_empty() ? glm::vec4(1.f) : m_color_curve.evaluate(a));
+			m_sizes.push_back(m_size_curve.is_empty() ? 1.f : m_size_curve.evaluate(a));
+		}
 
-				auto view = m_registry.view<particle_data, physics::rigidbody>();
+		void particle_effect::merge_bursts()
+		{
+			ZoneScopedN("particle_effect::merge_bursts()");
+
+			auto const first = m_bursts.begin() + m_merged_burst_count;
+			auto last = first; // merged bursts are gathered in [first, last)
 
-				for (auto id : m_particles)
+			for (auto b = first; b != m_bursts.end(); ++b)
+			{
+				auto const m = std::find_if(first, last,
+					[&] (burst const& m) { return glm::distance(m.m_origin, b->m_origin) <= m_burst_merge_radius; });
+
+				if (m == last)
 				{
-					auto [p, rb] = view.get<particle_data, physics::rigidbody>(id);
-					m_frame_positions.push_back(rb.get_position());
-					m_frame_colors.push_back(p.m_color);
-					m_frame_sizes.push_back(p.m_size);
+					*last++ = *b;
+					continue;
 				}
-				
-				m_instance_positions.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_positions.front()), 3, instance_count, GL_STREAM_DRAW);
-				m_instance_colors.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_colors.front()), 4, instance_count, GL_STREAM_DRAW);
-				m_instance_sizes.set_data(GL_ARRAY_BUFFER, m_frame_sizes.data(), 1, instance_count, GL_STREAM_DRAW);
-
-				m_frame_positions.clear();
-				m_frame_colors.clear();
-				m_frame_sizes.clear();
+
+				m->m_origin = glm::mix(m->m_origin, b->m_origin, 1.f / float(m->m_hits + 1)); // mean of the merged origins
+				m->m_count = std::max(m->m_count, b->m_count);
+				m->m_hits += 1;
 			}
-			
-			{
-				ZoneScopedN("particle_effect::render() - render");
 
-				renderer.set_depth_write(gl::renderer::depth_write::DISABLED);
-				renderer.set_blending(m_blend_mode);
+			for (auto b = first; b != last; ++b)
+				b->m_count = std::size_t(std::round(float(b->m_count) * std::sqrt(float(b->m_hits))));
 
-				renderer.set_program(m_shader);
-				renderer.set_uniform_4x4f(m_u_MVP, matrices.model_view_projection_matrix(glm::mat4(1.f)));
-				renderer.set_uniform_4x4f(m_u_LightViewProjMatrix, light_matrices.m_view_projection);
-				renderer.set_uniform_1i(m_u_Shadows, 0);
-				renderer.set_texture_2d(0, shadow_map);
-				renderer.set_uniform_1f(m_u_EnableShadows, m_shadows_enabled ? 1.f : 0.f);
-				renderer.set_vertex_array(m_vertex_array);
+			m_bursts.erase(last, m_bursts.end());
+			m_merged_burst_count = m_bursts.size();
+		}
 
-				renderer.draw_arrays(GL_POINTS, 1, instance_count);
+		void particle_effect::spawn_bursts()
+		{
+			ZoneScopedN("particle_effect::spawn_bursts()");
 
-				renderer.clear_texture_2d(0);
-				renderer.clear_vertex_array();
-				renderer.clear_program();
+			if (m_burst_merge_radius > 0.f)
+				merge_bursts();
 
-				renderer.set_blending(gl::renderer::blending::NONE);
-				renderer.set_depth_write(gl::renderer::depth_write::ENABLED);
-			}
-		}
+			auto queued = std::size_t{ 0 };
+			for (auto const& b : m_bursts)
+				queued += b.m_count;
 
-		void particle_effect::spawn_particle()
-		{
-			if (get_size() >= m_max_particle_count)
-				return;
+			auto spawn_count = std::min(queued, m_burst_budget);
+			auto const space = m_max_particle_count - std::min(get_size(), m_max_particle_count);
+			auto create_count = std::min(spawn_count, space); // anything past the max particle count is dropped (as with spawn_once)
 
-			auto id = m_registry.create();
+			auto const granted = m_particle_system.take_burst_budget(create_count);
 
-			auto const dl = std::uniform_real_distribution<float>(0.f, 1.f);
-			auto const l = high_res_duration_from_seconds(high_res_duration_to_seconds(m_max_lifetime_random) * dl(m_rng));
+			if (granted != create_count)
+				spawn_count = create_count = granted; // out of shared budget, leave the rest queued
 
-			auto const particle_mass_kg = 0.005f;
-			auto const particle_radius_m = 0.01f;
+			// generate all the random values up front
+			m_frame_spawn_offsets.resize(create_count);
+			random::points_in_ring_3d(m_rng, 0.f, m_spawn_radius_m, { m_frame_spawn_offsets.data(), create_count });
 
-			auto const p = random::point_in_ring_3d(m_rng, 0.f, m_spawn_radius_m);
-			auto const d = std::uniform_real_distribution<float>(-1.f, 1.f);
-			auto const v = m_base_velocity + m_random_velocity * random::point_in_ring_3d(m_rng, 0.f, 1.f);
+			m_frame_spawn_velocities.resize(create_count);
+			random::points_in_ring_3d(m_rng, 0.f, 1.f, { m_frame_spawn_velocities.data(), create_count });
+
+			m_frame_spawn_lifetimes.resize(create_count);
+
+			for (auto& l : m_frame_spawn_lifetimes)
+				l = random::uniform_float(m_rng);
+
+			m_positions.reserve(get_size() + create_count);
+			m_velocities.reserve(get_size() + create_count);
+			m_lifetimes.reserve(get_size() + create_count);
+			m_colors.reserve(get_size() + create_count);
+			m_sizes.reserve(get_size() + create_count);
+
+			auto const max_lifetime_random_s = high_res_duration_to_seconds(m_max_lifetime_random);
+			auto const max_lifetime_s = high_res_duration_to_seconds(m_max_lifetime);
+
+			auto remaining = spawn_count;
+			auto created = std::size_t{ 0 };
+			auto b = m_bursts.begin();
+
+			for (; b != m_bursts.end() && remaining != 0; ++b)
+			{
+				auto const n = std::min(b->m_count, remaining);
+
+				for (auto i = std::size_t{ 0 }; i != n && created != create_count; ++i, ++created)
+				{
+					auto const l_s = max_lifetime_random_s * m_frame_spawn_lifetimes[created];
+					auto const a = l_s / max_lifetime_s;
+
+					m_positions.push_back(b->m_origin + m_frame_spawn_offsets[created]);
+					m_velocities.push_back(m_base_velocity + m_random_velocity * m_frame_spawn_velocities[created]);
+					m_lifetimes.push_back(high_res_duration_from_seconds(l_s));
+					m_colors.push_back(m_color_curve.is_empty() ? glm::vec4(1.f) : m_color_curve.evaluate(a));
+					m_sizes.push_back(m_size_curve.is_empty() ? 1.f : m_size_curve.evaluate(a));
+				}
 
-			auto& rigidbody = m_registry.emplace<physics::rigidbody>(id);
-			rigidbody.set_mass(particle_mass_kg);
-			rigidbody.set_local_inertia_tensor(physics::make_sphere_inertia_tensor(particle_mass_kg, particle_radius_m));
-			rigidbody.set_position(transform_point_to_world(m_origin, p));
-			rigidbody.set_velocity(transform_vector_to_world(m_origin, v));
+				remaining -= n;
+				b->m_count -= n;
 
-			auto& collider = m_registry.emplace<physics::collider>(id);
-			collider.set_shape({ physics::sphere_shape{ particle_radius_m } });
-			collider.set_collision_layer(physics::collision_layers::PARTICLES);
-			collider.set_collision_mask(m_collision_mask);
+				if (b->m_count != 0)
+					break; // out of budget part way through this burst
+			}
 
-			auto& particle = m_registry.emplace<particle_data>(id);
-			particle.m_lifetime = l;
-			particle.m_color = m_color_update_fn ? m_color_update_fn(id, particle) : glm::vec4(1.f);
-			particle.m_size = m_size_update_fn ? m_size_update_fn(id, particle) : 1.f;
+			m_bursts.erase(m_bursts.begin(), b);
+			m_merged_burst_count = m_bursts.size();
+		}
 
-			m_particles.push_back(id);
+		void particle_effect::remove_particle(std::size_t index)
+		{
+			auto const swap_remove = [=] (auto& v)
+			{
+				v[index] = v.back();
+				v.pop_back();
+			};
+
+			swap_remove(m_positions);
+			swap_remove(m_velocities);
+			swap_remove(m_lifetimes);
+			swap_remove(m_colors);
+			swap_remove(m_sizes);
 		}
 		
 	} // game
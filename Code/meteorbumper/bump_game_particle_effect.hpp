@@ -1,12 +1,16 @@
 #pragma once
 
 #include "bump_color_map.hpp"
+#include "bump_game_particle_system.hpp"
 #include "bump_gl.hpp"
+#include "bump_physics.hpp"
+#include "bump_random.hpp"
+#include "bump_span.hpp"
 #include "bump_time.hpp"
 
-#include <entt.hpp>
 #include <glm/glm.hpp>
 
+#include <limits>
 #include <map>
 #include <random>
 #include <vector>
@@ -14,8 +18,6 @@
 namespace bump
 {
 
-	class camera_matrices;
-	
 	namespace game
 	{
 
@@ -23,16 +25,18 @@ namespace bump
 		{
 		public:
 
-			struct particle_data
-			{
-				high_res_duration_t m_lifetime = high_res_duration_from_seconds(2.f);
-				glm::vec4 m_color = glm::vec4(1.f);
-				float m_size = 1.f;
-			};
+			// note: particles aren't entities. they're stored in parallel arrays (one per attribute),
+			// and dead particles are swapped with the last live particle, so the arrays stay packed.
+			// collisions are one-way (particles bounce off colliders, but don't push anything).
 
-			explicit particle_effect(entt::registry& registry, gl::shader_program const& shader);
+			explicit particle_effect(particle_system& particle_system);
 			~particle_effect();
 
+			particle_effect(particle_effect const&) = delete;
+			particle_effect& operator=(particle_effect const&) = delete;
+			particle_effect(particle_effect&&) = delete;
+			particle_effect& operator=(particle_effect&&) = delete;
+
 			void set_origin(glm::mat4 origin_transform) { m_origin = origin_transform; }
 			glm::mat4 get_origin() const { return m_origin; }
 
@@ -42,10 +46,9 @@ namespace bump
 			void set_max_lifetime_random(high_res_duration_t time) { m_max_lifetime_random = time; }
 			high_res_duration_t get_max_lifetime_random() const { return m_max_lifetime_random; }
 
-			using color_update_fn_t = std::function<glm::vec4(entt::entity, particle_data const&)>;
-			void set_color_update_fn(color_update_fn_t fn) { m_color_update_fn = fn; }
-			using size_update_fn_t = std::function<float(entt::entity, particle_data const&)>;
-			void set_size_update_fn(size_update_fn_t fn) { m_size_update_fn = fn; }
+			// color and size over the particle lifetime (as a fraction of the max lifetime)
+			void set_color_curve(std::map<float, glm::vec4> const& color_map) { m_color_curve = curve_lut<glm::vec4>(color_map); }
+			void set_size_curve(std::map<float, float> const& size_map) { m_size_curve = curve_lut<float>(size_map); }
 
 			void set_collision_mask(std::uint32_t mask) { m_collision_mask = mask; }
 			std::uint32_t get_collision_mask() const { return m_collision_mask; }
@@ -73,34 +76,42 @@ namespace bump
 
 			void set_max_particle_count(std::size_t particle_count) { m_max_particle_count = particle_count; }
 
-			std::size_t get_size() { return m_particles.size(); }
-			bool is_empty() { return m_particles.empty(); }
+			std::size_t get_size() const { return m_positions.size(); }
+			bool is_empty() const { return m_positions.empty(); }
 			void clear();
 
 			void spawn_once(std::size_t particle_count);
 
+			// queue a burst of particles at each origin. bursts are spawned together in the next update.
+			// note: burst origins are world space positions, and the base / random velocities are used as world space.
+			void spawn_burst(span<glm::vec3 const> origins, std::size_t count_per_origin);
+			void spawn_burst(glm::vec3 origin, std::size_t count) { spawn_burst({ &origin, 1 }, count); }
+
+			// max particles spawned from bursts each update. any more are left queued for later updates.
+			// note: the particle_system also has a budget shared by all effects.
+			void set_burst_budget(std::size_t particles_per_update) { m_burst_budget = particles_per_update; }
+			std::size_t get_burst_budget() const { return m_burst_budget; }
+
+			// bursts queued in the same update closer together than this are merged into one.
+			// a merged burst of n bursts emits (largest burst count * sqrt(n)) particles. 0 to disable.
+			void set_burst_merge_radius(float radius) { m_burst_merge_radius = radius; }
+			float get_burst_merge_radius() const { return m_burst_merge_radius; }
+
 			void update(high_res_duration_t dt);
-			void render(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map);
+
+			// particle data for rendering (see particle_system::render())
+			span<glm::vec3 const> get_positions() const { return { m_positions.data(), m_positions.size() }; }
+			span<glm::vec4 const> get_colors() const { return { m_colors.data(), m_colors.size() }; }
+			span<float const> get_sizes() const { return { m_sizes.data(), m_sizes.size() }; }
 			
 		private:
 
 			void spawn_particle();
+			void merge_bursts();
+			void spawn_bursts();
+			void remove_particle(std::size_t index);
 
-			entt::registry& m_registry;
-
-			gl::shader_program const& m_shader;
-			GLint m_in_Position;
-			GLint m_in_Color;
-			GLint m_in_Size;
-			GLint m_u_MVP;
-			GLint m_u_LightViewProjMatrix;
-			GLint m_u_Shadows;
-			GLint m_u_EnableShadows;
-
-			gl::buffer m_instance_positions;
-			gl::buffer m_instance_colors;
-			gl::buffer m_instance_sizes;
-			gl::vertex_array m_vertex_array;
+			particle_system& m_particle_system;
 
 			glm::mat4 m_origin;
 			high_res_duration_t m_max_lifetime;
@@ -116,37 +127,37 @@ namespace bump
 			high_res_duration_t m_spawn_period;
 			high_res_duration_t m_spawn_accumulator;
 			
-			color_update_fn_t m_color_update_fn;
-			size_update_fn_t m_size_update_fn;
+			curve_lut<glm::vec4> m_color_curve;
+			curve_lut<float> m_size_curve;
 
 			std::size_t m_max_particle_count;
-			std::vector<entt::entity> m_particles;
-			
-			std::vector<glm::vec3> m_frame_positions;
-			std::vector<glm::vec4> m_frame_colors;
-			std::vector<float> m_frame_sizes;
 
-			std::mt19937 m_rng;
-		};
-
-		inline particle_effect::color_update_fn_t make_color_update_fn(particle_effect const& effect, std::map<float, glm::vec4> color_map)
-		{
-			return [&, color_map] (entt::entity, particle_effect::particle_data const& p)
+			struct burst
 			{
-				auto a = std::clamp(high_res_duration_to_seconds(p.m_lifetime) / high_res_duration_to_seconds(effect.get_max_lifetime()), 0.f, 1.f);
-				return get_color_from_map(color_map, a);
+				glm::vec3 m_origin;
+				std::size_t m_count;
+				std::size_t m_hits; // number of bursts merged into this one
 			};
-		}
 
-		inline particle_effect::size_update_fn_t make_size_update_fn(particle_effect const& effect, std::map<float, float> size_map)
-		{
-			return [&, size_map] (entt::entity, particle_effect::particle_data const& p)
-			{
-				auto a = std::clamp(high_res_duration_to_seconds(p.m_lifetime) / high_res_duration_to_seconds(effect.get_max_lifetime()), 0.f, 1.f);
-				return get_size_from_map(size_map, a);
-			};
-		}
-		
+			std::size_t m_burst_budget;
+			float m_burst_merge_radius;
+			std::vector<burst> m_bursts;
+			std::size_t m_merged_burst_count; // bursts at the front that have already been merged (left over from previous updates)
+
+			std::vector<glm::vec3> m_positions;
+			std::vector<glm::vec3> m_velocities;
+			std::vector<high_res_duration_t> m_lifetimes;
+			std::vector<glm::vec4> m_colors;
+			std::vector<float> m_sizes;
+
+			std::vector<float> m_frame_ages; // lifetime / max lifetime
+			std::vector<glm::vec3> m_frame_spawn_offsets; // random values for spawning bursts
+			std::vector<glm::vec3> m_frame_spawn_velocities;
+			std::vector<float> m_frame_spawn_lifetimes;
+
+			random::pcg32 m_rng;
+		};
+
 	} // game
 	
 } // bump
@@ -0,0 +1,258 @@
+#include "bump_game_particle_system.hpp"
+
+#include "bump_camera.hpp"
+#include "bump_die.hpp"
+#include "bump_game_particle_effect.hpp"
+#include "bump_radix_sort.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <Tracy.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace bump
+{
+	
+	namespace game
+	{
+		
+		namespace
+		{
+
+			// values = [ values[order[0]], values[order[1]], ... ]
+			template<class T>
+			void apply_order(std::vector<T>& values, std::vector<std::uint32_t> const& order, std::vector<T>& scratch)
+			{
+				scratch.resize(values.size());
+
+				for (auto i = std::size_t{ 0 }; i != order.size(); ++i)
+					scratch[i] = values[order[i]];
+
+				values.swap(scratch);
+			}
+
+		} // unnamed
+
+		particle_system::particle_system(physics::physics_system const& physics_system, gl::shader_program const& shader):
+			m_physics_system(physics_system),
+			m_burst_budget(1000u),
+			m_burst_budget_used(0),
+			m_depth_sort(depth_sort::EXACT),
+			m_shader(shader),
+			m_in_Position(shader.get_attribute_location("in_Position")),
+			m_in_Color(shader.get_attribute_location("in_Color")),
+			m_in_Size(shader.get_attribute_location("in_Size")),
+			m_in_EffectIndex(shader.get_attribute_location("in_EffectIndex")),
+			m_u_MVP(shader.get_uniform_location("u_MVP")),
+			m_u_LightViewProjMatrix(shader.get_uniform_location("u_LightViewProjMatrix")),
+			m_u_Shadows(shader.get_uniform_location("u_Shadows")),
+			m_u_EnableShadows(shader.get_uniform_location("u_EnableShadows"))
+		{
+
+		}
+
+		std::size_t particle_system::take_burst_budget(std::size_t particle_count)
+		{
+			auto const available = m_burst_budget - std::min(m_burst_budget_used, m_burst_budget);
+			auto const result = std::min(particle_count, available);
+
+			m_burst_budget_used += result;
+
+			return result;
+		}
+
+		void particle_system::add_effect(particle_effect& effect)
+		{
+			die_if(std::find(m_effects.begin(), m_effects.end(), &effect) != m_effects.end());
+
+			m_effects.push_back(&effect);
+		}
+
+		void particle_system::remove_effect(particle_effect& effect)
+		{
+			auto const e = std::find(m_effects.begin(), m_effects.end(), &effect);
+			die_if(e == m_effects.end());
+
+			m_effects.erase(e);
+		}
+
+		void particle_system::render(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map)
+		{
+			ZoneScopedN("particle_system::render()");
+
+			if (std::all_of(m_effects.begin(), m_effects.end(), [] (particle_effect const* e) { return e->is_empty(); }))
+				return;
+
+			renderer.set_depth_write(gl::renderer::depth_write::DISABLED);
+
+			renderer.set_program(m_shader);
+			renderer.set_uniform_4x4f(m_u_MVP, matrices.model_view_projection_matrix(glm::mat4(1.f)));
+			renderer.set_uniform_4x4f(m_u_LightViewProjMatrix, light_matrices.m_view_projection);
+			renderer.set_uniform_1i(m_u_Shadows, 0);
+			renderer.set_texture_2d(0, shadow_map);
+
+			// one batch per blend mode (alpha blended before additive, so the additive effects stay bright)
+			render_batch(renderer, gl::renderer::blending::NONE, matrices.m_view);
+			render_batch(renderer, gl::renderer::blending::BLEND, matrices.m_view);
+			render_batch(renderer, gl::renderer::blending::ADD, matrices.m_view);
+			render_batch(renderer, gl::renderer::blending::MOD, matrices.m_view);
+
+			renderer.clear_texture_2d(0);
+			renderer.clear_vertex_array();
+			renderer.clear_program();
+
+			renderer.set_blending(gl::renderer::blending::NONE);
+			renderer.set_depth_write(gl::renderer::depth_write::ENABLED);
+		}
+
+		void particle_system::render_batch(gl::renderer& renderer, gl::renderer::blending blend_mode, glm::mat4 const& view)
+		{
+			ZoneScopedN("particle_system::render_batch()");
+
+			auto const max_effects = std::size_t{ 16 }; // must match effect_max in particle_effect.vert
+			auto const no_slot = std::numeric_limits<std::uint32_t>::max();
+
+			// gather every effect with this blend mode, so they can be sorted together
+			for (auto effect : m_effects)
+			{
+				if (effect->get_blend_mode() != blend_mode || effect->is_empty())
+					continue;
+
+				auto const index = (std::uint32_t)m_frame_effect_shadows.size();
+				m_frame_effect_shadows.push_back(effect->get_shadows_enabled() ? 1.f : 0.f);
+
+				auto const positions = effect->get_positions();
+				auto const colors = effect->get_colors();
+				auto const sizes = effect->get_sizes();
+
+				m_frame_positions.insert(m_frame_positions.end(), positions.begin(), positions.end());
+				m_frame_colors.insert(m_frame_colors.end(), colors.begin(), colors.end());
+				m_frame_sizes.insert(m_frame_sizes.end(), sizes.begin(), sizes.end());
+				m_frame_effect_indices.insert(m_frame_effect_indices.end(), positions.size(), index);
+			}
+
+			auto const count = m_frame_positions.size();
+
+			if (count == 0)
+			{
+				m_frame_effect_shadows.clear();
+				return;
+			}
+
+			// other blend modes don't depend on draw order
+			if (blend_mode == gl::renderer::blending::BLEND && m_depth_sort != depth_sort::NONE)
+				sort_back_to_front(view);
+
+			// draws a range of particles (with effect indices already changed to uniform slots)
+			auto const draw = [&] (std::size_t first, std::size_t last)
+			{
+				auto const instance_count = last - first;
+
+				m_instance_positions.set_data(glm::value_ptr(m_frame_positions[first]), 3, instance_count);
+				m_instance_colors.set_data(glm::value_ptr(m_frame_colors[first]), 4, instance_count);
+				m_instance_sizes.set_data(m_frame_sizes.data() + first, 1, instance_count);
+				m_instance_effect_indices.set_data(m_frame_effect_indices.data() + first, 1, instance_count);
+
+				// the vertex array is re-pointed at the new data, which unbinds it
+				m_vertex_array.set_array_buffer(m_in_Position, m_instance_positions, 1);
+				m_vertex_array.set_array_buffer(m_in_Color, m_instance_colors, 1);
+				m_vertex_array.set_array_buffer(m_in_Size, m_instance_sizes, 1);
+				m_vertex_array.set_array_buffer(m_in_EffectIndex, m_instance_effect_indices, 1);
+				renderer.set_vertex_array(m_vertex_array);
+
+				m_frame_enable_shadows.resize(max_effects, 0.f);
+
+				renderer.set_blending(blend_mode);
+				renderer.set_uniform_data_1f(m_u_EnableShadows, m_frame_enable_shadows.data(), max_effects);
+				renderer.draw_arrays(GL_POINTS, 1, instance_count);
+			};
+
+			// split the (sorted) particles into consecutive draws that use at most max_effects effects each.
+			// the draws are in order, so the sort order holds across draws.
+			m_frame_effect_slots.assign(m_frame_effect_shadows.size(), no_slot);
+			m_frame_enable_shadows.clear();
+
+			auto first = std::size_t{ 0 };
+
+			for (auto i = std::size_t{ 0 }; i != count; ++i)
+			{
+				auto const effect = m_frame_effect_indices[i];
+
+				if (m_frame_effect_slots[effect] == no_slot)
+				{
+					// out of per-effect uniform slots, so draw what we have so far
+					if (m_frame_enable_shadows.size() == max_effects)
+					{
+						draw(first, i);
+						first = i;
+
+						std::fill(m_frame_effect_slots.begin(), m_frame_effect_slots.end(), no_slot);
+						m_frame_enable_shadows.clear();
+					}
+
+					m_frame_effect_slots[effect] = (std::uint32_t)m_frame_enable_shadows.size();
+					m_frame_enable_shadows.push_back(m_frame_effect_shadows[effect]);
+				}
+
+				m_frame_effect_indices[i] = m_frame_effect_slots[effect];
+			}
+
+			draw(first, count);
+
+			m_frame_positions.clear();
+			m_frame_colors.clear();
+			m_frame_sizes.clear();
+			m_frame_effect_indices.clear();
+			m_frame_effect_shadows.clear();
+			m_frame_enable_shadows.clear();
+		}
+
+
+		void particle_system::sort_back_to_front(glm::mat4 const& view)
+		{
+			ZoneScopedN("particle_system::sort_back_to_front()");
+
+			auto const count = m_frame_positions.size();
+
+			// view space z (the camera looks down -z, so ascending z is furthest first)
+			auto const view_z = glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+
+			m_frame_view_depths.resize(count);
+
+			for (auto i = std::size_t{ 0 }; i != count; ++i)
+				m_frame_view_depths[i] = glm::dot(view_z, glm::vec4(m_frame_positions[i], 1.f));
+
+			m_frame_sort_keys.resize(count);
+
+			auto key_bits = 32u;
+
+			if (m_depth_sort == depth_sort::EXACT)
+			{
+				for (auto i = std::size_t{ 0 }; i != count; ++i)
+					m_frame_sort_keys[i] = float_to_radix_key(m_frame_view_depths[i]);
+			}
+			else
+			{
+				auto const [min, max] = std::minmax_element(m_frame_view_depths.begin(), m_frame_view_depths.end());
+				auto const range = *max - *min;
+				auto const scale = (range == 0.f) ? 0.f : 255.f / range;
+
+				for (auto i = std::size_t{ 0 }; i != count; ++i)
+					m_frame_sort_keys[i] = std::uint32_t((m_frame_view_depths[i] - *min) * scale);
+
+				key_bits = 8u;
+			}
+
+			radix_sort_indices({ m_frame_sort_keys.data(), count }, m_frame_sort_order, m_frame_sort_scratch, key_bits);
+
+			apply_order(m_frame_positions, m_frame_sort_order, m_frame_sorted_positions);
+			apply_order(m_frame_colors, m_frame_sort_order, m_frame_sorted_colors);
+			apply_order(m_frame_sizes, m_frame_sort_order, m_frame_sorted_sizes);
+			apply_order(m_frame_effect_indices, m_frame_sort_order, m_frame_sorted_effect_indices);
+		}
+		
+	} // game
+	
+} // bump
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "bump_gl.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bump
+{
+
+	class camera_matrices;
+
+	namespace physics { class physics_system; }
+	
+	namespace game
+	{
+
+		class particle_effect;
+		
+		// state shared by all the particle effects.
+		// also renders all the effects, with one upload and draw call per blend mode.
+		class particle_system
+		{
+		public:
+
+			explicit particle_system(physics::physics_system const& physics_system, gl::shader_program const& shader);
+
+			particle_system(particle_system const&) = delete;
+			particle_system& operator=(particle_system const&) = delete;
+			particle_system(particle_system&&) = delete;
+			particle_system& operator=(particle_system&&) = delete;
+
+			physics::physics_system const& get_physics_system() const { return m_physics_system; }
+
+			// max particles spawned from bursts each frame, across all effects.
+			void set_burst_budget(std::size_t particles_per_frame) { m_burst_budget = particles_per_frame; }
+			std::size_t get_burst_budget() const { return m_burst_budget; }
+
+			// call at the start of each frame (before updating any effects).
+			void begin_frame() { m_burst_budget_used = 0; }
+
+			// returns how many of the requested particles may be spawned this frame.
+			std::size_t take_burst_budget(std::size_t particle_count);
+
+			// note: called by particle_effect on construction / destruction.
+			void add_effect(particle_effect& effect);
+			void remove_effect(particle_effect& effect);
+
+			// alpha blended particles are sorted back to front before drawing.
+			// BUCKETED sorts by 256 depth slices between the nearest and furthest particle (cheaper, but only roughly in order).
+			enum class depth_sort { EXACT, BUCKETED, NONE };
+			void set_depth_sort(depth_sort mode) { m_depth_sort = mode; }
+			depth_sort get_depth_sort() const { return m_depth_sort; }
+
+			void render(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map);
+
+		private:
+
+			void render_batch(gl::renderer& renderer, gl::renderer::blending blend_mode, glm::mat4 const& view);
+			void sort_back_to_front(glm::mat4 const& view);
+
+			physics::physics_system const& m_physics_system;
+
+			std::size_t m_burst_budget;
+			std::size_t m_burst_budget_used;
+
+			std::vector<particle_effect*> m_effects;
+
+			depth_sort m_depth_sort;
+
+			gl::shader_program const& m_shader;
+			GLint m_in_Position;
+			GLint m_in_Color;
+			GLint m_in_Size;
+			GLint m_in_EffectIndex;
+			GLint m_u_MVP;
+			GLint m_u_LightViewProjMatrix;
+			GLint m_u_Shadows;
+			GLint m_u_EnableShadows;
+
+			gl::stream_buffer m_instance_positions;
+			gl::stream_buffer m_instance_colors;
+			gl::stream_buffer m_instance_sizes;
+			gl::stream_buffer m_instance_effect_indices;
+			gl::vertex_array m_vertex_array;
+
+			std::vector<glm::vec3> m_frame_positions;
+			std::vector<glm::vec4> m_frame_colors;
+			std::vector<float> m_frame_sizes;
+			std::vector<std::uint32_t> m_frame_effect_indices;
+			std::vector<float> m_frame_effect_shadows; // per effect with the current blend mode
+			std::vector<std::uint32_t> m_frame_effect_slots; // per effect with the current blend mode, the uniform slot in the current draw
+			std::vector<float> m_frame_enable_shadows; // per uniform slot in the current draw
+
+			std::vector<float> m_frame_view_depths;
+			std::vector<std::uint32_t> m_frame_sort_keys;
+			std::vector<std::uint32_t> m_frame_sort_order;
+			std::vector<std::uint32_t> m_frame_sort_scratch;
+			std::vector<glm::vec3> m_frame_sorted_positions;
+			std::vector<glm::vec4> m_frame_sorted_colors;
+			std::vector<float> m_frame_sorted_sizes;
+			std::vector<std::uint32_t> m_frame_sorted_effect_indices;
+		};
+		
+	} // game
+	
+} // bump
\ No newline at end of file
@@ -10,7 +10,9 @@
 
 #include <Tracy.hpp>
 
+#include <array>
 #include <iostream>
+#include <iterator>
 
 namespace bump
 {
@@ -153,8 +155,9 @@ namespace bump
 
 		} // unnamed
 
-		player_lasers::player_lasers(entt::registry& registry, gl::shader_program const& shader, gl::shader_program const& hit_shader):
+		player_lasers::player_lasers(entt::registry& registry, particle_system& particles, gl::shader_program const& shader):
 			m_registry(registry),
+			m_beam_pool(registry),
 			m_shader(shader),
 			m_in_Color(shader.get_attribute_location("in_Color")),
 			m_in_Position(shader.get_attribute_location("in_Position")),
@@ -165,20 +168,12 @@ namespace bump
 			m_time_since_firing(m_firing_period),
 			m_beam_speed_m_per_s(100.f),
 			m_beam_length_factor(0.5f),
-			m_low_damage_hit_effects(registry, hit_shader), 
-			m_medium_damage_hit_effects(registry, hit_shader),
-			m_high_damage_hit_effects(registry, hit_shader)
+			m_low_damage_hit_effects(particles), 
+			m_medium_damage_hit_effects(particles),
+			m_high_damage_hit_effects(particles)
 		{
-			// set up instance buffers
-			m_instance_color.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_Color, m_instance_color, 1);
-			m_instance_position.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_Position, m_instance_position, 1);
-			m_instance_direction.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_Direction, m_instance_direction, 1);
-			m_instance_beam_length.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 1, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_BeamLength, m_instance_beam_length, 1);
-			
+			// note: instance buffers are set up each frame (see render())
+
 			// set up two emitters to start with (todo: proper configurations based on upgrade level...)
 			auto left_emitter = emitter
 			{
@@ -215,8 +210,9 @@ namespace bump
 				m_low_damage_hit_effects.set_random_velocity({ 10.f, 10.f, 10.f });
 				m_low_damage_hit_effects.set_max_lifetime(high_res_duration_from_seconds(0.75f));
 				m_low_damage_hit_effects.set_max_lifetime_random(high_res_duration_from_seconds(0.05f));
-				m_low_damage_hit_effects.set_color_update_fn(make_color_update_fn(m_low_damage_hit_effects, low_damage_color_map));
+				m_low_damage_hit_effects.set_color_curve(low_damage_color_map);
 				m_low_damage_hit_effects.set_max_particle_count(100);
+				m_low_damage_hit_effects.set_burst_merge_radius(1.f);
 				
 				auto const medium_damage_color_map = std::map<float, glm::vec4>
 				{
@@ -229,8 +225,9 @@ namespace bump
 				m_medium_damage_hit_effects.set_random_velocity({ 10.f, 10.f, 10.f });
 				m_medium_damage_hit_effects.set_max_lifetime(high_res_duration_from_seconds(0.75f));
 				m_medium_damage_hit_effects.set_max_lifetime_random(high_res_duration_from_seconds(0.05f));
-				m_medium_damage_hit_effects.set_color_update_fn(make_color_update_fn(m_medium_damage_hit_effects, medium_damage_color_map));
+				m_medium_damage_hit_effects.set_color_curve(medium_damage_color_map);
 				m_medium_damage_hit_effects.set_max_particle_count(100);
+				m_medium_damage_hit_effects.set_burst_merge_radius(1.f);
 				
 				auto const high_damage_color_map = std::map<float, glm::vec4>
 				{
@@ -243,8 +240,9 @@ namespace bump
 				m_high_damage_hit_effects.set_random_velocity({ 10.f, 10.f, 10.f });
 				m_high_damage_hit_effects.set_max_lifetime(high_res_duration_from_seconds(0.75f));
 				m_high_damage_hit_effects.set_max_lifetime_random(high_res_duration_from_seconds(0.05f));
-				m_high_damage_hit_effects.set_color_update_fn(make_color_update_fn(m_high_damage_hit_effects, high_damage_color_map));
+				m_high_damage_hit_effects.set_color_curve(high_damage_color_map);
 				m_high_damage_hit_effects.set_max_particle_count(100);
+				m_high_damage_hit_effects.set_burst_merge_radius(1.f);
 			}
 		}
 
@@ -252,7 +250,7 @@ namespace bump
 		{
 			for (auto const& emitter : m_emitters)
 				for (auto beam : emitter.m_beams)
-					m_registry.destroy(beam);
+					m_beam_pool.release(beam);
 		}
 
 		void player_lasers::upgrade()
@@ -379,15 +377,15 @@ namespace bump
 				// add a new beam to each emitter
 				for (auto& emitter : m_emitters)
 				{
-					auto beam_entity = m_registry.create();
+					auto beam_entity = m_beam_pool.create();
 					
-					auto& beam_physics = m_registry.emplace<physics::rigidbody>(beam_entity);
+					auto& beam_physics = m_registry.emplace_or_replace<physics::rigidbody>(beam_entity);
 					beam_physics.set_mass(0.1f);
 					beam_physics.set_local_inertia_tensor(physics::make_sphere_inertia_tensor(0.1f, 0.1f));
 					beam_physics.set_position(transform_point_to_world(player_transform, emitter.m_origin));
 					beam_physics.set_velocity(player_velocity + forwards(player_transform) * m_beam_speed_m_per_s);
 
-					auto& beam_collision = m_registry.emplace<physics::collider>(beam_entity);
+					auto& beam_collision = m_registry.emplace_or_replace<physics::collider>(beam_entity);
 					beam_collision.set_shape({ physics::sphere_shape{ 0.1f } }); // todo: line!
 					beam_collision.set_collision_layer(physics::collision_layers::PLAYER_WEAPONS);
 					beam_collision.set_collision_mask(~physics::collision_layers::PLAYER);
@@ -397,26 +395,30 @@ namespace bump
 						auto& bs = m_registry.get<beam_segment>(beam_entity);
 						bs.m_collided = true;
 
-						if (bs.m_color == g_low_damage_color)
-							m_low_damage_frame_hit_positions.push_back(hit.m_point);
-						else if (bs.m_color == g_medium_damage_color)
-							m_medium_damage_frame_hit_positions.push_back(hit.m_point);
-						else if (bs.m_color == g_high_damage_color)
-							m_high_damage_frame_hit_positions.push_back(hit.m_point);
+						auto effect = 
+							(bs.m_color == g_low_damage_color) ? &m_low_damage_hit_effects :
+							(bs.m_color == g_medium_damage_color) ? &m_medium_damage_hit_effects :
+							(bs.m_color == g_high_damage_color) ? &m_high_damage_hit_effects :
+							nullptr;
+
+						if (!effect)
+							return;
+
+						effect->spawn_burst(hit.m_point, 15);
 					};
 
 					beam_collision.set_callback(std::move(deleter));
 
-					auto& segment = m_registry.emplace<beam_segment>(beam_entity);
+					auto& segment = m_registry.emplace_or_replace<beam_segment>(beam_entity);
 					segment.m_color = emitter.m_color;
 					segment.m_beam_length = 0.f;
 					segment.m_lifetime = high_res_duration_t{ 0 };
 					segment.m_collided = false;
 
-					auto& damage = m_registry.emplace<player_weapon_damage>(beam_entity);
+					auto& damage = m_registry.emplace_or_replace<player_weapon_damage>(beam_entity);
 					damage.m_damage = emitter.m_damage;
 
-					auto& light = m_registry.emplace<lighting::point_light>(beam_entity);
+					auto& light = m_registry.emplace_or_replace<lighting::point_light>(beam_entity);
 					light.m_position = beam_physics.get_position();
 					light.m_color = segment.m_color * 10.5f;
 					light.m_radius = 15.f;
@@ -468,7 +470,7 @@ namespace bump
 							auto result = (segment.m_lifetime > emitter.m_max_lifetime) || segment.m_collided;
 
 							if (result)
-								m_registry.destroy(b);
+								m_beam_pool.release(b);
 
 							return result;
 						});
@@ -478,47 +480,29 @@ namespace bump
 			}
 
 			// update hit effects
-			for (auto p : m_low_damage_frame_hit_positions)
-			{
-				auto m = glm::mat4(1.f);
-				set_position(m, p);
-
-				m_low_damage_hit_effects.set_origin(m);
-				m_low_damage_hit_effects.spawn_once(15);
-			}
-			m_low_damage_frame_hit_positions.clear();
-			
-			for (auto p : m_medium_damage_frame_hit_positions)
-			{
-				auto m = glm::mat4(1.f);
-				set_position(m, p);
-
-				m_medium_damage_hit_effects.set_origin(m);
-				m_medium_damage_hit_effects.spawn_once(15);
-			}
-			m_medium_damage_frame_hit_positions.clear();
-			
-			for (auto p : m_high_damage_frame_hit_positions)
-			{
-				auto m = glm::mat4(1.f);
-				set_position(m, p);
-
-				m_high_damage_hit_effects.set_origin(m);
-				m_high_damage_hit_effects.spawn_once(15);
-			}
-			m_high_damage_frame_hit_positions.clear();
-
 			m_low_damage_hit_effects.update(dt);
 			m_medium_damage_hit_effects.update(dt);
 			m_high_damage_hit_effects.update(dt);
 		}
 
-		void player_lasers::render(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map)
+		void player_lasers::render(gl::renderer& renderer, camera_matrices const& matrices)
 		{
 			ZoneScopedN("player_lasers::render()");
 
-			// get beam instance data for this frame
-			auto view = m_registry.view<beam_segment, physics::rigidbody>();
+			auto view = m_registry.view<beam_segment, physics::rigidbody>(entt::exclude<inactive_tag>);
+
+			auto const instance_count = std::size_t(std::distance(view.begin(), view.end()));
+
+			if (instance_count == 0)
+				return;
+
+			// write beam instance data straight into the instance buffers
+			auto const colors = reinterpret_cast<glm::vec3*>(m_instance_color.map<float>(3, instance_count).data());
+			auto const positions = reinterpret_cast<glm::vec3*>(m_instance_position.map<float>(3, instance_count).data());
+			auto const directions = reinterpret_cast<glm::vec3*>(m_instance_direction.map<float>(3, instance_count).data());
+			auto const beam_lengths = m_instance_beam_length.map<float>(1, instance_count).data();
+
+			auto i = std::size_t{ 0 };
 
 			for (auto id : view)
 			{
@@ -529,52 +513,42 @@ namespace bump
 
 				auto const& segment = view.get<beam_segment>(id);
 
-				m_frame_instance_colors.push_back(segment.m_color);
-				m_frame_instance_positions.push_back(physics.get_position());
-				m_frame_instance_directions.push_back(beam_direction);
-				m_frame_instance_beam_lengths.push_back(segment.m_beam_length);
+				colors[i] = segment.m_color;
+				positions[i] = physics.get_position();
+				directions[i] = beam_direction;
+				beam_lengths[i] = segment.m_beam_length;
+				++i;
 			}
 
-			// upload beam instance data to gpu buffers
-			auto const instance_count = m_frame_instance_colors.size();
+			m_instance_color.commit();
+			m_instance_position.commit();
+			m_instance_direction.commit();
+			m_instance_beam_length.commit();
 
-			if (instance_count != 0)
-			{
-				m_instance_color.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_instance_colors.front()), 3, instance_count, GL_STREAM_DRAW);
-				m_instance_position.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_instance_positions.front()), 3, instance_count, GL_STREAM_DRAW);
-				m_instance_direction.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_instance_directions.front()), 3, instance_count, GL_STREAM_DRAW);
-				m_instance_beam_length.set_data(GL_ARRAY_BUFFER, m_frame_instance_beam_lengths.data(), 1, instance_count, GL_STREAM_DRAW);
-
-				// render beams
-				auto mvp = matrices.model_view_projection_matrix(glm::mat4(1.f));
-				
-				renderer.set_depth_write(gl::renderer::depth_write::DISABLED);
-
-				renderer.set_program(m_shader);
-				renderer.set_uniform_4x4f(m_u_MVP, mvp);
-				renderer.set_vertex_array(m_vertex_array);
+			m_vertex_array.set_array_buffer(m_in_Color, m_instance_color, 1);
+			m_vertex_array.set_array_buffer(m_in_Position, m_instance_position, 1);
+			m_vertex_array.set_array_buffer(m_in_Direction, m_instance_direction, 1);
+			m_vertex_array.set_array_buffer(m_in_BeamLength, m_instance_beam_length, 1);
 
-				renderer.draw_arrays(GL_POINTS, 1, instance_count);
+			// render beams
+			auto mvp = matrices.model_view_projection_matrix(glm::mat4(1.f));
+			
+			renderer.set_depth_write(gl::renderer::depth_write::DISABLED);
 
-				renderer.clear_vertex_array();
-				renderer.clear_program();
+			renderer.set_program(m_shader);
+			renderer.set_uniform_4x4f(m_u_MVP, mvp);
+			renderer.set_vertex_array(m_vertex_array);
 
-				renderer.set_depth_write(gl::renderer::depth_write::ENABLED);
+			renderer.draw_arrays(GL_POINTS, 1, instance_count);
 
-				// clear frame instance buffers
-				m_frame_instance_colors.clear();
-				m_frame_instance_positions.clear();
-				m_frame_instance_directions.clear();
-				m_frame_instance_beam_lengths.clear();
-			}
+			renderer.clear_vertex_array();
+			renderer.clear_program();
 
-			m_low_damage_hit_effects.render(renderer, light_matrices, matrices, shadow_map);
-			m_medium_damage_hit_effects.render(renderer, light_matrices, matrices, shadow_map);
-			m_high_damage_hit_effects.render(renderer, light_matrices, matrices, shadow_map);
+			renderer.set_depth_write(gl::renderer::depth_write::ENABLED);
 		}
 
-		player_weapons::player_weapons(entt::registry& registry, gl::shader_program const& laser_shader, gl::shader_program const& laser_hit_shader):
-			m_lasers(registry, laser_shader, laser_hit_shader)
+		player_weapons::player_weapons(entt::registry& registry, particle_system& particles, gl::shader_program const& laser_shader):
+			m_lasers(registry, particles, laser_shader)
 			{ }
 			
 		void player_weapons::update(bool fire, glm::mat4 const& player_transform, glm::vec3 player_velocity, high_res_duration_t dt)
@@ -582,9 +556,9 @@ namespace bump
 			m_lasers.update(fire, player_transform, player_velocity, dt);
 		}
 
-		void player_weapons::render(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map)
+		void player_weapons::render(gl::renderer& renderer, camera_matrices const& matrices)
 		{
-			m_lasers.render(renderer, light_matrices, matrices, shadow_map);
+			m_lasers.render(renderer, matrices);
 		}
 
 		
@@ -622,20 +596,21 @@ namespace bump
 		}
 
 
-		player::player(entt::registry& registry, assets& assets):
+		player::player(entt::registry& registry, entity_command_buffer& commands, particle_system& particles, assets& assets):
 			m_registry(registry),
+			m_commands(commands),
 			m_entity(entt::null),
 			m_ship_renderable(assets.m_shaders.at("player_ship_depth"), assets.m_shaders.at("player_ship"), assets.m_models.at("player_ship")),
 			m_shield_renderable_lower(assets.m_shaders.at("player_shield"), assets.m_models.at("player_shield_lower")),
 			m_shield_renderable_upper(assets.m_shaders.at("player_shield"), assets.m_models.at("player_shield_upper")),
 			m_controls(),
-			m_weapons(registry, assets.m_shaders.at("player_laser"), assets.m_shaders.at("particle_effect")),
-			m_left_engine_boost_effect(registry, assets.m_shaders.at("particle_effect")),
-			m_right_engine_boost_effect(registry, assets.m_shaders.at("particle_effect")),
+			m_weapons(registry, particles, assets.m_shaders.at("player_laser")),
+			m_left_engine_boost_effect(particles),
+			m_right_engine_boost_effect(particles),
 			m_engine_light_l(entt::null),
 			m_engine_light_r(entt::null),
-			m_shield_hit_effect(registry, assets.m_shaders.at("particle_effect")),
-			m_armor_hit_effect(registry, assets.m_shaders.at("particle_effect")),
+			m_shield_hit_effect(particles),
+			m_armor_hit_effect(particles),
 			m_rng(std::random_device()())
 		{
 			m_entity = registry.create();
@@ -669,18 +644,18 @@ namespace bump
 						auto const damage = glm::mix(0.f, max_damage, vf);
 
 						// do shield hit effect
-						if (m_health.has_shield())
-							m_frame_shield_hits.push_back({ hit.m_point, hit.m_normal });
-						else
-							m_frame_armor_hits.push_back({ hit.m_point, hit.m_normal });
+						auto& effect = m_health.has_shield() ? m_shield_hit_effect : m_armor_hit_effect;
+						auto const count = m_health.has_shield() ? std::size_t{ 75 } : std::size_t{ 25 };
+
+						effect.spawn_burst(hit.m_point, count);
 
 						m_health.take_damage(damage);
 
 						// player died, turn off collision
 						if (!m_health.is_alive())
 						{
-							m_frame_player_death = true;
 							m_registry.get<physics::collider>(m_entity).set_collision_mask(0);
+							m_commands.push([this] (entt::registry&) { spawn_fragments(); });
 						}
 					}
 					else if (m_registry.has<powerups::powerup_data>(other))
@@ -732,8 +707,8 @@ namespace bump
 				m_left_engine_boost_effect.set_max_lifetime(high_res_duration_from_seconds(0.75f));
 				m_left_engine_boost_effect.set_max_lifetime_random(high_res_duration_from_seconds(0.25f));
 				m_left_engine_boost_effect.set_spawn_period(high_res_duration_from_seconds(1.f / 500.f));
-				m_left_engine_boost_effect.set_color_update_fn(make_color_update_fn(m_left_engine_boost_effect, color_map));
-				m_left_engine_boost_effect.set_size_update_fn(make_size_update_fn(m_left_engine_boost_effect, size_map));
+				m_left_engine_boost_effect.set_color_curve(color_map);
+				m_left_engine_boost_effect.set_size_curve(size_map);
 				m_left_engine_boost_effect.set_collision_mask(physics::collision_layers::ASTEROIDS | physics::collision_layers::POWERUPS); // not player!
 
 				auto const r_pos = glm::vec3{ 0.8f, 0.1f, 2.2f };
@@ -746,8 +721,8 @@ namespace bump
 				m_right_engine_boost_effect.set_max_lifetime(high_res_duration_from_seconds(0.75f));
 				m_right_engine_boost_effect.set_max_lifetime_random(high_res_duration_from_seconds(0.25f));
 				m_right_engine_boost_effect.set_spawn_period(high_res_duration_from_seconds(1.f / 500.f));
-				m_right_engine_boost_effect.set_color_update_fn(make_color_update_fn(m_right_engine_boost_effect, color_map));
-				m_right_engine_boost_effect.set_size_update_fn(make_size_update_fn(m_right_engine_boost_effect, size_map));
+				m_right_engine_boost_effect.set_color_curve(color_map);
+				m_right_engine_boost_effect.set_size_curve(size_map);
 				m_right_engine_boost_effect.set_collision_mask(physics::collision_layers::ASTEROIDS | physics::collision_layers::POWERUPS); // not player!
 			}
 
@@ -785,11 +760,12 @@ namespace bump
 				};
 
 				m_shield_hit_effect.set_spawn_radius(0.1f);
+				m_shield_hit_effect.set_burst_merge_radius(1.f);
 				m_shield_hit_effect.set_random_velocity({ 10.f, 10.f, 10.f });
 				m_shield_hit_effect.set_max_lifetime(high_res_duration_from_seconds(1.0f));
 				m_shield_hit_effect.set_max_lifetime_random(high_res_duration_from_seconds(0.25f));
-				m_shield_hit_effect.set_color_update_fn(make_color_update_fn(m_shield_hit_effect, shield_color_map));
-				m_shield_hit_effect.set_size_update_fn(make_size_update_fn(m_shield_hit_effect, shield_size_map));
+				m_shield_hit_effect.set_color_curve(shield_color_map);
+				m_shield_hit_effect.set_size_curve(shield_size_map);
 
 				auto const armor_color_map = std::map<float, glm::vec4>
 				{
@@ -799,10 +775,11 @@ namespace bump
 				};
 				
 				m_armor_hit_effect.set_spawn_radius(0.1f);
+				m_armor_hit_effect.set_burst_merge_radius(1.f);
 				m_armor_hit_effect.set_random_velocity({ 5.f, 5.f, 5.f });
 				m_armor_hit_effect.set_max_lifetime(high_res_duration_from_seconds(5.0f));
 				m_armor_hit_effect.set_max_lifetime_random(high_res_duration_from_seconds(1.0f));
-				m_armor_hit_effect.set_color_update_fn(make_color_update_fn(m_armor_hit_effect, armor_color_map));
+				m_armor_hit_effect.set_color_curve(armor_color_map);
 			}
 
 			// setup fragment models
@@ -856,28 +833,6 @@ namespace bump
 				m_right_engine_boost_effect.set_origin(r_mat);
 				m_right_engine_boost_effect.update(dt);
 
-				for (auto const& hit : m_frame_shield_hits)
-				{
-					auto m = glm::mat4(1.f);
-					set_position(m, std::get<0>(hit));
-
-					m_shield_hit_effect.set_origin(m);
-					//m_shield_hit_effect.set_base_velocity(std::get<1>(hit));
-					m_shield_hit_effect.spawn_once(75);
-				}
-				m_frame_shield_hits.clear();
-
-				for (auto const& hit : m_frame_armor_hits)
-				{
-					auto m = glm::mat4(1.f);
-					set_position(m, std::get<0>(hit));
-
-					m_armor_hit_effect.set_origin(m);
-					//m_armor_hit_effect.set_base_velocity(std::get<1>(hit));
-					m_armor_hit_effect.spawn_once(25);
-				}
-				m_frame_armor_hits.clear();
-
 				m_shield_hit_effect.update(dt);
 				m_armor_hit_effect.update(dt);
 			}
@@ -906,107 +861,91 @@ namespace bump
 			// update fragments
 			if (!m_health.is_alive())
 			{
-				if (m_frame_player_death)
+				auto view = m_registry.view<player_fragment_data, physics::rigidbody>();
+
+				for (auto id : view)
 				{
-					m_frame_player_death = false;
+					auto [d, rb] = view.get<player_fragment_data, physics::rigidbody>(id);
 
-					// spawn fragments:
-					for (auto i = std::size_t{ 0 }; i != m_fragment_renderables.size(); ++i)
-					{
-						auto id = m_registry.create();
+					m_fragment_renderables[d.m_model_index].set_transform(rb.get_transform());
+				}
+			}
+		}
 
-						auto& data = m_registry.emplace<player_fragment_data>(id);
-						data.m_model_index = i;
+		void player::spawn_fragments()
+		{
+			auto const player_transform = m_registry.get<physics::rigidbody>(m_entity).get_transform();
 
-						auto const mass = random::scale(m_rng, 10.f, 5.f);
-						auto const size = glm::vec3(random::scale(m_rng, 3.f, 1.5f), random::scale(m_rng, 3.f, 1.5f), random::scale(m_rng, 3.f, 1.5f));
+			for (auto i = std::size_t{ 0 }; i != m_fragment_renderables.size(); ++i)
+			{
+				auto id = m_registry.create();
 
-						auto const transform = player_transform * m_fragment_renderables[i].get_transform();
-						auto const position = get_position(transform);
-						auto const orientation = glm::quat_cast(glm::mat3(transform));
+				auto& data = m_registry.emplace<player_fragment_data>(id);
+				data.m_model_index = i;
 
-						auto const vel_direction = glm::normalize(position);
-						auto const vel_magnitude = random::scale(m_rng, 15.f, 5.f);
-						auto const vel_random = random::point_in_ring_3d(m_rng, 0.f, 5.f);
-						auto const velocity = vel_direction * vel_magnitude + vel_random;
+				auto const mass = random::scale(m_rng, 10.f, 5.f);
+				auto const size = glm::vec3(random::scale(m_rng, 3.f, 1.5f), random::scale(m_rng, 3.f, 1.5f), random::scale(m_rng, 3.f, 1.5f));
 
-						auto const ang_axis = random::point_in_ring_3d(m_rng, 0.f, 1.f);
-						auto const ang_magnitude = random::scale(m_rng, 2.5f, 1.f);
-						auto const ang_velocity = ang_axis * ang_magnitude;
+				auto const transform = player_transform * m_fragment_renderables[i].get_transform();
+				auto const position = get_position(transform);
+				auto const orientation = glm::quat_cast(glm::mat3(transform));
 
-						auto& rb = m_registry.emplace<physics::rigidbody>(id);
-						rb.set_mass(mass);
-						rb.set_local_inertia_tensor(physics::make_cuboid_inertia_tensor(mass, size));
-						rb.set_position(position);
-						rb.set_orientation(orientation);
-						rb.set_velocity(velocity);
-						rb.set_angular_velocity(ang_velocity);
+				auto const vel_direction = glm::normalize(position);
+				auto const vel_magnitude = random::scale(m_rng, 15.f, 5.f);
+				auto const vel_random = random::point_in_ring_3d(m_rng, 0.f, 5.f);
+				auto const velocity = vel_direction * vel_magnitude + vel_random;
 
-						m_fragment_entities.push_back(id);
-					}
-				}
+				auto const ang_axis = random::point_in_ring_3d(m_rng, 0.f, 1.f);
+				auto const ang_magnitude = random::scale(m_rng, 2.5f, 1.f);
+				auto const ang_velocity = ang_axis * ang_magnitude;
 
-				// update fragments:
-				auto view = m_registry.view<player_fragment_data, physics::rigidbody>();
+				auto& rb = m_registry.emplace<physics::rigidbody>(id);
+				rb.set_mass(mass);
+				rb.set_local_inertia_tensor(physics::make_cuboid_inertia_tensor(mass, size));
+				rb.set_position(position);
+				rb.set_orientation(orientation);
+				rb.set_velocity(velocity);
+				rb.set_angular_velocity(ang_velocity);
 
-				for (auto id : view)
-				{
-					auto [d, rb] = view.get<player_fragment_data, physics::rigidbody>(id);
-
-					m_fragment_renderables[d.m_model_index].set_transform(rb.get_transform());
-				}
+				m_fragment_entities.push_back(id);
 			}
 		}
 
-		void player::render_depth(gl::renderer& renderer, camera_matrices const& matrices)
+		void player::render_depth(gl::render_queue& queue, camera_matrices const& matrices)
 		{
 			ZoneScopedN("player::render_depth()");
 
 			if (m_health.is_alive())
 			{
-				m_ship_renderable.render_depth(renderer, matrices);
+				m_ship_renderable.render_depth(queue, matrices);
 			}
 			else
 			{
 				for (auto& f : m_fragment_renderables)
-					f.render_depth(renderer, matrices);
+					f.render_depth(queue, matrices);
 			}
 		}
 
-		void player::render_scene(gl::renderer& renderer, camera_matrices const& matrices)
+		void player::render_scene(gl::render_queue& queue, camera_matrices const& matrices)
 		{
 			ZoneScopedN("player::render_scene()");
 
 			if (m_health.is_alive())
 			{
-				m_ship_renderable.render(renderer, matrices);
+				m_ship_renderable.render(queue, matrices);
 			}
 			else
 			{
 				for (auto& f : m_fragment_renderables)
-					f.render(renderer, matrices);
+					f.render(queue, matrices);
 			}
 		}
 
-		void player::render_particles(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map)
+		void player::render_particles(gl::renderer& renderer, camera_matrices const& matrices)
 		{
 			ZoneScopedN("player::render_particles()");
 
-			m_weapons.render(renderer, light_matrices, matrices, shadow_map);
-
-			{
-				ZoneScopedN("player::render_particles() - engine boost effects");
-
-				m_left_engine_boost_effect.render(renderer, light_matrices, matrices, shadow_map);
-				m_right_engine_boost_effect.render(renderer, light_matrices, matrices, shadow_map);
-			}
-
-			{
-				ZoneScopedN("player::render_particles() - shield / armor effects");
-				
-				m_shield_hit_effect.render(renderer, light_matrices, matrices, shadow_map);
-				m_armor_hit_effect.render(renderer, light_matrices, matrices, shadow_map);
-			}
+			m_weapons.render(renderer, matrices);
 		}
 
 		void player::render_transparent(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map)
@@ -1040,7 +979,7 @@ namespace bump
 
 				// get brightest point lights:
 				{
-					auto view = m_registry.view<lighting::point_light>();
+					auto view = m_registry.view<lighting::point_light>(entt::exclude<inactive_tag>);
 					
 					struct id_brightness
 					{
@@ -1048,8 +987,9 @@ namespace bump
 						float m_brightness;
 					};
 
-					auto ranking = std::vector<id_brightness>();
-					ranking.reserve(view.size());
+					// keep the "brightest" 5 (or so) lights as we go (sorted brightest first)
+					auto ranking = std::array<id_brightness, 5>();
+					auto num = std::size_t{ 0 };
 
 					auto const player_position = m_registry.get<physics::rigidbody>(m_entity).get_position();
 
@@ -1061,22 +1001,25 @@ namespace bump
 						auto const intensity = glm::length(l.m_color);
 						auto const brightness = glm::clamp(1.f / (distance * distance), 0.f, 1.f) * intensity;
 						// todo: don't clamp brightness??
-						ranking.push_back({ id, brightness });
-					}
 
-					// find the "brightest" 5 (or so) lights
-					auto const num = std::min(ranking.size(), std::size_t{ 5 });
-					std::partial_sort(ranking.begin(), ranking.begin() + num, ranking.end(),
-						[] (id_brightness const& a, id_brightness const& b) { return a.m_brightness > b.m_brightness; });
-					
-					ranking.resize(num);
+						if (num == ranking.size() && brightness <= ranking.back().m_brightness)
+							continue;
+
+						// insert, dropping the dimmest if we're full
+						auto i = std::min(num, ranking.size() - 1);
+						for (; i != 0 && ranking[i - 1].m_brightness < brightness; --i)
+							ranking[i] = ranking[i - 1];
+
+						ranking[i] = { id, brightness };
+						num = std::min(num + 1, ranking.size());
+					}
 
 					// copy those lights to a vector and pass to the renderables!
 					auto lights = std::vector<lighting::point_light>();
 					lights.reserve(num);
 
-					for (auto const& b : ranking)
-						lights.push_back(view.get<lighting::point_light>(b.m_id));
+					for (auto i = std::size_t{ 0 }; i != num; ++i)
+						lights.push_back(view.get<lighting::point_light>(ranking[i].m_id));
 					
 					m_shield_renderable_lower.set_point_lights(lights);
 					m_shield_renderable_upper.set_point_lights(lights);
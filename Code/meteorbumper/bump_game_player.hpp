@@ -1,6 +1,8 @@
 #pragma once
 
 #include "bump_camera.hpp"
+#include "bump_entity_command_buffer.hpp"
+#include "bump_entity_pool.hpp"
 #include "bump_game_basic_renderable.hpp"
 #include "bump_game_basic_renderable_alpha.hpp"
 #include "bump_game_particle_effect.hpp"
@@ -13,7 +15,6 @@
 #include <glm/ext.hpp>
 #include <glm/glm.hpp>
 
-#include <tuple>
 #include <vector>
 
 namespace bump
@@ -52,7 +53,7 @@ namespace bump
 		{
 		public:
 
-			explicit player_lasers(entt::registry& registry, gl::shader_program const& shader, gl::shader_program const& hit_shader);
+			explicit player_lasers(entt::registry& registry, particle_system& particles, gl::shader_program const& shader);
 
 			player_lasers(player_lasers const&) = delete;
 			player_lasers& operator=(player_lasers const&) = delete;
@@ -62,9 +63,11 @@ namespace bump
 			~player_lasers();
 
 			void upgrade();
+
+			entity_pool::churn_stats const& get_beam_pool_stats() const { return m_beam_pool.get_stats(); }
 			
 			void update(bool fire, glm::mat4 const& player_transform, glm::vec3 player_velocity, high_res_duration_t dt);
-			void render(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map);
+			void render(gl::renderer& renderer, camera_matrices const& matrices);
 
 			struct beam_segment
 			{
@@ -77,6 +80,7 @@ namespace bump
 		private:
 
 			entt::registry& m_registry;
+			entity_pool m_beam_pool;
 			gl::shader_program const& m_shader;
 			GLint m_in_Color;
 			GLint m_in_Position;
@@ -85,17 +89,12 @@ namespace bump
 			GLint m_u_MVP;
 
 			gl::buffer m_vertices;
-			gl::buffer m_instance_color;
-			gl::buffer m_instance_position;
-			gl::buffer m_instance_direction;
-			gl::buffer m_instance_beam_length;
+			gl::stream_buffer m_instance_color;
+			gl::stream_buffer m_instance_position;
+			gl::stream_buffer m_instance_direction;
+			gl::stream_buffer m_instance_beam_length;
 			gl::vertex_array m_vertex_array;
 
-			std::vector<glm::vec3> m_frame_instance_colors;
-			std::vector<glm::vec3> m_frame_instance_positions;
-			std::vector<glm::vec3> m_frame_instance_directions;
-			std::vector<float> m_frame_instance_beam_lengths;
-
 			struct emitter
 			{
 				float m_damage;
@@ -118,20 +117,16 @@ namespace bump
 			particle_effect m_low_damage_hit_effects;
 			particle_effect m_medium_damage_hit_effects;
 			particle_effect m_high_damage_hit_effects;
-
-			std::vector<glm::vec3> m_low_damage_frame_hit_positions;
-			std::vector<glm::vec3> m_medium_damage_frame_hit_positions;
-			std::vector<glm::vec3> m_high_damage_frame_hit_positions;
 		};
 
 		class player_weapons
 		{
 		public:
 
-			explicit player_weapons(entt::registry& registry, gl::shader_program const& laser_shader, gl::shader_program const& laser_hit_shader);
+			explicit player_weapons(entt::registry& registry, particle_system& particles, gl::shader_program const& laser_shader);
 
 			void update(bool fire, glm::mat4 const& player_transform, glm::vec3 player_velocity, high_res_duration_t dt);
-			void render(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map);
+			void render(gl::renderer& renderer, camera_matrices const& matrices);
 
 			player_lasers m_lasers;
 		};
@@ -174,16 +169,19 @@ namespace bump
 		{
 		public:
 
-			explicit player(entt::registry& registry, assets& assets);
+			explicit player(entt::registry& registry, entity_command_buffer& commands, particle_system& particles, assets& assets);
 			~player();
 			
 			void update(high_res_duration_t dt);
-			void render_depth(gl::renderer& renderer, camera_matrices const& matrices);
-			void render_scene(gl::renderer& renderer, camera_matrices const& matrices);
-			void render_particles(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map);
+			void render_depth(gl::render_queue& queue, camera_matrices const& matrices);
+			void render_scene(gl::render_queue& queue, camera_matrices const& matrices);
+			void render_particles(gl::renderer& renderer, camera_matrices const& matrices);
 			void render_transparent(gl::renderer& renderer, camera_matrices const& light_matrices, camera_matrices const& matrices, gl::texture_2d const& shadow_map);
 
+			void spawn_fragments();
+
 			entt::registry& m_registry;
+			entity_command_buffer& m_commands;
 
 			entt::entity m_entity;
 			basic_renderable m_ship_renderable;
@@ -199,10 +197,7 @@ namespace bump
 			entt::entity m_engine_light_r;
 
 			particle_effect m_shield_hit_effect;
-			std::vector<std::tuple<glm::vec3, glm::vec3>> m_frame_shield_hits;
-
 			particle_effect m_armor_hit_effect;
-			std::vector<std::tuple<glm::vec3, glm::vec3>> m_frame_armor_hits;
 
 			float m_player_shield_restitution = 0.8f;
 			float m_player_armor_restitution = 0.25f;
@@ -214,7 +209,6 @@ namespace bump
 				std::size_t m_model_index = 0;
 			};
 
-			bool m_frame_player_death = false;
 			std::vector<basic_renderable> m_fragment_renderables;
 			std::vector<entt::entity> m_fragment_entities;
 
@@ -1,6 +1,7 @@
 #include "bump_game_powerups.hpp"
 
 #include "bump_camera.hpp"
+#include "bump_frustum.hpp"
 #include "bump_game_player.hpp"
 #include "bump_lighting.hpp"
 #include "bump_log.hpp"
@@ -40,7 +41,15 @@ namespace bump
 			m_light_colors{ 
 				{ powerup_type::RESET_SHIELDS, shield_color }, 
 				{ powerup_type::RESET_ARMOR, armor_color }, 
-				{ powerup_type::UPGRADE_LASERS, laser_color } }
+				{ powerup_type::UPGRADE_LASERS, laser_color } },
+			m_bounding_radii{
+				{ powerup_type::RESET_SHIELDS, get_bounding_radius(shield_model) },
+				{ powerup_type::RESET_ARMOR, get_bounding_radius(armor_model) },
+				{ powerup_type::UPGRADE_LASERS, get_bounding_radius(lasers_model) } },
+			m_frame_transforms{
+				{ powerup_type::RESET_SHIELDS, { } },
+				{ powerup_type::RESET_ARMOR, { } },
+				{ powerup_type::UPGRADE_LASERS, { } } }
 		{
 			
 		}
@@ -114,59 +123,44 @@ namespace bump
 			m_entities.erase(first_dead_entity, m_entities.end());
 		}
 
-		void powerups::render_depth(gl::renderer& renderer, camera_matrices const& matrices)
+		void powerups::render_depth(gl::render_queue& queue, camera_matrices const& matrices)
 		{
 			ZoneScopedN("powerups::render_depth()");
 
-			auto view = m_registry.view<powerup_data, physics::rigidbody>();
-
-			for (auto id : view)
-			{
-				auto [data, rb] = view.get<powerup_data, physics::rigidbody>(id);
+			update_frame_transforms(matrices);
 
-				if (data.m_type == powerup_type::RESET_SHIELDS)
-				{
-					m_shield_renderable.set_transform(rb.get_transform());
-					m_shield_renderable.render_depth(renderer, matrices);
-				}
-				else if (data.m_type == powerup_type::RESET_ARMOR)
-				{
-					m_armor_renderable.set_transform(rb.get_transform());
-					m_armor_renderable.render_depth(renderer, matrices);
-				}
-				else if (data.m_type == powerup_type::UPGRADE_LASERS)
-				{
-					m_lasers_renderable.set_transform(rb.get_transform());
-					m_lasers_renderable.render_depth(renderer, matrices);
-				}
-			}
+			m_shield_renderable.render_depth(queue, matrices, m_frame_transforms.at(powerup_type::RESET_SHIELDS));
+			m_armor_renderable.render_depth(queue, matrices, m_frame_transforms.at(powerup_type::RESET_ARMOR));
+			m_lasers_renderable.render_depth(queue, matrices, m_frame_transforms.at(powerup_type::UPGRADE_LASERS));
 		}
 
-		void powerups::render_scene(gl::renderer& renderer, camera_matrices const& matrices)
+		void powerups::render_scene(gl::render_queue& queue, camera_matrices const& matrices)
 		{
 			ZoneScopedN("powerups::render_scene()");
 
+			update_frame_transforms(matrices);
+
+			m_shield_renderable.render(queue, matrices, m_frame_transforms.at(powerup_type::RESET_SHIELDS));
+			m_armor_renderable.render(queue, matrices, m_frame_transforms.at(powerup_type::RESET_ARMOR));
+			m_lasers_renderable.render(queue, matrices, m_frame_transforms.at(powerup_type::UPGRADE_LASERS));
+		}
+
+		void powerups::update_frame_transforms(camera_matrices const& matrices)
+		{
+			for (auto& t : m_frame_transforms)
+				t.second.clear();
+
 			auto view = m_registry.view<powerup_data, physics::rigidbody>();
+			auto const view_frustum = frustum(matrices.m_view_projection);
 
 			for (auto id : view)
 			{
 				auto [data, rb] = view.get<powerup_data, physics::rigidbody>(id);
 
-				if (data.m_type == powerup_type::RESET_SHIELDS)
-				{
-					m_shield_renderable.set_transform(rb.get_transform());
-					m_shield_renderable.render(renderer, matrices);
-				}
-				else if (data.m_type == powerup_type::RESET_ARMOR)
-				{
-					m_armor_renderable.set_transform(rb.get_transform());
-					m_armor_renderable.render(renderer, matrices);
-				}
-				else if (data.m_type == powerup_type::UPGRADE_LASERS)
-				{
-					m_lasers_renderable.set_transform(rb.get_transform());
-					m_lasers_renderable.render(renderer, matrices);
-				}
+				if (!view_frustum.is_sphere_visible(rb.get_position(), m_bounding_radii.at(data.m_type)))
+					continue;
+
+				m_frame_transforms.at(data.m_type).push_back(rb.get_transform());
 			}
 		}
 		
@@ -8,6 +8,7 @@
 #include <glm/glm.hpp>
 
 #include <map>
+#include <vector>
 
 namespace bump
 {
@@ -37,8 +38,8 @@ namespace bump
 			void spawn(glm::vec3 position, powerup_type type);
 
 			void update(high_res_duration_t dt);
-			void render_depth(gl::renderer& renderer, camera_matrices const& matrices);
-			void render_scene(gl::renderer& renderer, camera_matrices const& matrices);
+			void render_depth(gl::render_queue& queue, camera_matrices const& matrices);
+			void render_scene(gl::render_queue& queue, camera_matrices const& matrices);
 			
 			struct powerup_data
 			{
@@ -51,14 +52,20 @@ namespace bump
 
 			entt::registry& m_registry;
 
-			basic_renderable m_shield_renderable;
-			basic_renderable m_armor_renderable;
-			basic_renderable m_lasers_renderable;
+			// one instanced draw per powerup type (per pass)
+			basic_renderable_instanced m_shield_renderable;
+			basic_renderable_instanced m_armor_renderable;
+			basic_renderable_instanced m_lasers_renderable;
 
 			high_res_duration_t m_max_lifetime;
 			std::vector<entt::entity> m_entities;
 
 			std::map<powerup_type, glm::vec3> m_light_colors;
+			std::map<powerup_type, float> m_bounding_radii; // for frustum culling
+
+			void update_frame_transforms(camera_matrices const& matrices); // visible powerup transforms, by type
+
+			std::map<powerup_type, std::vector<glm::mat4>> m_frame_transforms;
 		};
 		
 	} // game
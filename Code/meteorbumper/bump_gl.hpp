@@ -8,7 +8,10 @@
 #include "bump_gl_framebuffer.hpp"
 #include "bump_gl_renderbuffer.hpp"
 #include "bump_gl_shader.hpp"
+#include "bump_gl_program_cache.hpp"
+#include "bump_gl_stream_buffer.hpp"
 #include "bump_gl_texture.hpp"
 #include "bump_gl_vertex_array.hpp"
 
 #include "bump_gl_renderer.hpp"
+#include "bump_gl_render_queue.hpp"
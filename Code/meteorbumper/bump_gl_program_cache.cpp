@@ -0,0 +1,158 @@
+#include "bump_gl_program_cache.hpp"
+
+#include "bump_log.hpp"
+#include "bump_narrow_cast.hpp"
+
+#include <fstream>
+
+namespace bump
+{
+	
+	namespace gl
+	{
+
+		namespace
+		{
+
+			auto const file_magic = std::uint32_t{ 0x6370626d }; // "mbpc"
+			auto const file_version = std::uint32_t{ 1 };
+
+			template<class T>
+			bool read_value(std::istream& file, T& value)
+			{
+				return !!file.read(reinterpret_cast<char*>(&value), sizeof(T));
+			}
+
+			template<class T>
+			void write_value(std::ostream& file, T const& value)
+			{
+				file.write(reinterpret_cast<char const*>(&value), sizeof(T));
+			}
+
+		} // unnamed
+
+		program_cache::program_cache(std::string filename):
+			m_filename(std::move(filename)),
+			m_modified(false)
+		{
+			load();
+		}
+
+		program_binary const* program_cache::find(std::string const& name, std::uint64_t key)
+		{
+			auto const e = m_entries.find(name);
+
+			if (e == m_entries.end() || e->second.m_key != key)
+				return nullptr;
+
+			e->second.m_used = true;
+
+			return &e->second.m_binary;
+		}
+
+		void program_cache::insert(std::string const& name, std::uint64_t key, program_binary binary)
+		{
+			m_entries[name] = entry{ key, std::move(binary), true };
+			m_modified = true;
+		}
+
+		bool program_cache::save()
+		{
+			// otherwise the file only ever grows (stale keys are replaced by insert(), but renamed or removed shaders aren't)
+			for (auto e = m_entries.begin(); e != m_entries.end(); )
+			{
+				if (e->second.m_used)
+				{
+					++e;
+					continue;
+				}
+
+				e = m_entries.erase(e);
+				m_modified = true;
+			}
+
+			if (!m_modified)
+				return true;
+
+			auto file = std::ofstream(m_filename, std::ios::binary | std::ios::trunc); // todo: widen filename for windows!
+
+			if (!file)
+			{
+				log_error("program_cache::save(): failed to open file: " + m_filename);
+				return false;
+			}
+
+			write_value(file, file_magic);
+			write_value(file, file_version);
+			write_value(file, narrow_cast<std::uint32_t>(m_entries.size()));
+
+			for (auto const& [name, e] : m_entries)
+			{
+				write_value(file, narrow_cast<std::uint32_t>(name.size()));
+				file.write(name.data(), name.size());
+
+				write_value(file, e.m_key);
+				write_value(file, std::uint32_t{ e.m_binary.m_format });
+				write_value(file, narrow_cast<std::uint32_t>(e.m_binary.m_data.size()));
+				file.write(reinterpret_cast<char const*>(e.m_binary.m_data.data()), e.m_binary.m_data.size());
+			}
+
+			if (!file)
+			{
+				log_error("program_cache::save(): failed to write file: " + m_filename);
+				return false;
+			}
+
+			m_modified = false;
+			return true;
+		}
+
+		void program_cache::load()
+		{
+			auto file = std::ifstream(m_filename, std::ios::binary); // todo: widen filename for windows!
+
+			if (!file)
+				return; // not created yet
+
+			file.seekg(0, std::ios::end);
+			auto const file_size = static_cast<std::uint64_t>(file.tellg());
+			file.seekg(0, std::ios::beg);
+
+			// checks sizes read from the file before allocating anything (the file may be truncated or corrupt)
+			auto const fits = [&] (std::uint32_t size) { return static_cast<std::uint64_t>(file.tellg()) + size <= file_size; };
+
+			auto magic = std::uint32_t{ 0 };
+			auto version = std::uint32_t{ 0 };
+			auto count = std::uint32_t{ 0 };
+
+			if (!read_value(file, magic) || magic != file_magic || !read_value(file, version) || version != file_version || !read_value(file, count))
+				return;
+
+			auto entries = std::unordered_map<std::string, entry>();
+
+			for (auto i = std::uint32_t{ 0 }; i != count; ++i)
+			{
+				auto name_size = std::uint32_t{ 0 };
+				if (!read_value(file, name_size) || !fits(name_size)) return;
+
+				auto name = std::string(name_size, '\0');
+				if (!file.read(name.data(), name_size)) return;
+
+				auto e = entry{ };
+				auto format = std::uint32_t{ 0 };
+				auto data_size = std::uint32_t{ 0 };
+				if (!read_value(file, e.m_key) || !read_value(file, format) || !read_value(file, data_size) || !fits(data_size)) return;
+
+				e.m_binary.m_format = format;
+				e.m_binary.m_data.resize(data_size);
+				if (!file.read(reinterpret_cast<char*>(e.m_binary.m_data.data()), data_size)) return;
+
+				entries[name] = std::move(e);
+			}
+
+			m_entries = std::move(entries);
+		}
+		
+	} // gl
+	
+} // bump
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "bump_gl_shader.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace bump
+{
+	
+	namespace gl
+	{
+
+		// linked program binaries saved to a file, so programs don't have to be compiled every time the game starts.
+		// each binary is stored with a key (e.g. a hash of the shader sources and driver strings). a binary is
+		// only returned if the key matches, so changing the sources or updating the driver invalidates it.
+		//
+		// note: a missing or unreadable file just gives an empty cache.
+		class program_cache
+		{
+		public:
+
+			explicit program_cache(std::string filename);
+
+			program_cache(program_cache const&) = delete;
+			program_cache& operator=(program_cache const&) = delete;
+
+			// returns nullptr if there's no binary with the given name and key
+			program_binary const* find(std::string const& name, std::uint64_t key);
+
+			// replaces any existing binary with the same name
+			void insert(std::string const& name, std::uint64_t key, program_binary binary);
+
+			// drops binaries that weren't found or inserted since the file was loaded (e.g. for shaders that no longer exist),
+			// then writes the file, if anything changed. returns false on failure.
+			bool save();
+
+			std::size_t get_size() const { return m_entries.size(); }
+
+		private:
+
+			struct entry
+			{
+				std::uint64_t m_key;
+				program_binary m_binary;
+				bool m_used; // found or inserted this run
+			};
+
+			void load();
+
+			std::string m_filename;
+			std::unordered_map<std::string, entry> m_entries;
+			bool m_modified;
+		};
+		
+	} // gl
+	
+} // bump
\ No newline at end of file
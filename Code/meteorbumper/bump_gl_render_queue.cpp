@@ -0,0 +1,105 @@
+#include "bump_gl_render_queue.hpp"
+
+#include "bump_gl_shader.hpp"
+#include "bump_gl_vertex_array.hpp"
+
+#include <variant>
+
+namespace bump
+{
+	
+	namespace gl
+	{
+
+		namespace
+		{
+
+			struct set_uniform_visitor
+			{
+				renderer& m_renderer;
+				GLint m_location;
+
+				void operator()(std::int32_t value) const { m_renderer.set_uniform_1i(m_location, value); }
+				void operator()(std::uint32_t value) const { m_renderer.set_uniform_1u(m_location, value); }
+				void operator()(float value) const { m_renderer.set_uniform_1f(m_location, value); }
+				void operator()(glm::vec2 value) const { m_renderer.set_uniform_2f(m_location, value); }
+				void operator()(glm::vec3 value) const { m_renderer.set_uniform_3f(m_location, value); }
+				void operator()(glm::vec4 value) const { m_renderer.set_uniform_4f(m_location, value); }
+				void operator()(glm::mat3 const& value) const { m_renderer.set_uniform_3x3f(m_location, value); }
+				void operator()(glm::mat4 const& value) const { m_renderer.set_uniform_4x4f(m_location, value); }
+			};
+
+		} // unnamed
+
+		renderer_backend::renderer_backend(renderer& renderer):
+			m_renderer(renderer),
+			m_last_vertex_array(nullptr),
+			m_instances(64 * 1024),
+			m_commands(1024) { }
+
+		void renderer_backend::draw(render_queue const& queue, render_queue::draw_packet const& packet)
+		{
+			m_renderer.set_blending(packet.m_state.m_blending);
+			m_renderer.set_depth_test(packet.m_state.m_depth_test);
+			m_renderer.set_depth_write(packet.m_state.m_depth_write);
+			m_renderer.set_face_culling(packet.m_state.m_face_culling);
+
+			m_renderer.set_program(*packet.m_program);
+
+			for (auto const& u : queue.get_uniforms(packet))
+				std::visit(set_uniform_visitor{ m_renderer, u.m_location }, u.m_value);
+
+			auto const instance_data = queue.get_instance_data(packet);
+
+			if (!instance_data.empty())
+			{
+				m_instances.set_data(instance_data.data(), packet.m_instance_size, instance_data.size() / packet.m_instance_size);
+
+				// re-pointing the vertex array unbinds it
+				for (auto const& a : queue.get_instance_attributes(packet))
+					packet.m_vertex_array->set_interleaved_array_buffer(a.m_location, m_instances, 0, a.m_offset_bytes, a.m_components, a.m_locations, 1);
+
+				m_last_vertex_array = nullptr;
+			}
+
+			if (packet.m_vertex_array != m_last_vertex_array)
+			{
+				m_renderer.set_vertex_array(*packet.m_vertex_array);
+				m_last_vertex_array = packet.m_vertex_array;
+			}
+
+			if (packet.m_indirect)
+			{
+				static_assert(sizeof(draw_indexed_indirect_command) == sizeof(GLuint) * 5, "Unexpected command size.");
+
+				auto const commands = queue.get_commands(packet);
+				m_commands.set_data(reinterpret_cast<GLuint const*>(commands.data()), 5, commands.size());
+
+				m_renderer.draw_indexed_indirect(packet.m_primitive_type, packet.m_index_type, m_commands.get_id(), m_commands.get_offset_bytes(), commands.size());
+			}
+			else if (packet.m_index_type != GL_NONE)
+			{
+				m_renderer.draw_indexed(packet.m_primitive_type, packet.m_element_count, packet.m_index_type, packet.m_instance_count, packet.m_first_index, packet.m_base_vertex);
+			}
+			else
+			{
+				m_renderer.draw_arrays(packet.m_primitive_type, packet.m_element_count, packet.m_instance_count);
+			}
+		}
+
+		void renderer_backend::finish()
+		{
+			m_renderer.clear_vertex_array();
+			m_last_vertex_array = nullptr;
+			m_renderer.clear_program();
+
+			auto const defaults = render_queue::render_state();
+			m_renderer.set_blending(defaults.m_blending);
+			m_renderer.set_depth_test(defaults.m_depth_test);
+			m_renderer.set_depth_write(defaults.m_depth_write);
+			m_renderer.set_face_culling(defaults.m_face_culling);
+		}
+		
+	} // gl
+	
+} // bump
\ No newline at end of file
@@ -0,0 +1,422 @@
+#pragma once
+
+#include "bump_die.hpp"
+#include "bump_gl_renderer.hpp"
+#include "bump_gl_stream_buffer.hpp"
+#include "bump_narrow_cast.hpp"
+#include "bump_span.hpp"
+
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include <Tracy.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+namespace bump
+{
+
+	namespace gl
+	{
+
+		class shader_program;
+		class vertex_array;
+
+		// draw calls recorded during the frame, then sorted by key and executed together.
+		// recording doesn't call GL: uniforms, instance data and indirect commands are copied into the queue, and
+		// the backend uploads them when each packet is drawn. the program and vertex array are only used by the backend
+		// (so the queue can be tested with any types for them, see recording_backend).
+		template<class ProgramT, class VertexArrayT>
+		class basic_render_queue
+		{
+		public:
+
+			using program_type = ProgramT;
+			using vertex_array_type = VertexArrayT;
+
+			struct render_state
+			{
+				renderer::blending m_blending = renderer::blending::NONE;
+				renderer::depth_test m_depth_test = renderer::depth_test::LESS;
+				renderer::depth_write m_depth_write = renderer::depth_write::ENABLED;
+				renderer::face_culling m_face_culling = renderer::face_culling::CLOCKWISE;
+			};
+
+			using uniform_value = std::variant<std::int32_t, std::uint32_t, float, glm::vec2, glm::vec3, glm::vec4, glm::mat3, glm::mat4>;
+
+			struct uniform
+			{
+				GLint m_location;
+				uniform_value m_value;
+			};
+
+			// an attribute read from each instance in a packet's instance data
+			struct instance_attribute
+			{
+				GLuint m_location;
+				std::size_t m_offset_bytes; // in each instance
+				GLint m_components; // floats per location
+				GLint m_locations; // e.g. 4 for a mat4
+			};
+
+			struct draw_packet
+			{
+				std::uint64_t m_sort_key;
+				render_state m_state;
+				program_type const* m_program;
+				vertex_array_type* m_vertex_array; // the backend points it at the packet's instance data
+
+				GLenum m_primitive_type;
+				std::size_t m_element_count; // index count for indexed draws, command count for indirect draws, vertex count otherwise
+				GLenum m_index_type; // GL_NONE for non-indexed draws
+				std::size_t m_instance_count;
+				std::size_t m_first_index; // indexed draws only
+				GLint m_base_vertex;
+
+				bool m_indirect;
+				std::size_t m_first_command; // range in the queue's command list (indirect draws only)
+
+				// set by submit():
+				std::size_t m_first_uniform = 0; // range in the queue's uniform list
+				std::size_t m_uniform_count = 0;
+
+				std::size_t m_first_instance_data = 0; // range in the queue's instance data (in floats)
+				std::size_t m_instance_data_size = 0;
+				std::size_t m_instance_size = 0; // floats per instance
+
+				std::size_t m_first_attribute = 0; // range in the queue's instance attribute list
+				std::size_t m_attribute_count = 0;
+			};
+
+			basic_render_queue();
+
+			// sort key layout (most significant bits first): pass (8 bits), program (16 bits), vertex array (16 bits), order (24 bits).
+			// the program and vertex array ids just have to tell them apart (e.g. the gl object names). only the low 16 bits are used.
+			// order is for anything else the pass wants sorted by (e.g. depth). packets with the same key are drawn in submission order.
+			static std::uint64_t make_sort_key(std::uint32_t program_id, std::uint32_t vertex_array_id, std::uint32_t order = 0, std::uint8_t pass = 0);
+
+			// the render state is used by all packets submitted after it's set (until it's set again)
+			void set_state(render_state const& state) { m_state = state; }
+			render_state const& get_state() const { return m_state; }
+
+			// uniforms are added first, and belong to the next packet submitted
+			void add_uniform(GLint location, uniform_value const& value);
+
+			// instance data is also added first, and belongs to the next packet submitted. the backend uploads it just before
+			// the packet is drawn, and points the packet's vertex array at it (one attribute per add_instance_attribute() call).
+			// InstanceT must be made of floats (e.g. a struct of glm vectors and matrices).
+			// note: returns space in the queue for the instances, which is only valid until the queue is next changed.
+			template<class InstanceT>
+			span<InstanceT> add_instances(std::size_t instance_count);
+			void add_instance_attribute(GLuint location, std::size_t offset_bytes, GLint components, GLint locations);
+
+			void submit_indexed(std::uint64_t sort_key, program_type const& program, vertex_array_type& vertex_array, GLenum primitive_type, std::size_t index_count, GLenum index_type, std::size_t instance_count = 1, std::size_t first_index = 0, GLint base_vertex = 0);
+			void submit_arrays(std::uint64_t sort_key, program_type const& program, vertex_array_type& vertex_array, GLenum primitive_type, std::size_t vertex_count, std::size_t instance_count = 1);
+
+			// draws the commands (which are copied into the queue) with one multi-draw call.
+			// note: only use this if renderer::is_multi_draw_indirect_supported().
+			void submit_indexed_indirect(std::uint64_t sort_key, program_type const& program, vertex_array_type& vertex_array, GLenum primitive_type, GLenum index_type, span<draw_indexed_indirect_command const> commands);
+
+			void sort();
+
+			// calls backend.draw(queue, packet) for each packet (in sorted order, if sort() was called), then backend.finish()
+			template<class BackendT>
+			void execute(BackendT& backend) const;
+
+			void clear(); // also resets the render state
+
+			bool is_empty() const { return m_packets.empty(); }
+			std::size_t get_size() const { return m_packets.size(); }
+
+			// for backends:
+			span<uniform const> get_uniforms(draw_packet const& packet) const { return { m_uniforms.data() + packet.m_first_uniform, packet.m_uniform_count }; }
+			span<float const> get_instance_data(draw_packet const& packet) const { return { m_instance_data.data() + packet.m_first_instance_data, packet.m_instance_data_size }; }
+			span<instance_attribute const> get_instance_attributes(draw_packet const& packet) const { return { m_attributes.data() + packet.m_first_attribute, packet.m_attribute_count }; }
+			span<draw_indexed_indirect_command const> get_commands(draw_packet const& packet) const;
+
+		private:
+
+			void submit(draw_packet packet);
+
+			render_state m_state;
+			std::vector<draw_packet> m_packets;
+			std::vector<uniform> m_uniforms;
+			std::vector<float> m_instance_data;
+			std::vector<instance_attribute> m_attributes;
+			std::vector<draw_indexed_indirect_command> m_commands;
+
+			// the uniforms, instance data and attributes from these on belong to the next packet
+			std::size_t m_pending_uniforms;
+			std::size_t m_pending_instance_data;
+			std::size_t m_pending_attributes;
+			std::size_t m_pending_instance_size; // floats per instance (0 if there are no instances)
+
+			std::vector<std::uint32_t> m_order; // packet indices in draw order
+		};
+
+		using render_queue = basic_render_queue<shader_program, vertex_array>;
+
+		// executes packets with the renderer (state changes that don't change anything are skipped by the renderer).
+		// instance data and indirect commands are uploaded to the backend's stream buffers just before each packet is drawn,
+		// so keep one backend for the whole game loop.
+		// note: the renderer doesn't cache the vertex array binding, so the backend skips binding the same one twice in a row
+		// (unless it was just pointed at new instance data, which unbinds it).
+		class renderer_backend
+		{
+		public:
+
+			explicit renderer_backend(renderer& renderer);
+
+			void draw(render_queue const& queue, render_queue::draw_packet const& packet);
+			void finish(); // resets the state to the renderer defaults
+
+		private:
+
+			renderer& m_renderer;
+			vertex_array const* m_last_vertex_array;
+			stream_buffer m_instances;
+			stream_buffer m_commands;
+		};
+
+		// doesn't call GL. counts the work a queue would do, for testing or timing the frame build without a GPU.
+		template<class QueueT>
+		class basic_recording_backend
+		{
+		public:
+
+			struct frame_stats
+			{
+				std::size_t m_draws = 0;
+				std::size_t m_indirect_commands = 0;
+				std::size_t m_instances = 0; // including the ones drawn by indirect commands
+				std::size_t m_instance_data_bytes = 0;
+				std::size_t m_uniforms = 0;
+				std::size_t m_state_changes = 0; // render_state changes (starting from the defaults)
+				std::size_t m_program_changes = 0;
+				std::size_t m_vertex_array_changes = 0;
+			};
+
+			basic_recording_backend();
+
+			void draw(QueueT const& queue, typename QueueT::draw_packet const& packet);
+			void finish();
+
+			frame_stats const& get_stats() const { return m_stats; }
+			std::vector<typename QueueT::draw_packet> const& get_packets() const { return m_packets; } // in draw order
+
+			void clear();
+
+		private:
+
+			frame_stats m_stats;
+			std::vector<typename QueueT::draw_packet> m_packets;
+			typename QueueT::render_state m_last_state;
+			typename QueueT::program_type const* m_last_program;
+			typename QueueT::vertex_array_type const* m_last_vertex_array;
+		};
+
+		using recording_backend = basic_recording_backend<render_queue>;
+
+		template<class ProgramT, class VertexArrayT>
+		basic_render_queue<ProgramT, VertexArrayT>::basic_render_queue():
+			m_pending_uniforms(0),
+			m_pending_instance_data(0),
+			m_pending_attributes(0),
+			m_pending_instance_size(0) { }
+
+		template<class ProgramT, class VertexArrayT>
+		std::uint64_t basic_render_queue<ProgramT, VertexArrayT>::make_sort_key(std::uint32_t program_id, std::uint32_t vertex_array_id, std::uint32_t order, std::uint8_t pass)
+		{
+			return
+				(std::uint64_t(pass) << 56) |
+				(std::uint64_t(program_id & 0xffffu) << 40) |
+				(std::uint64_t(vertex_array_id & 0xffffu) << 24) |
+				(std::uint64_t(order & 0xffffffu));
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		void basic_render_queue<ProgramT, VertexArrayT>::add_uniform(GLint location, uniform_value const& value)
+		{
+			m_uniforms.push_back({ location, value });
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		template<class InstanceT>
+		span<InstanceT> basic_render_queue<ProgramT, VertexArrayT>::add_instances(std::size_t instance_count)
+		{
+			static_assert(sizeof(InstanceT) % sizeof(float) == 0 && alignof(InstanceT) <= alignof(float), "Instances must be made of floats.");
+
+			die_if(m_instance_data.size() != m_pending_instance_data); // only one lot of instances per packet
+
+			m_pending_instance_size = sizeof(InstanceT) / sizeof(float);
+			m_instance_data.resize(m_instance_data.size() + instance_count * m_pending_instance_size);
+
+			return { reinterpret_cast<InstanceT*>(m_instance_data.data() + m_pending_instance_data), instance_count };
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		void basic_render_queue<ProgramT, VertexArrayT>::add_instance_attribute(GLuint location, std::size_t offset_bytes, GLint components, GLint locations)
+		{
+			m_attributes.push_back({ location, offset_bytes, components, locations });
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		void basic_render_queue<ProgramT, VertexArrayT>::submit_indexed(std::uint64_t sort_key, program_type const& program, vertex_array_type& vertex_array, GLenum primitive_type, std::size_t index_count, GLenum index_type, std::size_t instance_count, std::size_t first_index, GLint base_vertex)
+		{
+			submit({ sort_key, m_state, &program, &vertex_array, primitive_type, index_count, index_type, instance_count, first_index, base_vertex, false, 0 });
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		void basic_render_queue<ProgramT, VertexArrayT>::submit_arrays(std::uint64_t sort_key, program_type const& program, vertex_array_type& vertex_array, GLenum primitive_type, std::size_t vertex_count, std::size_t instance_count)
+		{
+			submit({ sort_key, m_state, &program, &vertex_array, primitive_type, vertex_count, GL_NONE, instance_count, 0, 0, false, 0 });
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		void basic_render_queue<ProgramT, VertexArrayT>::submit_indexed_indirect(std::uint64_t sort_key, program_type const& program, vertex_array_type& vertex_array, GLenum primitive_type, GLenum index_type, span<draw_indexed_indirect_command const> commands)
+		{
+			die_if(index_type == GL_NONE);
+			die_if(commands.empty());
+
+			auto const first_command = m_commands.size();
+			m_commands.insert(m_commands.end(), commands.begin(), commands.end());
+
+			submit({ sort_key, m_state, &program, &vertex_array, primitive_type, commands.size(), index_type, 0, 0, 0, true, first_command });
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		void basic_render_queue<ProgramT, VertexArrayT>::sort()
+		{
+			ZoneScopedN("render_queue::sort()");
+
+			std::stable_sort(m_order.begin(), m_order.end(),
+				[&] (std::uint32_t a, std::uint32_t b) { return m_packets[a].m_sort_key < m_packets[b].m_sort_key; });
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		template<class BackendT>
+		void basic_render_queue<ProgramT, VertexArrayT>::execute(BackendT& backend) const
+		{
+			for (auto i : m_order)
+				backend.draw(*this, m_packets[i]);
+
+			backend.finish();
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		void basic_render_queue<ProgramT, VertexArrayT>::clear()
+		{
+			m_state = render_state();
+			m_packets.clear();
+			m_uniforms.clear();
+			m_instance_data.clear();
+			m_attributes.clear();
+			m_commands.clear();
+			m_pending_uniforms = 0;
+			m_pending_instance_data = 0;
+			m_pending_attributes = 0;
+			m_pending_instance_size = 0;
+			m_order.clear();
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		span<draw_indexed_indirect_command const> basic_render_queue<ProgramT, VertexArrayT>::get_commands(draw_packet const& packet) const
+		{
+			if (!packet.m_indirect)
+				return { };
+
+			return { m_commands.data() + packet.m_first_command, packet.m_element_count };
+		}
+
+		template<class ProgramT, class VertexArrayT>
+		void basic_render_queue<ProgramT, VertexArrayT>::submit(draw_packet packet)
+		{
+			packet.m_first_uniform = m_pending_uniforms;
+			packet.m_uniform_count = m_uniforms.size() - m_pending_uniforms;
+
+			packet.m_first_instance_data = m_pending_instance_data;
+			packet.m_instance_data_size = m_instance_data.size() - m_pending_instance_data;
+			packet.m_instance_size = m_pending_instance_size;
+
+			packet.m_first_attribute = m_pending_attributes;
+			packet.m_attribute_count = m_attributes.size() - m_pending_attributes;
+
+			die_if(packet.m_attribute_count != 0 && packet.m_instance_size == 0); // attributes, but no instances
+
+			m_order.push_back(narrow_cast<std::uint32_t>(m_packets.size()));
+			m_packets.push_back(packet);
+
+			m_pending_uniforms = m_uniforms.size();
+			m_pending_instance_data = m_instance_data.size();
+			m_pending_attributes = m_attributes.size();
+			m_pending_instance_size = 0;
+		}
+
+		template<class QueueT>
+		basic_recording_backend<QueueT>::basic_recording_backend():
+			m_last_state(),
+			m_last_program(nullptr),
+			m_last_vertex_array(nullptr) { }
+
+		template<class QueueT>
+		void basic_recording_backend<QueueT>::draw(QueueT const& queue, typename QueueT::draw_packet const& packet)
+		{
+			m_stats.m_draws += 1;
+
+			if (packet.m_indirect)
+			{
+				auto const commands = queue.get_commands(packet);
+				m_stats.m_indirect_commands += commands.size();
+
+				for (auto const& c : commands)
+					m_stats.m_instances += c.m_instance_count;
+			}
+			else
+			{
+				m_stats.m_instances += packet.m_instance_count;
+			}
+
+			m_stats.m_instance_data_bytes += queue.get_instance_data(packet).size_bytes();
+			m_stats.m_uniforms += queue.get_uniforms(packet).size();
+
+			auto const& s = packet.m_state;
+
+			if (s.m_blending != m_last_state.m_blending || s.m_depth_test != m_last_state.m_depth_test ||
+				s.m_depth_write != m_last_state.m_depth_write || s.m_face_culling != m_last_state.m_face_culling)
+				m_stats.m_state_changes += 1;
+
+			if (packet.m_program != m_last_program)
+				m_stats.m_program_changes += 1;
+
+			if (packet.m_vertex_array != m_last_vertex_array)
+				m_stats.m_vertex_array_changes += 1;
+
+			m_last_state = s;
+			m_last_program = packet.m_program;
+			m_last_vertex_array = packet.m_vertex_array;
+
+			m_packets.push_back(packet);
+		}
+
+		template<class QueueT>
+		void basic_recording_backend<QueueT>::finish()
+		{
+			m_last_state = typename QueueT::render_state();
+			m_last_program = nullptr;
+			m_last_vertex_array = nullptr;
+		}
+
+		template<class QueueT>
+		void basic_recording_backend<QueueT>::clear()
+		{
+			m_stats = frame_stats();
+			m_packets.clear();
+			finish();
+		}
+
+	} // gl
+
+} // bump
\ No newline at end of file
@@ -17,6 +17,42 @@ namespace bump
 	namespace gl
 	{
 
+		namespace
+		{
+
+			GLenum get_depth_func(renderer::depth_test mode)
+			{
+				switch (mode)
+				{
+				case renderer::depth_test::LESS: return GL_LESS;
+				case renderer::depth_test::LESS_EQUAL: return GL_LEQUAL;
+				case renderer::depth_test::GREATER: return GL_GREATER;
+				case renderer::depth_test::GREATER_EQUAL: return GL_GEQUAL;
+				case renderer::depth_test::EQUAL: return GL_EQUAL;
+				case renderer::depth_test::NOT_EQUAL: return GL_NOTEQUAL;
+				case renderer::depth_test::ALWAYS: return GL_ALWAYS;
+				case renderer::depth_test::NEVER: return GL_NEVER;
+				}
+
+				die();
+				return GL_LESS;
+			}
+
+			std::size_t get_index_size_bytes(GLenum index_type)
+			{
+				switch (index_type)
+				{
+				case GL_UNSIGNED_BYTE: return sizeof(GLubyte);
+				case GL_UNSIGNED_SHORT: return sizeof(GLushort);
+				case GL_UNSIGNED_INT: return sizeof(GLuint);
+				}
+
+				die();
+				return 0;
+			}
+
+		} // unnamed
+
 		renderer::renderer()
 		{
 			set_depth_test(depth_test::LESS);
@@ -24,6 +60,50 @@ namespace bump
 			set_face_culling(face_culling::CLOCKWISE);
 		}
 
+		void renderer::reset_state_cache()
+		{
+			m_blend_enabled.reset();
+			m_depth_test_enabled.reset();
+			m_cull_face_enabled.reset();
+			m_program_point_size_enabled.reset();
+			m_seamless_cubemaps_enabled.reset();
+			m_framebuffer_srgb_enabled.reset();
+
+			m_blend_func.reset();
+			m_depth_func.reset();
+			m_depth_mask.reset();
+			m_front_face.reset();
+			m_point_size.reset();
+			m_viewport.reset();
+
+			m_program.reset();
+		}
+
+		template<class T>
+		bool renderer::update_state(std::optional<T>& cached, T const& value)
+		{
+			if (cached && *cached == value)
+			{
+				++m_state_stats.m_elided;
+				return false;
+			}
+
+			cached = value;
+			++m_state_stats.m_issued;
+			return true;
+		}
+
+		void renderer::set_capability(std::optional<bool>& cached, GLenum capability, bool enabled)
+		{
+			if (!update_state(cached, enabled))
+				return;
+
+			if (enabled)
+				glEnable(capability);
+			else
+				glDisable(capability);
+		}
+
 		void renderer::set_framebuffer(framebuffer const& fb)
 		{
 			die_if(!fb.is_valid());
@@ -39,15 +119,13 @@ namespace bump
 
 		void renderer::set_framebuffer_color_encoding(framebuffer_color_encoding mode)
 		{
-			if (mode == framebuffer_color_encoding::SRGB)
-				glEnable(GL_FRAMEBUFFER_SRGB);
-			else
-				glDisable(GL_FRAMEBUFFER_SRGB);
+			set_capability(m_framebuffer_srgb_enabled, GL_FRAMEBUFFER_SRGB, mode == framebuffer_color_encoding::SRGB);
 		}
 
 		void renderer::set_viewport(glm::ivec2 position, glm::uvec2 size)
 		{
-			glViewport(position.x, position.y, narrow_cast<GLsizei>(size.x), narrow_cast<GLsizei>(size.y));
+			if (update_state(m_viewport, std::make_tuple(position, size)))
+				glViewport(position.x, position.y, narrow_cast<GLsizei>(size.x), narrow_cast<GLsizei>(size.y));
 		}
 		
 		void renderer::clear_color_buffers(glm::f32vec4 color)
@@ -68,105 +146,86 @@ namespace bump
 
 		void renderer::set_point_size_mode(point_size_mode mode)
 		{
-			if (mode == point_size_mode::PROGRAM)
-				glEnable(GL_PROGRAM_POINT_SIZE);
-			else
-				glDisable(GL_PROGRAM_POINT_SIZE);
+			set_capability(m_program_point_size_enabled, GL_PROGRAM_POINT_SIZE, mode == point_size_mode::PROGRAM);
 		}
 		
 		void renderer::set_pipeline_point_size(float size)
 		{
-			glPointSize(size);
+			if (update_state(m_point_size, size))
+				glPointSize(size);
 		}
 		
 		void renderer::set_blending(blending mode)
 		{
+			set_capability(m_blend_enabled, GL_BLEND, mode != blending::NONE);
+
 			if (mode == blending::NONE)
-			{
-				glDisable(GL_BLEND);
-			}
-			else if (mode == blending::BLEND)
-			{
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			}
+				return; // leave the blend function as it is
+
+			auto func = std::tuple<GLenum, GLenum>();
+
+			if (mode == blending::BLEND)
+				func = { GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA };
 			else if (mode == blending::ADD)
-			{
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_ONE, GL_ONE);
-			}
+				func = { GL_ONE, GL_ONE };
 			else if (mode == blending::MOD)
-			{
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_DST_COLOR, GL_ZERO);
-			}
+				func = { GL_DST_COLOR, GL_ZERO };
+
+			if (update_state(m_blend_func, func))
+				glBlendFunc(std::get<0>(func), std::get<1>(func));
 		}
 
 		void renderer::set_depth_test(depth_test mode)
 		{
-			glEnable(GL_DEPTH_TEST);
-
-			using p = std::tuple<depth_test, GLenum>;
+			set_capability(m_depth_test_enabled, GL_DEPTH_TEST, true);
 
-			auto const funcs =
-			{ 
-				p{ depth_test::LESS, GL_LESS }, 
-				p{ depth_test::LESS_EQUAL, GL_LEQUAL }, 
-				p{ depth_test::GREATER, GL_GREATER }, 
-				p{ depth_test::GREATER_EQUAL, GL_GEQUAL }, 
-				p{ depth_test::EQUAL, GL_EQUAL }, 
-				p{ depth_test::NOT_EQUAL, GL_NOTEQUAL }, 
-				p{ depth_test::ALWAYS, GL_ALWAYS }, 
-				p{ depth_test::NEVER, GL_NEVER },
-			};
+			auto const func = get_depth_func(mode);
 
-			auto f = std::find_if(funcs.begin(), funcs.end(), [&] (p p) { return std::get<0>(p) == mode; });
-			die_if(f == funcs.end());
-
-			glDepthFunc(std::get<1>(*f));
+			if (update_state(m_depth_func, func))
+				glDepthFunc(func);
 		}
 
 		void renderer::set_depth_write(depth_write mode)
 		{
-			glDepthMask(mode == depth_write::ENABLED ? GL_TRUE : GL_FALSE);
+			auto const mask = GLboolean(mode == depth_write::ENABLED ? GL_TRUE : GL_FALSE);
+
+			if (update_state(m_depth_mask, mask))
+				glDepthMask(mask);
 		}
 
 		void renderer::set_face_culling(face_culling mode)
 		{
 			if (mode == face_culling::NONE)
 			{
-				glDisable(GL_CULL_FACE);
-			}
-			else if (mode == face_culling::CLOCKWISE)
-			{
-				glFrontFace(GL_CCW);
-				glEnable(GL_CULL_FACE);
-			}
-			else if (mode == face_culling::COUNTER_CLOCKWISE)
-			{
-				glFrontFace(GL_CW);
-				glEnable(GL_CULL_FACE);
+				set_capability(m_cull_face_enabled, GL_CULL_FACE, false);
+				return;
 			}
+
+			auto const front_face = GLenum(mode == face_culling::CLOCKWISE ? GL_CCW : GL_CW);
+
+			if (update_state(m_front_face, front_face))
+				glFrontFace(front_face);
+
+			set_capability(m_cull_face_enabled, GL_CULL_FACE, true);
 		}
 		
 		void renderer::set_seamless_cubemaps(seamless_cubemaps mode)
 		{
-			if (mode == seamless_cubemaps::ENABLED)
-				glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-			else
-				glDisable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+			set_capability(m_seamless_cubemaps_enabled, GL_TEXTURE_CUBE_MAP_SEAMLESS, mode == seamless_cubemaps::ENABLED);
 		}
 		
 		void renderer::set_program(shader_program const& program)
 		{
 			die_if(!program.is_valid());
 
-			glUseProgram(program.get_id());
+			if (update_state(m_program, program.get_id()))
+				glUseProgram(program.get_id());
 		}
 
 		void renderer::clear_program()
 		{
-			glUseProgram(0);
+			if (update_state(m_program, GLuint{ 0 }))
+				glUseProgram(0);
 		}
 		
 		void renderer::set_texture_2d(GLuint location, texture_2d const& texture)
@@ -201,6 +260,14 @@ namespace bump
 			glBindTexture(GL_TEXTURE_3D, texture.get_id());
 		}
 
+		void renderer::set_texture_buffer(GLuint location, texture_buffer const& texture)
+		{
+			die_if(!texture.is_valid());
+			
+			glActiveTexture(GL_TEXTURE0 + location);
+			glBindTexture(GL_TEXTURE_BUFFER, texture.get_id());
+		}
+
 		void renderer::clear_texture_2d(GLuint location)
 		{
 			glActiveTexture(GL_TEXTURE0 + location);
@@ -224,6 +291,12 @@ namespace bump
 			glActiveTexture(GL_TEXTURE0 + location);
 			glBindTexture(GL_TEXTURE_3D, 0);
 		}
+
+		void renderer::clear_texture_buffer(GLuint location)
+		{
+			glActiveTexture(GL_TEXTURE0 + location);
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+		}
 		
 		void renderer::set_vertex_array(vertex_array const& vertex_array)
 		{
@@ -242,9 +315,24 @@ namespace bump
 			glDrawArraysInstanced(primitive_type, 0, narrow_cast<GLsizei>(vertex_count), narrow_cast<GLsizei>(instance_count));
 		}
 
-		void renderer::draw_indexed(GLenum primitive_type, std::size_t index_count, GLenum index_type, std::size_t instance_count)
+		void renderer::draw_indexed(GLenum primitive_type, std::size_t index_count, GLenum index_type, std::size_t instance_count, std::size_t first_index, GLint base_vertex)
+		{
+			auto const offset = reinterpret_cast<void const*>(first_index * get_index_size_bytes(index_type));
+			glDrawElementsInstancedBaseVertex(primitive_type, narrow_cast<GLsizei>(index_count), index_type, offset, narrow_cast<GLsizei>(instance_count), base_vertex);
+		}
+
+		bool renderer::is_multi_draw_indirect_supported()
 		{
-			glDrawElementsInstanced(primitive_type, narrow_cast<GLsizei>(index_count), index_type, nullptr, narrow_cast<GLsizei>(instance_count));
+			return GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance;
+		}
+
+		void renderer::draw_indexed_indirect(GLenum primitive_type, GLenum index_type, GLuint command_buffer_id, std::size_t offset_bytes, std::size_t command_count)
+		{
+			die_if(command_buffer_id == 0);
+
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer_id);
+			glMultiDrawElementsIndirect(primitive_type, index_type, reinterpret_cast<void const*>(offset_bytes), narrow_cast<GLsizei>(command_count), sizeof(draw_indexed_indirect_command));
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 		}
 		
 	} // gl
@@ -5,6 +5,10 @@
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 
+#include <cstddef>
+#include <optional>
+#include <tuple>
+
 namespace bump
 {
 	
@@ -17,14 +21,42 @@ namespace bump
 		class texture_cubemap;
 		class texture_2d_array;
 		class texture_3d;
+		class texture_buffer;
 		class vertex_array;
 
+		// one draw in a multi-draw indirect command buffer.
+		// note: the layout must match what glMultiDrawElementsIndirect expects.
+		struct draw_indexed_indirect_command
+		{
+			GLuint m_index_count;
+			GLuint m_instance_count;
+			GLuint m_first_index;
+			GLint m_base_vertex;
+			GLuint m_base_instance;
+		};
+
 		class renderer
 		{
 		public:
 
 			renderer();
 
+			// note: the renderer keeps a copy of the pipeline state it sets (capabilities, blend / depth / cull settings, 
+			// viewport and program), and skips GL calls that wouldn't change anything.
+			// framebuffer, texture and vertex array bindings aren't cached (the gl object classes bind them directly when setting data).
+			// if GL state is changed outside the renderer, call reset_state_cache() so the next calls aren't skipped.
+
+			struct state_stats
+			{
+				std::size_t m_issued = 0; // state changes sent to GL
+				std::size_t m_elided = 0; // state changes skipped (already set)
+			};
+
+			state_stats const& get_state_stats() const { return m_state_stats; }
+			void reset_state_stats() { m_state_stats = state_stats(); }
+
+			void reset_state_cache();
+
 			void set_viewport(glm::ivec2 position, glm::uvec2 size);
 
 			void set_framebuffer(framebuffer const& fb);
@@ -62,11 +94,13 @@ namespace bump
 			void set_texture_cubemap(GLuint location, texture_cubemap const& texture);
 			void set_texture_2d_array(GLuint location, texture_2d_array const& texture);
 			void set_texture_3d(GLuint location, texture_3d const& texture);
+			void set_texture_buffer(GLuint location, texture_buffer const& texture);
 
 			void clear_texture_2d(GLuint location);
 			void clear_texture_cubemap(GLuint location);
 			void clear_texture_2d_array(GLuint location);
 			void clear_texture_3d(GLuint location);
+			void clear_texture_buffer(GLuint location);
 
 			void set_vertex_array(vertex_array const& vertex_array);
 			void clear_vertex_array();
@@ -146,7 +180,39 @@ namespace bump
 			void set_uniform_data_4x4d(GLint location, GLdouble* data, std::size_t count) { glUniformMatrix4dv  (location, narrow_cast<GLsizei>(count), GL_FALSE, data); }
 
 			void draw_arrays(GLenum primitive_type, std::size_t vertex_count, std::size_t instance_count = 1);
-			void draw_indexed(GLenum primitive_type, std::size_t index_count, GLenum index_type, std::size_t instance_count = 1);
+			void draw_indexed(GLenum primitive_type, std::size_t index_count, GLenum index_type, std::size_t instance_count = 1, std::size_t first_index = 0, GLint base_vertex = 0);
+
+			// draws command_count draw_indexed_indirect_commands from the command buffer, starting at offset_bytes.
+			// note: needs ARB_multi_draw_indirect and ARB_base_instance (core in 4.3, but we only ask for a 4.0 context).
+			// check is_multi_draw_indirect_supported() first, and fall back to draw_indexed() if it isn't.
+			static bool is_multi_draw_indirect_supported();
+			void draw_indexed_indirect(GLenum primitive_type, GLenum index_type, GLuint command_buffer_id, std::size_t offset_bytes, std::size_t command_count);
+
+		private:
+
+			template<class T>
+			bool update_state(std::optional<T>& cached, T const& value); // returns true if the value changed (and GL needs to be called)
+
+			void set_capability(std::optional<bool>& cached, GLenum capability, bool enabled);
+
+			// cached state (empty if unknown)
+			std::optional<bool> m_blend_enabled;
+			std::optional<bool> m_depth_test_enabled;
+			std::optional<bool> m_cull_face_enabled;
+			std::optional<bool> m_program_point_size_enabled;
+			std::optional<bool> m_seamless_cubemaps_enabled;
+			std::optional<bool> m_framebuffer_srgb_enabled;
+
+			std::optional<std::tuple<GLenum, GLenum>> m_blend_func;
+			std::optional<GLenum> m_depth_func;
+			std::optional<GLboolean> m_depth_mask;
+			std::optional<GLenum> m_front_face;
+			std::optional<float> m_point_size;
+			std::optional<std::tuple<glm::ivec2, glm::uvec2>> m_viewport;
+
+			std::optional<GLuint> m_program;
+
+			state_stats m_state_stats;
 		};
 
 	} // gl
@@ -89,6 +89,18 @@ namespace bump
 			reset(id, [] (GLuint id) { glDeleteProgram(id); });
 		}
 
+		bool shader_program::is_program_binary_supported()
+		{
+			if (!GLEW_ARB_get_program_binary)
+				return false;
+
+			auto format_count = GLint{ 0 };
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+
+			die_if_error();
+			return (format_count > 0);
+		}
+
 		void shader_program::attach(shader_object const& object)
 		{
 			die_if(!is_valid());
@@ -126,6 +138,48 @@ namespace bump
 			return (status == GL_TRUE);
 		}
 
+		void shader_program::set_binary_retrievable_hint(bool retrievable)
+		{
+			die_if(!is_valid());
+
+			glProgramParameteri(get_id(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, retrievable ? GL_TRUE : GL_FALSE);
+			die_if_error();
+		}
+
+		program_binary shader_program::get_binary() const
+		{
+			die_if(!is_valid());
+			die_if(!is_linked());
+
+			auto length = GLint{ 0 };
+			glGetProgramiv(get_id(), GL_PROGRAM_BINARY_LENGTH, &length);
+			die_if_error();
+
+			die_if(length < 0);
+			if (length == 0) return { };
+
+			auto binary = program_binary();
+			binary.m_data.resize(length);
+
+			auto written = GLsizei{ 0 };
+			glGetProgramBinary(get_id(), length, &written, &binary.m_format, binary.m_data.data());
+			binary.m_data.resize(written);
+
+			die_if_error();
+			return binary;
+		}
+
+		bool shader_program::set_binary(program_binary const& binary)
+		{
+			die_if(!is_valid());
+
+			glProgramBinary(get_id(), binary.m_format, binary.m_data.data(), narrow_cast<GLsizei>(binary.m_data.size()));
+
+			// note: an unsupported format is an error, but an out of date binary just fails to link
+			auto const error = glGetError();
+			return (error == GL_NO_ERROR && is_linked());
+		}
+
 		bool shader_program::validate()
 		{
 			die_if(!is_valid());
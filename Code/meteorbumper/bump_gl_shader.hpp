@@ -4,7 +4,9 @@
 
 #include <GL/glew.h>
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace bump
 {
@@ -27,18 +29,35 @@ namespace bump
 			std::string get_log() const;
 		};
 
+		// a linked program, as returned by the driver. only valid for the same driver (and hardware) that produced it.
+		struct program_binary
+		{
+			GLenum m_format = 0;
+			std::vector<std::byte> m_data;
+		};
+
 		class shader_program : public object_handle
 		{
 		public:
 
 			shader_program();
 
+			// ARB_get_program_binary is core in 4.1, but we only ask for a 4.0 context.
+			// note: drivers may support the extension, but no binary formats.
+			static bool is_program_binary_supported();
+
 			void attach(shader_object const& object);
 			void detach(shader_object const& object);
 
 			bool link();
 			bool is_linked() const;
 
+			// call before link() to ask the driver to keep the binary around.
+			void set_binary_retrievable_hint(bool retrievable);
+
+			program_binary get_binary() const;
+			bool set_binary(program_binary const& binary); // returns false if the driver rejects the binary (the program is left unlinked)
+
 			bool validate();
 			bool is_validated() const;
 
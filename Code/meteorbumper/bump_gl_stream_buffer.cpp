@@ -0,0 +1,254 @@
+#include "bump_gl_stream_buffer.hpp"
+
+#include "bump_die.hpp"
+#include "bump_gl_error.hpp"
+
+#include <Tracy.hpp>
+
+#include <utility>
+
+namespace bump
+{
+
+	namespace gl
+	{
+
+		namespace
+		{
+
+			auto const alignment_bytes = std::size_t{ 16 };
+
+			std::size_t align_up(std::size_t offset, std::size_t alignment)
+			{
+				return ((offset + alignment - 1) / alignment) * alignment;
+			}
+
+		} // unnamed
+
+		stream_buffer::stream_buffer(std::size_t frame_size_bytes):
+			m_persistent(GLEW_ARB_buffer_storage), // core in 4.4, but we only ask for a 4.0 context
+			m_frame_size_bytes(0),
+			m_mapped(nullptr),
+			m_staging(),
+			m_fences{ },
+			m_retired(),
+			m_frame_index(get_frame_index()),
+			m_region(0),
+			m_head_bytes(0),
+			m_offset_bytes(0),
+			m_size_bytes(0),
+			m_committed(true),
+			m_component_type(0),
+			m_component_size_bytes(0),
+			m_component_count(0),
+			m_element_count(0)
+		{
+			create_storage(align_up(frame_size_bytes, alignment_bytes));
+		}
+
+		stream_buffer::~stream_buffer()
+		{
+			if (!is_valid()) // moved from
+				return;
+
+			for (auto& f : m_fences)
+				if (f) glDeleteSync(f);
+
+			// note: the buffer is unmapped when it's deleted
+		}
+
+		void stream_buffer::end_frame()
+		{
+			++get_frame_index();
+		}
+
+		void stream_buffer::commit()
+		{
+			die_if(!is_valid());
+			die_if(m_committed);
+
+			if (!m_persistent && m_size_bytes != 0)
+			{
+				glBindBuffer(GL_ARRAY_BUFFER, get_id());
+				glBufferSubData(GL_ARRAY_BUFFER, m_offset_bytes, m_size_bytes, m_staging.data() + m_offset_bytes);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+				die_if_error();
+			}
+
+			m_committed = true;
+		}
+
+		std::size_t stream_buffer::get_offset_bytes() const
+		{
+			die_if(!is_valid());
+
+			return m_offset_bytes;
+		}
+
+		GLenum stream_buffer::get_component_type() const
+		{
+			die_if(!is_valid());
+
+			return m_component_type;
+		}
+
+		std::size_t stream_buffer::get_component_size_bytes() const
+		{
+			die_if(!is_valid());
+
+			return m_component_size_bytes;
+		}
+
+		std::size_t stream_buffer::get_element_size_bytes() const
+		{
+			die_if(!is_valid());
+
+			return get_component_size_bytes() * get_component_count();
+		}
+
+		std::size_t stream_buffer::get_component_count() const
+		{
+			die_if(!is_valid());
+
+			return m_component_count;
+		}
+
+		std::size_t stream_buffer::get_element_count() const
+		{
+			die_if(!is_valid());
+
+			return m_element_count;
+		}
+
+		std::uint64_t& stream_buffer::get_frame_index()
+		{
+			static auto frame_index = std::uint64_t{ 0 };
+			return frame_index;
+		}
+
+		std::byte* stream_buffer::map_bytes(std::size_t size_bytes)
+		{
+			if (m_frame_index != get_frame_index())
+				begin_frame();
+
+			auto offset = align_up(m_head_bytes, alignment_bytes);
+
+			if (offset + size_bytes > m_frame_size_bytes)
+			{
+				// out of space. data already mapped this frame stays in the old buffer
+				// (which is kept until the next frame).
+				create_storage(align_up(std::max(m_frame_size_bytes * 2, size_bytes), alignment_bytes));
+				offset = 0;
+			}
+
+			m_head_bytes = offset + size_bytes;
+
+			m_offset_bytes = m_region * m_frame_size_bytes + offset;
+			m_size_bytes = size_bytes;
+			m_committed = false;
+
+			return m_persistent ? (m_mapped + m_offset_bytes) : (m_staging.data() + m_offset_bytes);
+		}
+
+		void stream_buffer::create_storage(std::size_t frame_size_bytes)
+		{
+			for (auto& f : m_fences)
+			{
+				if (f) glDeleteSync(f);
+				f = nullptr;
+			}
+
+			// keep the old buffer until the draw calls using it have been issued
+			if (is_valid())
+				m_retired.push_back(std::move(static_cast<object_handle&>(*this)));
+
+			auto id = GLuint{ 0 };
+			glGenBuffers(1, &id);
+			die_if(!id);
+
+			reset(id, [] (GLuint id) { glDeleteBuffers(1, &id); });
+
+			m_frame_size_bytes = frame_size_bytes;
+			m_region = 0;
+			m_head_bytes = 0;
+			m_mapped = nullptr;
+
+			glBindBuffer(GL_ARRAY_BUFFER, get_id());
+
+			if (m_persistent)
+			{
+				auto const size = m_frame_size_bytes * region_count;
+				auto const flags = GLbitfield{ GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT };
+
+				glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+				m_mapped = static_cast<std::byte*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+				die_if(!m_mapped);
+			}
+			else
+			{
+				glBufferData(GL_ARRAY_BUFFER, m_frame_size_bytes, nullptr, GL_STREAM_DRAW);
+				m_staging.resize(m_frame_size_bytes);
+			}
+
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			die_if_error();
+		}
+
+		void stream_buffer::begin_frame()
+		{
+			m_frame_index = get_frame_index();
+			m_head_bytes = 0;
+
+			// last frame's draw calls have all been issued, so the driver can delete these once the gpu is done with them
+			m_retired.clear();
+
+			if (!m_persistent)
+			{
+				// orphan the old storage. the driver keeps it alive until the gpu is done with it.
+				glBindBuffer(GL_ARRAY_BUFFER, get_id());
+				glBufferData(GL_ARRAY_BUFFER, m_frame_size_bytes, nullptr, GL_STREAM_DRAW);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+				die_if_error();
+
+				return;
+			}
+
+			// the draw calls using the last region have all been issued now, so we can fence it
+			die_if(m_fences[m_region] != nullptr);
+			m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			m_region = (m_region + 1) % region_count;
+			wait_for_region(m_region);
+		}
+
+		void stream_buffer::wait_for_region(std::size_t region)
+		{
+			auto& fence = m_fences[region];
+
+			if (!fence)
+				return;
+
+			ZoneScopedN("stream_buffer::wait_for_region()");
+
+			auto const timeout_ns = GLuint64{ 1'000'000 };
+
+			while (true)
+			{
+				auto const result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+
+				if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+					break;
+
+				die_if(result == GL_WAIT_FAILED);
+			}
+
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+
+	} // gl
+
+} // bump
\ No newline at end of file
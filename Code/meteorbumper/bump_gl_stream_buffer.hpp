@@ -0,0 +1,132 @@
+#pragma once
+
+#include "bump_die.hpp"
+#include "bump_gl_object_handle.hpp"
+#include "bump_gl_traits.hpp"
+#include "bump_span.hpp"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bump
+{
+
+	namespace gl
+	{
+
+		// a vertex buffer for data that's re-uploaded every frame (e.g. instance data).
+		//
+		// each frame's data is sub-allocated from a ring of three regions. if ARB_buffer_storage is available,
+		// the buffer is persistently mapped, map() returns a pointer straight into the buffer, and a fence on
+		// each region stops us writing to it while the gpu might still be reading from it.
+		// otherwise, map() returns a pointer into a staging area, the buffer is orphaned at the start of each
+		// frame, and commit() uploads the data with glBufferSubData.
+		//
+		// usage: map() some space, write to it, commit(), then point a vertex_array at it (the offset changes
+		// every time, so this has to be done every time the data is drawn).
+		//
+		// note: stream_buffer::end_frame() must be called once per frame, after all the draw calls are issued.
+		// note: the data for one frame must fit in the buffer. if it doesn't, a bigger buffer is created. the old one
+		// (with the data already mapped this frame) isn't deleted until the next frame, so its id stays valid for
+		// anything that took it earlier in the frame.
+		class stream_buffer : public object_handle
+		{
+		public:
+
+			explicit stream_buffer(std::size_t frame_size_bytes = 16 * 1024);
+			~stream_buffer();
+
+			stream_buffer(stream_buffer&&) = default;
+			stream_buffer& operator=(stream_buffer&&) = delete;
+
+			static void end_frame();
+
+			// returns space for element_count elements of component_count components.
+			// the data is only valid for this frame, and must be committed before drawing.
+			template<class ComponentT>
+			span<ComponentT> map(std::size_t component_count, std::size_t element_count);
+
+			void commit();
+
+			// map, copy and commit in one go
+			template<class ComponentT>
+			void set_data(ComponentT const* data, std::size_t component_count, std::size_t element_count);
+
+			bool is_persistent() const { return m_persistent; }
+
+			// the last mapped data:
+			std::size_t get_offset_bytes() const;
+
+			GLenum get_component_type() const;
+
+			std::size_t get_component_size_bytes() const;
+			std::size_t get_element_size_bytes() const;
+
+			std::size_t get_component_count() const;
+			std::size_t get_element_count() const;
+
+		private:
+
+			static std::uint64_t& get_frame_index();
+
+			std::byte* map_bytes(std::size_t size_bytes);
+			void create_storage(std::size_t frame_size_bytes);
+			void begin_frame();
+			void wait_for_region(std::size_t region);
+
+			static constexpr std::size_t region_count = 3;
+
+			bool m_persistent;
+			std::size_t m_frame_size_bytes;
+			std::byte* m_mapped; // persistent only
+			std::vector<std::byte> m_staging; // fallback only
+			std::array<GLsync, region_count> m_fences;
+			std::vector<object_handle> m_retired; // buffers replaced this frame (deleted in begin_frame())
+
+			std::uint64_t m_frame_index;
+			std::size_t m_region;
+			std::size_t m_head_bytes; // offset in the current region
+
+			std::size_t m_offset_bytes; // offset of the last mapped data in the buffer
+			std::size_t m_size_bytes;
+			bool m_committed;
+
+			GLenum m_component_type;
+			std::size_t m_component_size_bytes;
+			std::size_t m_component_count;
+			std::size_t m_element_count;
+		};
+
+		template<class ComponentT>
+		span<ComponentT> stream_buffer::map(std::size_t component_count, std::size_t element_count)
+		{
+			die_if(!is_valid());
+			die_if(!m_committed); // commit the last lot first!
+
+			m_component_type = traits::component_type_v<ComponentT>;
+			m_component_size_bytes = sizeof(ComponentT);
+			m_component_count = component_count;
+			m_element_count = element_count;
+
+			auto const size = component_count * element_count;
+			auto const data = map_bytes(size * sizeof(ComponentT));
+
+			return { reinterpret_cast<ComponentT*>(data), size };
+		}
+
+		template<class ComponentT>
+		void stream_buffer::set_data(ComponentT const* data, std::size_t component_count, std::size_t element_count)
+		{
+			auto const mapped = map<ComponentT>(component_count, element_count);
+			std::copy_n(data, mapped.size(), mapped.data());
+			commit();
+		}
+
+	} // gl
+
+} // bump
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "bump_gl_texture.hpp"
 
 #include "bump_die.hpp"
+#include "bump_gl_buffer.hpp"
 #include "bump_gl_error.hpp"
 
 namespace bump
@@ -472,6 +473,27 @@ namespace bump
 			die_if_error();
 		}
 		
+		texture_buffer::texture_buffer()
+		{
+			auto id = GLuint{ 0 };
+			glGenTextures(1, &id);
+			die_if(!id);
+
+			reset(id, [] (GLuint id) { glDeleteTextures(1, &id); });
+		}
+
+		void texture_buffer::set_buffer(buffer const& buffer, GLenum format)
+		{
+			die_if(!is_valid());
+			die_if(!buffer.is_valid());
+
+			glBindTexture(GL_TEXTURE_BUFFER, get_id());
+			glTexBuffer(GL_TEXTURE_BUFFER, format, buffer.get_id());
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+			die_if_error();
+		}
+		
 	} // gl
 	
 } // bump
\ No newline at end of file
@@ -11,6 +11,8 @@ namespace bump
 	
 	namespace gl
 	{
+
+		class buffer;
 		
 		// helper class to specify texture constructor parameters
 		class texture_data_source
@@ -131,6 +133,17 @@ namespace bump
 			
 			void generate_mipmaps();
 		};
+
+		// a texture that reads from a buffer's data store (samplerBuffer in glsl).
+		// note: the data isn't copied, so updating the buffer's data (even with set_data()) updates the texture.
+		class texture_buffer : public object_handle
+		{
+		public:
+
+			texture_buffer();
+
+			void set_buffer(buffer const& buffer, GLenum format);
+		};
 		
 	} // gl
 	
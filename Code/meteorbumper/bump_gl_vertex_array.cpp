@@ -2,6 +2,7 @@
 
 #include "bump_die.hpp"
 #include "bump_gl_buffer.hpp"
+#include "bump_gl_stream_buffer.hpp"
 #include "bump_narrow_cast.hpp"
 
 namespace bump
@@ -21,50 +22,85 @@ namespace bump
 
 		void vertex_array::set_array_buffer(GLuint location, buffer const& buffer, GLuint divisor)
 		{
-			die_if(!is_valid());
-			die_if(location == (GLuint)-1);
 			die_if(!buffer.is_valid());
 
 			// this won't catch small matrices, or arrays with fewer than 4 elements :(
 			// but those should use the other function too!!!
 			die_if(buffer.get_component_count() > 4); // use the other function for multi-slot attributes!
 
-			glBindVertexArray(get_id());
-			glBindBuffer(GL_ARRAY_BUFFER, buffer.get_id());
+			auto const component_count = narrow_cast<GLint>(buffer.get_component_count());
+			auto const stride = (GLsizei)buffer.get_element_size_bytes();
+
+			set_array_buffer(location, buffer.get_id(), buffer.get_component_type(), buffer.get_component_size_bytes(), component_count, 1, stride, 0, divisor);
+		}
+
+		void vertex_array::set_array_buffer(GLuint location, buffer const& buffer, GLint components, GLint elements, GLuint divisor)
+		{
+			die_if(!buffer.is_valid());
+
+			auto const stride = (GLsizei)buffer.get_element_size_bytes();
+
+			set_array_buffer(location, buffer.get_id(), buffer.get_component_type(), buffer.get_component_size_bytes(), components, elements, stride, 0, divisor);
+		}
+
+		void vertex_array::set_array_buffer(GLuint location, stream_buffer const& buffer, GLuint divisor)
+		{
+			die_if(!buffer.is_valid());
+			die_if(buffer.get_component_count() > 4); // use the other function for multi-slot attributes!
 
-			auto const component_type = buffer.get_component_type();
 			auto const component_count = narrow_cast<GLint>(buffer.get_component_count());
 			auto const stride = (GLsizei)buffer.get_element_size_bytes();
 
-			enable_vertex_attribute(location, component_count, component_type, stride, 0, divisor);
+			set_array_buffer(location, buffer.get_id(), buffer.get_component_type(), buffer.get_component_size_bytes(), component_count, 1, stride, buffer.get_offset_bytes(), divisor);
+		}
 
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
-			glBindVertexArray(0);
-			
-			die_if_error();
+		void vertex_array::set_array_buffer(GLuint location, stream_buffer const& buffer, GLint components, GLint elements, GLuint divisor)
+		{
+			die_if(!buffer.is_valid());
+
+			auto const stride = (GLsizei)buffer.get_element_size_bytes();
+
+			set_array_buffer(location, buffer.get_id(), buffer.get_component_type(), buffer.get_component_size_bytes(), components, elements, stride, buffer.get_offset_bytes(), divisor);
 		}
 
-		void vertex_array::set_array_buffer(GLuint location, buffer const& buffer, GLint components, GLint elements, GLuint divisor)
+		void vertex_array::set_interleaved_array_buffer(GLuint location, buffer const& buffer, std::size_t first_element, std::size_t member_offset_bytes, GLint components, GLint elements, GLuint divisor)
+		{
+			die_if(!buffer.is_valid());
+			die_if(member_offset_bytes + elements * components * buffer.get_component_size_bytes() > buffer.get_element_size_bytes());
+
+			auto const stride = (GLsizei)buffer.get_element_size_bytes();
+			auto const offset = first_element * buffer.get_element_size_bytes() + member_offset_bytes;
+
+			set_array_buffer(location, buffer.get_id(), buffer.get_component_type(), buffer.get_component_size_bytes(), components, elements, stride, offset, divisor);
+		}
+
+		void vertex_array::set_interleaved_array_buffer(GLuint location, stream_buffer const& buffer, std::size_t first_element, std::size_t member_offset_bytes, GLint components, GLint elements, GLuint divisor)
+		{
+			die_if(!buffer.is_valid());
+			die_if(member_offset_bytes + elements * components * buffer.get_component_size_bytes() > buffer.get_element_size_bytes());
+
+			auto const stride = (GLsizei)buffer.get_element_size_bytes();
+			auto const offset = buffer.get_offset_bytes() + first_element * buffer.get_element_size_bytes() + member_offset_bytes;
+
+			set_array_buffer(location, buffer.get_id(), buffer.get_component_type(), buffer.get_component_size_bytes(), components, elements, stride, offset, divisor);
+		}
+
+		void vertex_array::set_array_buffer(GLuint location, GLuint buffer_id, GLenum component_type, std::size_t component_size_bytes, GLint components, GLint elements, GLsizei stride, std::size_t offset, GLuint divisor)
 		{
 			die_if(!is_valid());
 			die_if(location == (GLuint)-1);
-			die_if(!buffer.is_valid());
 
 			die_if(components < 1 || components > 4);
 			
 			glBindVertexArray(get_id());
-			glBindBuffer(GL_ARRAY_BUFFER, buffer.get_id());
-
-			auto const component_type = buffer.get_component_type();
-			auto const component_count = (GLint)buffer.get_component_count();
-			auto const stride = (GLsizei)buffer.get_element_size_bytes();
+			glBindBuffer(GL_ARRAY_BUFFER, buffer_id);
 
 			for (auto i = 0; i != elements; ++i)
 			{
 				auto index = location + i;
-				auto offset = i * components * buffer.get_component_size_bytes();
+				auto element_offset = offset + i * components * component_size_bytes;
 
-				enable_vertex_attribute(index, components, component_type, stride, offset, divisor);
+				enable_vertex_attribute(index, components, component_type, stride, element_offset, divisor);
 			}
 
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
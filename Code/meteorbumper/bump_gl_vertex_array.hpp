@@ -9,6 +9,7 @@ namespace bump
 	{
 		
 		class buffer;
+		class stream_buffer;
 
 		class vertex_array : public object_handle
 		{
@@ -20,11 +21,20 @@ namespace bump
 			void set_array_buffer(GLuint location, buffer const& buffer, GLint components, GLint elements, GLuint divisor = 0);
 			void clear_array_buffer(GLuint location);
 
+			// note: these use the last data mapped from the stream buffer, so must be called again whenever it changes.
+			void set_array_buffer(GLuint location, stream_buffer const& buffer, GLuint divisor = 0);
+			void set_array_buffer(GLuint location, stream_buffer const& buffer, GLint components, GLint elements, GLuint divisor = 0);
+
+			// for interleaved buffers (i.e. arrays of structs): the attribute is member_offset_bytes into each element, and starts at first_element.
+			void set_interleaved_array_buffer(GLuint location, buffer const& buffer, std::size_t first_element, std::size_t member_offset_bytes, GLint components, GLint elements, GLuint divisor);
+			void set_interleaved_array_buffer(GLuint location, stream_buffer const& buffer, std::size_t first_element, std::size_t member_offset_bytes, GLint components, GLint elements, GLuint divisor);
+
 			void set_index_buffer(buffer const& buffer);
 			void clear_index_buffer();
 
 		private:
 
+			void set_array_buffer(GLuint location, GLuint buffer_id, GLenum component_type, std::size_t component_size_bytes, GLint components, GLint elements, GLsizei stride, std::size_t offset, GLuint divisor);
 			static void enable_vertex_attribute(GLuint location, GLint components, GLenum component_type, GLsizei stride, std::size_t offset, GLuint divisor);
 		};
 
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
+#include <string>
 #include <tuple>
 
 namespace bump
@@ -23,6 +25,18 @@ namespace bump
 		return std::hash<T>()(t);
 	}
 
+	// unlike std::hash, this is the same in every build (so it can be saved to disk).
+	inline std::uint64_t fnv1a_64(std::string const& data, std::uint64_t hash = 14695981039346656037ull)
+	{
+		for (auto c : data)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
 	template<class T> class tuple_hash;
 	
 	template<class... Ts>
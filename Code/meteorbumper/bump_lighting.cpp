@@ -1,16 +1,32 @@
 #include "bump_lighting.hpp"
 
 #include "bump_camera.hpp"
+#include "bump_entity_pool.hpp"
+#include "bump_frustum.hpp"
 #include "bump_narrow_cast.hpp"
-#include "bump_mbp_model.hpp"
 
 #include <Tracy.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace bump
 {
 
 	namespace lighting
 	{
+
+		namespace
+		{
+
+			// point lights smaller than this on screen (diameter in pixels) are culled
+			auto const point_light_min_size_px = 2.f;
+
+			// light below this intensity (color * attenuation) is treated as zero.
+			// point lights only reach as far as this (or their radius, if that's closer).
+			auto const point_light_min_intensity = 1.f / 256.f;
+
+		} // unnamed
 	
 		gbuffers::gbuffers(glm::ivec2 screen_size)
 		{
@@ -136,10 +152,10 @@ namespace bump
 			renderer.set_depth_test(gl::renderer::depth_test::LESS);
 		}
 
-		lighting_system::lighting_system(entt::registry& registry, gl::shader_program const& directional_light_shader, gl::shader_program const& point_light_shader, mbp_model const& point_light_model, gl::shader_program const& emissive_shader):
+		lighting_system::lighting_system(entt::registry& registry, gl::shader_program const& directional_light_shader, gl::shader_program const& point_light_shader, gl::shader_program const& emissive_shader):
 			m_registry(registry),
 			m_renderable_directional(registry, directional_light_shader),
-			m_renderable_point(registry, point_light_shader, point_light_model),
+			m_renderable_point(registry, point_light_shader),
 			m_renderable_emissive(registry, emissive_shader) { }
 		
 		void lighting_system::render(gl::renderer& renderer, glm::vec2 screen_size, camera_matrices const& light_matrices, camera_matrices const& scene_matrices, camera_matrices const& ui_matrices, gbuffers const& gbuf, gl::texture_2d const& shadow_map)
@@ -151,15 +167,7 @@ namespace bump
 			renderer.set_blending(gl::renderer::blending::ADD);
 
 			m_renderable_directional.render(renderer, screen_size, light_matrices, scene_matrices, ui_matrices, gbuf, shadow_map);
-
-			renderer.set_depth_test(gl::renderer::depth_test::GREATER_EQUAL);
-			renderer.set_face_culling(gl::renderer::face_culling::COUNTER_CLOCKWISE);
-
-			m_renderable_point.render(renderer, scene_matrices, gbuf);
-
-			renderer.set_face_culling(gl::renderer::face_culling::CLOCKWISE);
-			renderer.set_depth_test(gl::renderer::depth_test::ALWAYS);
-
+			m_renderable_point.render(renderer, screen_size, scene_matrices, ui_matrices, gbuf);
 			m_renderable_emissive.render(renderer, screen_size, ui_matrices, gbuf);
 
 			renderer.set_blending(gl::renderer::blending::NONE);
@@ -188,13 +196,7 @@ namespace bump
 			m_buffer_vertices.set_data(GL_ARRAY_BUFFER, vertices.begin(), 2, 6, GL_STATIC_DRAW);
 			m_vertex_array.set_array_buffer(m_in_VertexPosition, m_buffer_vertices);
 
-			m_buffer_light_directions.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_LightDirection, m_buffer_light_directions, 1);
-			m_buffer_light_colors.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_LightColor, m_buffer_light_colors, 1);
-			m_buffer_light_shadows.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 1, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_LightShadows, m_buffer_light_shadows, 1);
-			
+			// note: instance buffers are set up each frame (see render())
 		}
 
 		void lighting_system::directional_light_renderable::render(gl::renderer& renderer, glm::vec2 screen_size, camera_matrices const& light_matrices, camera_matrices const& scene_matrices, camera_matrices const& ui_matrices, gbuffers const& gbuf, gl::texture_2d const& shadow_map)
@@ -204,25 +206,28 @@ namespace bump
 				auto view = m_registry.view<directional_light>();
 				if (view.empty()) return;
 
-				m_frame_light_directions.reserve(view.size());
-				m_frame_light_colors.reserve(view.size());
-				m_frame_light_shadows.reserve(view.size());
+				auto const directions = reinterpret_cast<glm::vec3*>(m_buffer_light_directions.map<float>(3, view.size()).data());
+				auto const colors = reinterpret_cast<glm::vec3*>(m_buffer_light_colors.map<float>(3, view.size()).data());
+				auto const shadows = m_buffer_light_shadows.map<float>(1, view.size()).data();
+
+				auto i = std::size_t{ 0 };
 
 				for (auto id : view)
 				{
 					auto const& l = view.get<directional_light>(id);
-					m_frame_light_directions.push_back(glm::vec3(scene_matrices.m_view * glm::vec4(l.m_direction, 0.f)));
-					m_frame_light_colors.push_back(l.m_color);
-					m_frame_light_shadows.push_back(m_registry.has<main_light_tag>(id) ? 1.f : 0.f);
+					directions[i] = glm::vec3(scene_matrices.m_view * glm::vec4(l.m_direction, 0.f));
+					colors[i] = l.m_color;
+					shadows[i] = m_registry.has<main_light_tag>(id) ? 1.f : 0.f;
+					++i;
 				}
 
-				m_buffer_light_directions.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_light_directions.front()), 3, m_frame_light_directions.size(), GL_STREAM_DRAW);
-				m_buffer_light_colors.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_light_colors.front()), 3, m_frame_light_colors.size(), GL_STREAM_DRAW);
-				m_buffer_light_shadows.set_data(GL_ARRAY_BUFFER, m_frame_light_shadows.data(), 1, m_frame_light_shadows.size(), GL_STREAM_DRAW);
+				m_buffer_light_directions.commit();
+				m_buffer_light_colors.commit();
+				m_buffer_light_shadows.commit();
 
-				m_frame_light_directions.clear();
-				m_frame_light_colors.clear();
-				m_frame_light_shadows.clear();
+				m_vertex_array.set_array_buffer(m_in_LightDirection, m_buffer_light_directions, 1);
+				m_vertex_array.set_array_buffer(m_in_LightColor, m_buffer_light_colors, 1);
+				m_vertex_array.set_array_buffer(m_in_LightShadows, m_buffer_light_shadows, 1);
 			}
 
 			// render
@@ -256,95 +261,162 @@ namespace bump
 			}
 		}
 
-		lighting_system::point_light_renderable::point_light_renderable(entt::registry& registry, gl::shader_program const& shader, mbp_model const& model):
+		lighting_system::point_light_renderable::point_light_renderable(entt::registry& registry, gl::shader_program const& shader):
 			m_registry(registry),
 			m_shader(shader),
 			m_in_VertexPosition(m_shader.get_attribute_location("in_VertexPosition")),
-			m_in_LightPosition(m_shader.get_attribute_location("in_LightPosition")),
-			m_in_LightPosition_vs(m_shader.get_attribute_location("in_LightPosition_vs")),
-			m_in_LightColor(m_shader.get_attribute_location("in_LightColor")),
-			m_in_LightRadius(m_shader.get_attribute_location("in_LightRadius")),
 			m_u_MVP(m_shader.get_uniform_location("u_MVP")),
+			m_u_Size(m_shader.get_uniform_location("u_Size")),
 			m_g_buffer_1(m_shader.get_uniform_location("g_buffer_1")),
 			m_g_buffer_2(m_shader.get_uniform_location("g_buffer_2")),
 			m_g_buffer_3(m_shader.get_uniform_location("g_buffer_3")),
-			m_u_InvProjMatrix(m_shader.get_uniform_location("u_InvProjMatrix"))
+			m_u_InvProjMatrix(m_shader.get_uniform_location("u_InvProjMatrix")),
+			m_u_ClusterGridSize(m_shader.get_uniform_location("u_ClusterGridSize")),
+			m_u_ClusterDepthScale(m_shader.get_uniform_location("u_ClusterDepthScale")),
+			m_u_ClusterDepthBias(m_shader.get_uniform_location("u_ClusterDepthBias")),
+			m_u_ClusterRanges(m_shader.get_uniform_location("u_ClusterRanges")),
+			m_u_LightIndices(m_shader.get_uniform_location("u_LightIndices")),
+			m_u_LightPositions(m_shader.get_uniform_location("u_LightPositions")),
+			m_u_LightColors(m_shader.get_uniform_location("u_LightColors"))
 		{
-			die_if(model.m_submeshes.size() != 1);
-			auto const& mesh = model.m_submeshes.front().m_mesh;
-
-			die_if(mesh.m_vertices.empty());
-			m_buffer_vertices.set_data(GL_ARRAY_BUFFER, mesh.m_vertices.data(), 3, mesh.m_vertices.size() / 3, GL_STATIC_DRAW);
+			auto vertices = { 0.f, 0.f,  1.f, 0.f,  1.f, 1.f,  0.f, 0.f,  1.f, 1.f,  0.f, 1.f, };
+			m_buffer_vertices.set_data(GL_ARRAY_BUFFER, vertices.begin(), 2, 6, GL_STATIC_DRAW);
 			m_vertex_array.set_array_buffer(m_in_VertexPosition, m_buffer_vertices);
 
-			die_if(mesh.m_indices.empty());
-			m_buffer_indices.set_data(GL_ARRAY_BUFFER, mesh.m_indices.data(), 1, mesh.m_indices.size(), GL_STATIC_DRAW);
-			m_vertex_array.set_index_buffer(m_buffer_indices);
-
-			m_buffer_light_positions.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_LightPosition, m_buffer_light_positions, 1);
-			m_buffer_light_positions_vs.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_LightPosition_vs, m_buffer_light_positions_vs, 1);
-			m_buffer_light_colors.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_LightColor, m_buffer_light_colors, 1);
-			m_buffer_light_radii.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 1, 0, GL_STREAM_DRAW);
-			m_vertex_array.set_array_buffer(m_in_LightRadius, m_buffer_light_radii, 1);
+			// note: the light and cluster buffers are uploaded each frame (see render())
 		}
 
-		void lighting_system::point_light_renderable::render(gl::renderer& renderer, camera_matrices const& scene_matrices, gbuffers const& gbuf)
+		void lighting_system::point_light_renderable::render(gl::renderer& renderer, glm::vec2 screen_size, camera_matrices const& scene_matrices, camera_matrices const& ui_matrices, gbuffers const& gbuf)
 		{
-			// get instance data
+			// get light data
 			{
-				auto view = m_registry.view<point_light>();
-				if (view.empty()) return;
+				gather_lights(screen_size, scene_matrices);
 
-				m_frame_light_positions.reserve(view.size());
-				m_frame_light_positions_vs.reserve(view.size());
-				m_frame_light_colors.reserve(view.size());
-				m_frame_light_radii.reserve(view.size());
+				if (m_frame_light_positions.empty())
+					return; // no lights, all the lights are inactive, or none can be seen
+			}
 
-				for (auto id : view)
-				{
-					auto const& l = view.get<point_light>(id);
-					m_frame_light_positions.push_back(l.m_position);
-					m_frame_light_positions_vs.push_back(glm::vec3(scene_matrices.m_view * glm::vec4(l.m_position, 1.0)));
-					m_frame_light_colors.push_back(l.m_color);
-					m_frame_light_radii.push_back(l.m_radius);
-				}
+			// assign lights to clusters
+			{
+				m_clusters.set_camera(scene_matrices);
+				m_clusters.assign_lights({ m_frame_positions.data(), m_frame_positions.size() }, { m_frame_radii.data(), m_frame_radii.size() });
 
-				m_buffer_light_positions.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_light_positions.front()), 3, m_frame_light_positions.size(), GL_STREAM_DRAW);
-				m_buffer_light_positions_vs.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_light_positions_vs.front()), 3, m_frame_light_positions_vs.size(), GL_STREAM_DRAW);
-				m_buffer_light_colors.set_data(GL_ARRAY_BUFFER, glm::value_ptr(m_frame_light_colors.front()), 3, m_frame_light_colors.size(), GL_STREAM_DRAW);
-				m_buffer_light_radii.set_data(GL_ARRAY_BUFFER, m_frame_light_radii.data(), 1, m_frame_light_radii.size(), GL_STREAM_DRAW);
+				if (m_clusters.get_light_indices().empty())
+					return; // no lights in view
+			}
 
-				m_frame_light_positions.clear();
-				m_frame_light_positions_vs.clear();
-				m_frame_light_colors.clear();
-				m_frame_light_radii.clear();
+			// upload (once per frame)
+			{
+				auto const ranges = m_clusters.get_cluster_ranges();
+				auto const indices = m_clusters.get_light_indices();
+
+				m_buffer_cluster_ranges.set_data(GL_TEXTURE_BUFFER, &ranges.data()->x, 2, ranges.size(), GL_STREAM_DRAW);
+				m_buffer_light_indices.set_data(GL_TEXTURE_BUFFER, indices.data(), 1, indices.size(), GL_STREAM_DRAW);
+				m_buffer_light_positions.set_data(GL_TEXTURE_BUFFER, &m_frame_light_positions.data()->x, 4, m_frame_light_positions.size(), GL_STREAM_DRAW);
+				m_buffer_light_colors.set_data(GL_TEXTURE_BUFFER, &m_frame_light_colors.data()->x, 4, m_frame_light_colors.size(), GL_STREAM_DRAW);
+
+				m_texture_cluster_ranges.set_buffer(m_buffer_cluster_ranges, GL_RG32UI);
+				m_texture_light_indices.set_buffer(m_buffer_light_indices, GL_R32UI);
+				m_texture_light_positions.set_buffer(m_buffer_light_positions, GL_RGBA32F);
+				m_texture_light_colors.set_buffer(m_buffer_light_colors, GL_RGBA32F);
 			}
 
 			// render
 			{
-				auto const& mvp = scene_matrices.m_view_projection; // note: not actually an mvp
+				auto const mvp = ui_matrices.model_view_projection_matrix(glm::mat4(1.f));
+				auto const grid_size = m_clusters.get_grid_size();
 
 				renderer.set_program(m_shader);
 				renderer.set_uniform_4x4f(m_u_MVP, mvp);
+				renderer.set_uniform_2f(m_u_Size, screen_size);
 				renderer.set_uniform_1i(m_g_buffer_1, 0);
 				renderer.set_uniform_1i(m_g_buffer_2, 1);
 				renderer.set_uniform_1i(m_g_buffer_3, 2);
+				renderer.set_uniform_1i(m_u_ClusterRanges, 3);
+				renderer.set_uniform_1i(m_u_LightIndices, 4);
+				renderer.set_uniform_1i(m_u_LightPositions, 5);
+				renderer.set_uniform_1i(m_u_LightColors, 6);
 				renderer.set_texture_2d(0, gbuf.m_buffer_1);
 				renderer.set_texture_2d(1, gbuf.m_buffer_2);
 				renderer.set_texture_2d(2, gbuf.m_buffer_3);
+				renderer.set_texture_buffer(3, m_texture_cluster_ranges);
+				renderer.set_texture_buffer(4, m_texture_light_indices);
+				renderer.set_texture_buffer(5, m_texture_light_positions);
+				renderer.set_texture_buffer(6, m_texture_light_colors);
 				renderer.set_uniform_4x4f(m_u_InvProjMatrix, scene_matrices.m_inv_projection);
+				renderer.set_uniform_3u(m_u_ClusterGridSize, glm::u32vec3(grid_size));
+				renderer.set_uniform_1f(m_u_ClusterDepthScale, m_clusters.get_depth_slice_scale());
+				renderer.set_uniform_1f(m_u_ClusterDepthBias, m_clusters.get_depth_slice_bias());
 				renderer.set_vertex_array(m_vertex_array);
 
-				renderer.draw_indexed(GL_TRIANGLES, m_buffer_indices.get_element_count(), m_buffer_indices.get_component_type(), m_buffer_light_positions.get_element_count());
+				renderer.draw_arrays(GL_TRIANGLES, m_buffer_vertices.get_element_count());
 
 				renderer.clear_vertex_array();
+				renderer.clear_texture_buffer(6);
+				renderer.clear_texture_buffer(5);
+				renderer.clear_texture_buffer(4);
+				renderer.clear_texture_buffer(3);
+				renderer.clear_texture_2d(2);
+				renderer.clear_texture_2d(1);
+				renderer.clear_texture_2d(0);
 				renderer.clear_program();
 			}
 		}
 
+		void lighting_system::point_light_renderable::gather_lights(glm::vec2 screen_size, camera_matrices const& scene_matrices)
+		{
+			ZoneScopedN("point_light_renderable::gather_lights()");
+
+			m_stats = point_light_stats();
+
+			m_frame_positions.clear();
+			m_frame_radii.clear();
+			m_frame_light_positions.clear();
+			m_frame_light_colors.clear();
+
+			auto const view_frustum = frustum(scene_matrices.m_view_projection);
+			auto const px_per_unit = scene_matrices.m_projection[1][1] * screen_size.y * 0.5f; // screen size of 1 unit at a depth of 1 (perspective projection)
+
+			auto view = m_registry.view<point_light>(entt::exclude<inactive_tag>);
+
+			for (auto id : view)
+			{
+				auto const& l = view.get<point_light>(id);
+
+				// attenuation is 1 / d^2, so the light is too dim to see past sqrt(intensity / min intensity)
+				auto const intensity = glm::max(l.m_color.x, glm::max(l.m_color.y, l.m_color.z));
+				auto const radius = std::min(l.m_radius, std::sqrt(std::max(intensity, 0.f) / point_light_min_intensity));
+
+				if (radius <= 0.f)
+				{
+					++m_stats.m_culled_intensity;
+					continue;
+				}
+
+				if (!view_frustum.is_sphere_visible(l.m_position, radius))
+				{
+					++m_stats.m_culled_frustum;
+					continue;
+				}
+
+				auto const position_vs = glm::vec3(scene_matrices.m_view * glm::vec4(l.m_position, 1.f));
+				auto const depth = -position_vs.z;
+
+				if (depth > radius && (2.f * radius * px_per_unit / depth) < point_light_min_size_px) // note: the camera can't be inside the sphere
+				{
+					++m_stats.m_culled_size;
+					continue;
+				}
+
+				++m_stats.m_visible;
+
+				m_frame_positions.push_back(position_vs);
+				m_frame_radii.push_back(radius);
+				m_frame_light_positions.push_back(glm::vec4(position_vs, radius));
+				m_frame_light_colors.push_back(glm::vec4(l.m_color, 0.f));
+			}
+		}
+
 		lighting_system::emissive_renderable::emissive_renderable(entt::registry& registry, gl::shader_program const& shader):
 			m_registry(registry),
 			m_shader(shader),
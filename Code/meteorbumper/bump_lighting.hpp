@@ -2,17 +2,18 @@
 
 #include "bump_camera.hpp"
 #include "bump_gl.hpp"
+#include "bump_lighting_clusters.hpp"
 
 #include <entt.hpp>
 
 #include <glm/glm.hpp>
 #include <glm/gtx/std_based_type.hpp>
 
+#include <vector>
+
 namespace bump
 {
 
-	struct mbp_model;
-
 	namespace lighting
 	{
 	
@@ -96,10 +97,23 @@ namespace bump
 		{
 		public:
 
-			explicit lighting_system(entt::registry& registry, gl::shader_program const& directional_light_shader, gl::shader_program const& point_light_shader, mbp_model const& point_light_model, gl::shader_program const& emissive_shader);
+			explicit lighting_system(entt::registry& registry, gl::shader_program const& directional_light_shader, gl::shader_program const& point_light_shader, gl::shader_program const& emissive_shader);
 
 			void render(gl::renderer& renderer, glm::vec2 screen_size, camera_matrices const& light_matrices, camera_matrices const& scene_matrices, camera_matrices const& ui_matrices, gbuffers const& gbuf, gl::texture_2d const& shadow_map);
 
+			// point lights culled before clustering in the last render()
+			struct point_light_stats
+			{
+				std::size_t m_visible = 0;
+				std::size_t m_culled_frustum = 0; // sphere outside the view frustum
+				std::size_t m_culled_size = 0; // sphere smaller than the minimum size on screen
+				std::size_t m_culled_intensity = 0; // too dim to see at any distance
+
+				std::size_t get_culled() const { return m_culled_frustum + m_culled_size + m_culled_intensity; }
+			};
+
+			point_light_stats const& get_point_light_stats() const { return m_renderable_point.get_stats(); }
+
 		private:
 
 			entt::registry& m_registry;
@@ -130,52 +144,67 @@ namespace bump
 				GLint m_u_InvProjMatrix;
 
 				gl::buffer m_buffer_vertices;
-				gl::buffer m_buffer_light_directions;
-				gl::buffer m_buffer_light_colors;
-				gl::buffer m_buffer_light_shadows;
+				gl::stream_buffer m_buffer_light_directions;
+				gl::stream_buffer m_buffer_light_colors;
+				gl::stream_buffer m_buffer_light_shadows;
 				gl::vertex_array m_vertex_array;
-
-				std::vector<glm::vec3> m_frame_light_directions;
-				std::vector<glm::vec3> m_frame_light_colors;
-				std::vector<float> m_frame_light_shadows;
 			};
 
+			// point lights are assigned to view space clusters on the cpu (see light_clusters), and drawn in one full screen pass.
+			// each pixel only shades the lights in its cluster. the light data and cluster lists are read from buffer textures.
 			struct point_light_renderable
 			{
 			public:
 
-				explicit point_light_renderable(entt::registry& registry, gl::shader_program const& shader, mbp_model const& model);
+				explicit point_light_renderable(entt::registry& registry, gl::shader_program const& shader);
+
+				void render(gl::renderer& renderer, glm::vec2 screen_size, camera_matrices const& scene_matrices, camera_matrices const& ui_matrices, gbuffers const& gbuf);
 
-				void render(gl::renderer& renderer, camera_matrices const& scene_matrices, gbuffers const& gbuf);
+				point_light_stats const& get_stats() const { return m_stats; }
 
 			private:
 
+				// culls lights that can't be seen, and adds the rest to the frame data
+				void gather_lights(glm::vec2 screen_size, camera_matrices const& scene_matrices);
+
 				entt::registry& m_registry;
 
+				point_light_stats m_stats;
+
 				gl::shader_program const& m_shader;
 				GLint m_in_VertexPosition;
-				GLint m_in_LightPosition;
-				GLint m_in_LightPosition_vs;
-				GLint m_in_LightColor;
-				GLint m_in_LightRadius;
 				GLint m_u_MVP;
+				GLint m_u_Size;
 				GLint m_g_buffer_1;
 				GLint m_g_buffer_2;
 				GLint m_g_buffer_3;
 				GLint m_u_InvProjMatrix;
-
-				gl::buffer m_buffer_vertices;
-				gl::buffer m_buffer_indices;
+				GLint m_u_ClusterGridSize;
+				GLint m_u_ClusterDepthScale;
+				GLint m_u_ClusterDepthBias;
+				GLint m_u_ClusterRanges;
+				GLint m_u_LightIndices;
+				GLint m_u_LightPositions;
+				GLint m_u_LightColors;
+
+				light_clusters m_clusters;
+
+				std::vector<glm::vec3> m_frame_positions; // view space
+				std::vector<float> m_frame_radii;
+				std::vector<glm::vec4> m_frame_light_positions; // view space position, radius
+				std::vector<glm::vec4> m_frame_light_colors;
+
+				gl::buffer m_buffer_cluster_ranges;
+				gl::buffer m_buffer_light_indices;
 				gl::buffer m_buffer_light_positions;
-				gl::buffer m_buffer_light_positions_vs;
 				gl::buffer m_buffer_light_colors;
-				gl::buffer m_buffer_light_radii;
-				gl::vertex_array m_vertex_array;
+				gl::texture_buffer m_texture_cluster_ranges;
+				gl::texture_buffer m_texture_light_indices;
+				gl::texture_buffer m_texture_light_positions;
+				gl::texture_buffer m_texture_light_colors;
 
-				std::vector<glm::vec3> m_frame_light_positions;
-				std::vector<glm::vec3> m_frame_light_positions_vs;
-				std::vector<glm::vec3> m_frame_light_colors;
-				std::vector<float> m_frame_light_radii;
+				gl::buffer m_buffer_vertices;
+				gl::vertex_array m_vertex_array;
 			};
 
 			// ... spot lights
@@ -0,0 +1,212 @@
+#include "bump_lighting_clusters.hpp"
+
+#include "bump_camera.hpp"
+#include "bump_die.hpp"
+#include "bump_narrow_cast.hpp"
+
+#include <Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace bump
+{
+
+	namespace lighting
+	{
+
+		light_clusters::light_clusters(glm::size3 grid_size):
+			m_grid_size(grid_size),
+			m_projection(0.f),
+			m_inv_projection(0.f),
+			m_z_near(0.f),
+			m_z_far(0.f),
+			m_depth_slice_scale(0.f),
+			m_depth_slice_bias(0.f)
+		{
+			die_if(m_grid_size.x == 0 || m_grid_size.y == 0 || m_grid_size.z == 0);
+
+			m_cluster_ranges.resize(get_cluster_count(), glm::u32vec2(0));
+		}
+
+		void light_clusters::set_camera(camera_matrices const& matrices)
+		{
+			if (matrices.m_projection == m_projection)
+				return;
+
+			m_projection = matrices.m_projection;
+			m_inv_projection = matrices.m_inv_projection;
+
+			// the near and far planes are where the ndc depth is -1 and 1
+			auto const unproject_depth = [&] (float ndc_z) { auto const p = m_inv_projection * glm::vec4(0.f, 0.f, ndc_z, 1.f); return -p.z / p.w; };
+
+			m_z_near = unproject_depth(-1.f);
+			m_z_far = unproject_depth(1.f);
+			die_if(m_z_near <= 0.f || m_z_far <= m_z_near);
+
+			auto const slice_count = float(m_grid_size.z);
+			auto const log_ratio = std::log(m_z_far / m_z_near);
+
+			m_depth_slice_scale = slice_count / log_ratio;
+			m_depth_slice_bias = -slice_count * std::log(m_z_near) / log_ratio;
+
+			create_bounds();
+		}
+
+		void light_clusters::assign_lights(span<glm::vec3 const> positions, span<float const> radii)
+		{
+			ZoneScopedN("light_clusters::assign_lights()");
+
+			die_if(positions.size() != radii.size());
+			die_if(m_min_x.empty()); // call set_camera() first!
+
+			auto const tile_count = m_grid_size.x * m_grid_size.y;
+
+			m_frame_slice_hits.resize(tile_count);
+			m_frame_hits.clear();
+
+			// find the clusters each light touches
+			for (auto l = std::size_t{ 0 }; l != positions.size(); ++l)
+			{
+				auto const p = positions.data()[l];
+				auto const r = radii.data()[l];
+				auto const r2 = r * r;
+
+				auto const depth = -p.z;
+
+				if (depth + r < m_z_near || depth - r > m_z_far)
+					continue;
+
+				auto const first_slice = get_depth_slice(depth - r);
+				auto const last_slice = get_depth_slice(depth + r) + 1;
+
+				for (auto s = first_slice; s != last_slice; ++s)
+				{
+					auto const first = s * tile_count;
+
+					// sphere vs. box (squared distance from the center to the box). laid out so the compiler can vectorize it.
+					auto const min_x = m_min_x.data() + first, min_y = m_min_y.data() + first, min_z = m_min_z.data() + first;
+					auto const max_x = m_max_x.data() + first, max_y = m_max_y.data() + first, max_z = m_max_z.data() + first;
+					auto const hits = m_frame_slice_hits.data();
+
+					for (auto c = std::size_t{ 0 }; c != tile_count; ++c)
+					{
+						auto const dx = std::max(0.f, std::max(min_x[c] - p.x, p.x - max_x[c]));
+						auto const dy = std::max(0.f, std::max(min_y[c] - p.y, p.y - max_y[c]));
+						auto const dz = std::max(0.f, std::max(min_z[c] - p.z, p.z - max_z[c]));
+
+						hits[c] = std::uint32_t(dx * dx + dy * dy + dz * dz <= r2);
+					}
+
+					for (auto c = std::size_t{ 0 }; c != tile_count; ++c)
+						if (hits[c])
+							m_frame_hits.push_back({ narrow_cast<std::uint32_t>(first + c), narrow_cast<std::uint32_t>(l) });
+				}
+			}
+
+			// count the lights in each cluster, then lay out the index list (counting sort by cluster)
+			std::fill(m_cluster_ranges.begin(), m_cluster_ranges.end(), glm::u32vec2(0));
+
+			for (auto const& h : m_frame_hits)
+				m_cluster_ranges[h.m_cluster].y += 1;
+
+			auto offset = std::uint32_t{ 0 };
+
+			for (auto& range : m_cluster_ranges)
+			{
+				range.x = offset;
+				offset += range.y;
+				range.y = 0; // used as a cursor below
+			}
+
+			m_light_indices.resize(m_frame_hits.size());
+
+			for (auto const& h : m_frame_hits)
+			{
+				auto& range = m_cluster_ranges[h.m_cluster];
+				m_light_indices[range.x + range.y] = h.m_light;
+				range.y += 1;
+			}
+		}
+
+		void light_clusters::create_bounds()
+		{
+			ZoneScopedN("light_clusters::create_bounds()");
+
+			auto const cluster_count = get_cluster_count();
+
+			m_min_x.resize(cluster_count);
+			m_min_y.resize(cluster_count);
+			m_min_z.resize(cluster_count);
+			m_max_x.resize(cluster_count);
+			m_max_y.resize(cluster_count);
+			m_max_z.resize(cluster_count);
+
+			// point on the near plane for the given ndc x and y
+			auto const unproject = [&] (float ndc_x, float ndc_y)
+			{
+				auto const p = m_inv_projection * glm::vec4(ndc_x, ndc_y, -1.f, 1.f);
+				return glm::vec3(p) / p.w;
+			};
+
+			auto const tile_size = glm::vec2(2.f) / glm::vec2(m_grid_size.x, m_grid_size.y);
+
+			for (auto z = std::size_t{ 0 }; z != m_grid_size.z; ++z)
+			{
+				auto const slice_near = m_z_near * std::pow(m_z_far / m_z_near, float(z) / float(m_grid_size.z));
+				auto const slice_far = m_z_near * std::pow(m_z_far / m_z_near, float(z + 1) / float(m_grid_size.z));
+
+				for (auto y = std::size_t{ 0 }; y != m_grid_size.y; ++y)
+				{
+					for (auto x = std::size_t{ 0 }; x != m_grid_size.x; ++x)
+					{
+						auto const ndc_min = glm::vec2(-1.f) + tile_size * glm::vec2(x, y);
+						auto const ndc_max = ndc_min + tile_size;
+
+						auto const corners =
+						{
+							unproject(ndc_min.x, ndc_min.y),
+							unproject(ndc_max.x, ndc_min.y),
+							unproject(ndc_min.x, ndc_max.y),
+							unproject(ndc_max.x, ndc_max.y),
+						};
+
+						// the tile's edges are rays from the camera, so scale the near plane corners out to the slice depths
+						auto min = glm::vec3(std::numeric_limits<float>::max());
+						auto max = glm::vec3(std::numeric_limits<float>::lowest());
+
+						for (auto const& c : corners)
+						{
+							for (auto d : { slice_near, slice_far })
+							{
+								auto const p = c * (d / m_z_near);
+								min = glm::min(min, p);
+								max = glm::max(max, p);
+							}
+						}
+
+						auto const i = x + m_grid_size.x * (y + m_grid_size.y * z);
+
+						m_min_x[i] = min.x;
+						m_min_y[i] = min.y;
+						m_min_z[i] = min.z;
+						m_max_x[i] = max.x;
+						m_max_y[i] = max.y;
+						m_max_z[i] = max.z;
+					}
+				}
+			}
+		}
+
+		std::size_t light_clusters::get_depth_slice(float depth) const
+		{
+			auto const d = std::max(depth, m_z_near);
+			auto const slice = std::floor(std::log(d) * m_depth_slice_scale + m_depth_slice_bias);
+
+			return std::min(std::size_t(std::max(slice, 0.f)), m_grid_size.z - 1);
+		}
+
+	} // lighting
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "bump_span.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtx/std_based_type.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace bump
+{
+
+	class camera_matrices;
+
+	namespace lighting
+	{
+
+		// assigns point lights to a grid of view space clusters (screen tiles, split into depth slices).
+		// depth slices are spaced exponentially, so clusters further from the camera are bigger.
+		// the result is a compact list of light indices, with an offset and count into it for each cluster.
+		//
+		// note: doesn't touch gl, so the binning can be tested and timed without a gpu.
+		class light_clusters
+		{
+		public:
+
+			explicit light_clusters(glm::size3 grid_size = { 16, 9, 24 });
+
+			// rebuilds the cluster bounds if the projection has changed (assumes a perspective projection).
+			void set_camera(camera_matrices const& matrices);
+
+			// light positions are in view space.
+			void assign_lights(span<glm::vec3 const> positions, span<float const> radii);
+
+			glm::size3 get_grid_size() const { return m_grid_size; }
+			std::size_t get_cluster_count() const { return m_grid_size.x * m_grid_size.y * m_grid_size.z; }
+
+			// the depth slice of a point at view depth d (i.e. -z) is floor(log(d) * scale + bias)
+			float get_depth_slice_scale() const { return m_depth_slice_scale; }
+			float get_depth_slice_bias() const { return m_depth_slice_bias; }
+
+			// clusters are ordered by x, then y, then z (x changes fastest).
+			// each range is an offset and count in the light index list.
+			span<glm::u32vec2 const> get_cluster_ranges() const { return { m_cluster_ranges.data(), m_cluster_ranges.size() }; }
+			span<std::uint32_t const> get_light_indices() const { return { m_light_indices.data(), m_light_indices.size() }; }
+
+		private:
+
+			void create_bounds();
+			std::size_t get_depth_slice(float depth) const; // clamped to the grid
+
+			glm::size3 m_grid_size;
+
+			glm::mat4 m_projection;
+			glm::mat4 m_inv_projection;
+			float m_z_near;
+			float m_z_far;
+			float m_depth_slice_scale;
+			float m_depth_slice_bias;
+
+			// view space bounding boxes of the clusters (components stored separately for batch testing)
+			std::vector<float> m_min_x, m_min_y, m_min_z, m_max_x, m_max_y, m_max_z;
+
+			struct light_hit
+			{
+				std::uint32_t m_cluster;
+				std::uint32_t m_light;
+			};
+
+			std::vector<std::uint32_t> m_frame_slice_hits; // scratch (one per cluster in a slice)
+			std::vector<light_hit> m_frame_hits;
+
+			std::vector<glm::u32vec2> m_cluster_ranges;
+			std::vector<std::uint32_t> m_light_indices;
+		};
+
+	} // lighting
+
+} // bump
\ No newline at end of file
@@ -6,6 +6,8 @@
 
 #include <json.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 
 namespace bump
@@ -108,5 +110,20 @@ namespace bump
 		die();
 		return {};
 	}
+
+	float get_bounding_radius(mbp_model const& model)
+	{
+		auto radius_sq = 0.f;
+
+		for (auto const& s : model.m_submeshes)
+		{
+			auto const& v = s.m_mesh.m_vertices;
+
+			for (auto i = std::size_t{ 0 }; i + 2 < v.size(); i += 3)
+				radius_sq = std::max(radius_sq, v[i] * v[i] + v[i + 1] * v[i + 1] + v[i + 2] * v[i + 2]);
+		}
+
+		return std::sqrt(radius_sq);
+	}
 	
 } // bump
\ No newline at end of file
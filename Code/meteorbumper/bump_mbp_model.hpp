@@ -43,5 +43,8 @@ namespace bump
 	};
 
 	mbp_model load_mbp_model_json(std::string const& filename);
+
+	// radius of a sphere at the model origin containing all the (untransformed) vertices
+	float get_bounding_radius(mbp_model const& model);
 	
 } // bump
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace bump
+{
+
+	// spread the low 10 bits of x out, with two zero bits between each
+	inline std::uint32_t morton_spread_bits_3d(std::uint32_t x)
+	{
+		x &= 0x000003ffu;
+		x = (x | (x << 16u)) & 0x030000ffu;
+		x = (x | (x <<  8u)) & 0x0300f00fu;
+		x = (x | (x <<  4u)) & 0x030c30c3u;
+		x = (x | (x <<  2u)) & 0x09249249u;
+		return x;
+	}
+
+	// interleave the low 10 bits of each component (x in the lowest bit)
+	inline std::uint32_t morton_encode_3d(glm::uvec3 cell)
+	{
+		return morton_spread_bits_3d(cell.x) | (morton_spread_bits_3d(cell.y) << 1u) | (morton_spread_bits_3d(cell.z) << 2u);
+	}
+
+	// quantize a position to a 1024^3 grid of cells (starting at origin) and interleave the cell coordinates
+	inline std::uint32_t morton_encode_3d(glm::vec3 position, glm::vec3 origin, float cell_size)
+	{
+		auto const cell = glm::clamp(glm::floor((position - origin) / cell_size), glm::vec3(0.f), glm::vec3(1023.f));
+		return morton_encode_3d(glm::uvec3(cell));
+	}
+
+} // bump
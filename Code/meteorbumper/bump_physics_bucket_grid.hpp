@@ -105,6 +105,45 @@ namespace bump
 				}
 			}
 
+			// calls f(id) for each entity in the buckets overlapping the box.
+			// note: the same entity may be visited more than once (it may span several buckets).
+			template<class F>
+			void query_box(aabb const& box, F&& f) const
+			{
+				if (m_buckets.empty())
+					return;
+
+				auto const bucket_count = glm::ivec3(m_bucket_count);
+
+				auto min_cell = glm::ivec3(box.min / m_cell_size);
+				auto max_cell = glm::ivec3(box.max / m_cell_size) + 1;
+				max_cell = glm::min(max_cell, min_cell + bucket_count); // the grid wraps, so don't visit the same bucket twice
+
+				for (auto z = min_cell.z; z != max_cell.z; ++z)
+				{
+					for (auto y = min_cell.y; y != max_cell.y; ++y)
+					{
+						for (auto x = min_cell.x; x != max_cell.x; ++x)
+						{
+							auto const i = mod(glm::ivec3{ x, y, z }, bucket_count);
+							auto const bucket_index = std::size_t(i.x + i.y * m_bucket_count.x + i.z * m_bucket_count.x * m_bucket_count.y);
+							die_if(bucket_index >= m_buckets.size());
+
+							for (auto e : m_buckets[bucket_index])
+								f(e);
+						}
+					}
+				}
+			}
+
+			// true if a box of the given half extents covers every bucket in the grid.
+			bool covers_grid(glm::vec3 half_extents) const
+			{
+				return glm::all(glm::greaterThanEqual(half_extents * 2.f, m_grid_size));
+			}
+
+			glm::vec3 get_cell_size() const { return m_cell_size; }
+
 			void clear()
 			{
 				m_buckets.clear();
@@ -84,7 +84,7 @@ namespace bump
 			shape_type m_shape;
 			std::uint32_t m_layer;      // bitmask of layers this object is on
 			std::uint32_t m_layer_mask; // bitmask of layers this object collides with
-			callback_type m_callback;   // note: callback must not do anything to invalidate this collider (e.g. spawn entities with colliders).
+			callback_type m_callback;   // note: callback must not do anything to invalidate this collider (e.g. spawn entities with colliders). record those changes in an entity_command_buffer instead.
 		};
 
 		aabb dispatch_get_aabb(rigidbody const& p, collider const& c);
@@ -1,11 +1,12 @@
 #include "bump_physics_system.hpp"
 
+#include "bump_entity_pool.hpp"
 #include "bump_game_asteroids.hpp"
 #include "bump_game_bounds.hpp"
-#include "bump_game_particle_effect.hpp"
 #include "bump_game_player.hpp"
 #include "bump_game_powerups.hpp"
 #include "bump_log.hpp"
+#include "bump_morton.hpp"
 #include "bump_physics_collider.hpp"
 #include "bump_physics_rigidbody.hpp"
 
@@ -15,8 +16,13 @@
 
 #include <Tracy.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace bump
@@ -25,12 +31,48 @@ namespace bump
 	namespace physics
 	{
 
+		namespace
+		{
+
+			float get_query_radius(collider const& c)
+			{
+				auto const shape = c.get_shape();
+
+				if (auto sphere = std::get_if<sphere_shape>(&shape))
+					return sphere->m_radius;
+
+				return 0.f;
+			}
+
+			aabb get_query_box(glm::vec3 center, float radius)
+			{
+				return { center - glm::vec3(radius), center + glm::vec3(radius) };
+			}
+
+			void sort_unique(std::vector<entt::entity>& ids)
+			{
+				std::sort(ids.begin(), ids.end());
+				ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+			}
+
+			std::size_t get_entity_index(entt::entity id)
+			{
+				return std::size_t(entt::to_integral(id) & entt::entt_traits<entt::entity>::entity_mask);
+			}
+
+		} // unnamed
+
 		physics_system::physics_system(entt::registry& registry, high_res_duration_t update_time):
 			m_registry(registry),
+			m_rigidbodies(registry.group<rigidbody>(entt::exclude<inactive_tag>)),
 			m_update_time(update_time),
 			m_accumulator(0),
+			m_spatial_sort_period(high_res_duration_from_seconds(0.5f)),
+			m_spatial_sort_accumulator(0),
+			m_spatial_sort_origin(-512.f), // 1024^3 cells of 1m covers the play area
+			m_spatial_sort_cell_size(1.f),
 			m_bucket_grid_asteroids(glm::vec3(60.f), glm::size3{ 10, 1, 10 }),
-			m_bucket_grid_particles(glm::vec3(2.f), glm::size3{ 50, 4, 50 })
+			m_bucket_grid_powerups(glm::vec3(60.f), glm::size3{ 10, 1, 10 })
 		{ }
 
 		void physics_system::update(high_res_duration_t dt)
@@ -41,6 +83,13 @@ namespace bump
 
 			while (m_accumulator >= m_update_time)
 			{
+				m_spatial_sort_accumulator += m_update_time;
+
+				if (m_spatial_sort_accumulator >= m_spatial_sort_period)
+				{
+					spatial_sort();
+					m_spatial_sort_accumulator = high_res_duration_t{ 0 };
+				}
 
 				// check for collisions
 				auto colliders = m_registry.view<rigidbody, collider>();
@@ -53,17 +102,16 @@ namespace bump
 
 						auto bounds_view = m_registry.view<rigidbody, collider, game::bounds_tag>();
 						auto player_view = m_registry.view<rigidbody, collider, game::player_tag>();
-						auto lasers_view = m_registry.view<rigidbody, collider, game::player_lasers::beam_segment>();
-						auto asteroids_view = m_registry.view<rigidbody, collider, game::asteroid_field::asteroid_data>();
-						auto particles_view = m_registry.view<rigidbody, collider, game::particle_effect::particle_data>();
+						auto lasers_view = m_registry.view<rigidbody, collider, game::player_lasers::beam_segment>(entt::exclude<inactive_tag>);
+						auto asteroids_view = game::asteroid_field::get_asteroid_group(m_registry);
 						auto powerups_view = m_registry.view<rigidbody, collider, game::powerups::powerup_data>();
 
 						m_bucket_grid_asteroids.create(asteroids_view);
-						m_bucket_grid_particles.create(particles_view);
+						m_bucket_grid_powerups.create(powerups_view);
 
 						// player -> bounds, powerups, asteroids
 						m_frame_candidate_pairs.emplace_back(bounds_view.front(), player_view.front());
-						for (auto id : powerups_view) m_frame_candidate_pairs.emplace_back(player_view.front(), id);
+						m_bucket_grid_powerups.get_collision_pairs(player_view, std::back_inserter(m_frame_candidate_pairs));
 						m_bucket_grid_asteroids.get_collision_pairs(player_view, std::back_inserter(m_frame_candidate_pairs));
 
 						// lasers -> asteroids
@@ -72,11 +120,6 @@ namespace bump
 						// asteroids -> bounds, asteroids
 						for (auto id : asteroids_view) m_frame_candidate_pairs.emplace_back(bounds_view.front(), id);
 						m_bucket_grid_asteroids.get_collision_pairs(asteroids_view, std::back_inserter(m_frame_candidate_pairs));
-						
-						// particles -> player, asteroids, powerups
-						m_bucket_grid_particles.get_collision_pairs(player_view, std::back_inserter(m_frame_candidate_pairs));
-						m_bucket_grid_particles.get_collision_pairs(asteroids_view, std::back_inserter(m_frame_candidate_pairs));
-						m_bucket_grid_particles.get_collision_pairs(powerups_view, std::back_inserter(m_frame_candidate_pairs));
 					}
 
 					{
@@ -140,10 +183,7 @@ namespace bump
 					ZoneScopedN("physics_system::update() - update rigidbodies");
 
 					// update physics components
-					auto view = m_registry.view<rigidbody>();
-					
-					for (auto id : view)
-						view.get<rigidbody>(id).update(m_update_time);
+					m_rigidbodies.each([&] (rigidbody& rb) { rb.update(m_update_time); });
 				}
 
 				m_accumulator -= m_update_time;
@@ -153,13 +193,247 @@ namespace bump
 				ZoneScopedN("physics_system::update() - clear forces");
 
 				// clear forces
-				auto view = m_registry.view<rigidbody>();
+				m_rigidbodies.each([] (rigidbody& rb)
+				{
+					rb.clear_force();
+					rb.clear_torque();
+				});
+			}
+		}
+
+
+		void physics_system::spatial_sort()
+		{
+			ZoneScopedN("physics_system::spatial_sort()");
+
+			// find each key once up front (indexed by entity), rather than twice per comparison
+			m_frame_sort_keys.resize(m_registry.size());
+
+			m_registry.view<rigidbody>().each([&] (entt::entity id, rigidbody const& rb)
+			{
+				m_frame_sort_keys[get_entity_index(id)] = morton_encode_3d(rb.get_position(), m_spatial_sort_origin, m_spatial_sort_cell_size);
+			});
+
+			auto const morton_order = [&] (entt::entity a, entt::entity b)
+			{
+				return m_frame_sort_keys[get_entity_index(a)] < m_frame_sort_keys[get_entity_index(b)];
+			};
+
+			// sort rigidbodies, and make the colliders follow the same order
+			m_rigidbodies.sort(morton_order);
+			m_registry.sort<collider, rigidbody>();
+
+			// asteroid data is owned by its own group, so sort that in the same order too
+			game::asteroid_field::get_asteroid_group(m_registry).sort(morton_order);
+		}
+
+		template<class F>
+		void physics_system::for_each_query_grid(std::uint32_t layer_mask, F&& f) const
+		{
+			if (layer_mask & collision_layers::ASTEROIDS) f(m_bucket_grid_asteroids);
+			if (layer_mask & collision_layers::POWERUPS) f(m_bucket_grid_powerups);
+		}
+
+		template<class F>
+		void physics_system::query_box(aabb const& box, std::uint32_t layer_mask, F&& f) const
+		{
+			for_each_query_grid(layer_mask, [&] (bucket_grid const& grid)
+			{
+				grid.query_box(box, [&] (entt::entity id)
+				{
+					// the grids are built during the physics update, so entities may have been destroyed since
+					if (!m_registry.valid(id) || m_registry.has<inactive_tag>(id))
+						return;
+
+					auto const rb = m_registry.try_get<rigidbody>(id);
+					auto const c = m_registry.try_get<collider>(id);
+
+					if (!rb || !c || (c->get_collision_layer() & layer_mask) == 0)
+						return;
+
+					f(id, *rb, *c);
+				});
+			});
+		}
+
+		std::vector<entt::entity> physics_system::overlap_sphere(glm::vec3 center, float radius, std::uint32_t layer_mask) const
+		{
+			ZoneScopedN("physics_system::overlap_sphere()");
+
+			auto result = std::vector<entt::entity>();
+
+			query_box(get_query_box(center, radius), layer_mask, [&] (entt::entity id, rigidbody const& rb, collider const& c)
+			{
+				if (glm::distance(center, rb.get_position()) <= radius + get_query_radius(c))
+					result.push_back(id);
+			});
+
+			sort_unique(result);
+
+			return result;
+		}
+
+		std::vector<entt::entity> physics_system::find_k_nearest(glm::vec3 point, std::size_t k, std::uint32_t layer_mask) const
+		{
+			ZoneScopedN("physics_system::find_k_nearest()");
+
+			auto result = std::vector<entt::entity>();
+
+			if (k == 0)
+				return result;
 
-				for (auto id : view)
+			// start searching one cell out from the point, and keep doubling the search radius
+			// until we have k entities inside it (or we've searched the whole of every grid).
+			auto radius = std::numeric_limits<float>::max();
+			for_each_query_grid(layer_mask, [&] (bucket_grid const& grid) { radius = std::min(radius, glm::compMin(grid.get_cell_size())); });
+
+			if (radius == std::numeric_limits<float>::max())
+				return result; // no grids to search
+
+			auto candidates = std::vector<std::pair<float, entt::entity>>();
+
+			while (true)
+			{
+				candidates.clear();
+
+				query_box(get_query_box(point, radius), layer_mask, [&] (entt::entity id, rigidbody const& rb, collider const&)
+				{
+					candidates.emplace_back(glm::distance(point, rb.get_position()), id);
+				});
+
+				std::sort(candidates.begin(), candidates.end());
+				candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+				auto covered = true;
+				for_each_query_grid(layer_mask, [&] (bucket_grid const& grid) { covered = covered && grid.covers_grid(glm::vec3(radius)); });
+
+				// only entities within the search radius are guaranteed to be closer than anything we haven't found
+				auto const inside = (std::size_t)std::count_if(candidates.begin(), candidates.end(),
+					[&] (std::pair<float, entt::entity> const& c) { return c.first <= radius; });
+
+				if (inside >= k || covered)
+					break;
+
+				radius *= 2.f;
+			}
+
+			auto const num = std::min(candidates.size(), k);
+			result.reserve(num);
+
+			for (auto i = std::size_t{ 0 }; i != num; ++i)
+				result.push_back(candidates[i].second);
+
+			return result;
+		}
+
+		std::optional<physics_system::raycast_hit> physics_system::raycast(glm::vec3 origin, glm::vec3 direction, float max_distance, std::uint32_t layer_mask) const
+		{
+			ZoneScopedN("physics_system::raycast()");
+
+			if (glm::length(direction) == 0.f || max_distance <= 0.f)
+				return { };
+
+			direction = glm::normalize(direction);
+
+			// walk along the ray in steps no bigger than a grid cell, checking the buckets under each step
+			auto step = std::numeric_limits<float>::max();
+			for_each_query_grid(layer_mask, [&] (bucket_grid const& grid) { step = std::min(step, glm::compMin(grid.get_cell_size())); });
+
+			if (step == std::numeric_limits<float>::max())
+				return { }; // no grids to search
+
+			auto result = std::optional<raycast_hit>();
+
+			for (auto start = 0.f; start < max_distance; start += step)
+			{
+				auto const end = std::min(start + step, max_distance);
+				auto const a = origin + direction * start;
+				auto const b = origin + direction * end;
+
+				query_box({ glm::min(a, b), glm::max(a, b) }, layer_mask, [&] (entt::entity id, rigidbody const& rb, collider const& c)
+				{
+					auto const r = get_query_radius(c);
+					auto const m = origin - rb.get_position();
+					auto const mb = glm::dot(m, direction);
+					auto const mc = glm::dot(m, m) - r * r;
+
+					if (mc > 0.f && mb > 0.f)
+						return; // outside the sphere and pointing away
+
+					auto const discriminant = mb * mb - mc;
+
+					if (discriminant < 0.f)
+						return; // missed
+
+					auto const t = std::max(-mb - std::sqrt(discriminant), 0.f); // 0 if the ray starts inside
+
+					if (t > max_distance || (result && result.value().m_distance <= t))
+						return;
+
+					auto const point = origin + direction * t;
+					auto const offset = point - rb.get_position();
+					auto const normal = glm::length(offset) == 0.f ? -direction : glm::normalize(offset);
+
+					result = raycast_hit{ id, point, normal, t };
+				});
+
+				// nothing further along the ray can be closer
+				if (result && result.value().m_distance <= end)
+					break;
+			}
+
+			return result;
+		}
+
+
+		void physics_system::collide_particles(span<glm::vec3> positions, span<glm::vec3> velocities, float radius, float restitution, std::uint32_t layer_mask) const
+		{
+			ZoneScopedN("physics_system::collide_particles()");
+
+			die_if(positions.size() != velocities.size());
+
+			auto const collide = [&] (glm::vec3& p, glm::vec3& v, rigidbody const& rb, collider const& c)
+			{
+				if ((c.get_collision_mask() & collision_layers::PARTICLES) == 0)
+					return;
+
+				auto const offset = p - rb.get_position();
+				auto const min_distance = get_query_radius(c) + radius;
+				auto const distance_sq = glm::dot(offset, offset);
+
+				if (distance_sq >= min_distance * min_distance)
+					return;
+
+				auto const distance = std::sqrt(distance_sq);
+				auto const normal = (distance == 0.f) ? glm::vec3(0.f, 1.f, 0.f) : offset / distance;
+
+				// reflect the relative velocity (if moving into the collider), and push the particle out to the surface
+				auto const vn = glm::dot(v - rb.get_velocity(), normal);
+
+				if (vn < 0.f)
+					v -= (1.f + std::min(restitution, c.get_restitution())) * vn * normal;
+
+				p = rb.get_position() + normal * min_distance;
+			};
+
+			auto player_view = m_registry.view<rigidbody, collider, game::player_tag>();
+
+			for (auto i = std::size_t{ 0 }; i != positions.size(); ++i)
+			{
+				auto& p = positions.at(i);
+				auto& v = velocities.at(i);
+
+				query_box(get_query_box(p, radius), layer_mask, [&] (entt::entity, rigidbody const& rb, collider const& c) { collide(p, v, rb, c); });
+
+				if (layer_mask & collision_layers::PLAYER)
 				{
-					auto& c = view.get<rigidbody>(id);
-					c.clear_force();
-					c.clear_torque();
+					for (auto id : player_view)
+					{
+						auto const& c = player_view.get<collider>(id);
+
+						if (c.get_collision_layer() & layer_mask)
+							collide(p, v, player_view.get<rigidbody>(id), c);
+					}
 				}
 			}
 		}
@@ -1,19 +1,26 @@
 #pragma once
 
+#include "bump_entity_pool.hpp"
+#include "bump_span.hpp"
 #include "bump_time.hpp"
 #include "bump_physics_bucket_grid.hpp"
 #include "bump_physics_collider.hpp"
+#include "bump_physics_rigidbody.hpp"
 
 #include <entt.hpp>
 
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
 namespace bump
 {
 	
 	namespace physics
 	{
 		
-		class rigidbody;
-	
 		class physics_system
 		{
 		public:
@@ -22,15 +29,53 @@ namespace bump
 
 			void update(high_res_duration_t dt);
 
+			// periodically sort the hot component pools by morton code of position (so iteration walks memory in spatial order).
+			void set_spatial_sort_period(high_res_duration_t period) { m_spatial_sort_period = period; }
+			high_res_duration_t get_spatial_sort_period() const { return m_spatial_sort_period; }
+
+			// spatial queries (answered from the broad phase grids):
+			// note: only asteroids and powerups are indexed, and the grids are rebuilt each physics step.
+
+			struct raycast_hit
+			{
+				entt::entity m_id;
+				glm::vec3 m_point;
+				glm::vec3 m_normal;
+				float m_distance;
+			};
+
+			std::vector<entt::entity> overlap_sphere(glm::vec3 center, float radius, std::uint32_t layer_mask) const;
+			std::vector<entt::entity> find_k_nearest(glm::vec3 point, std::size_t k, std::uint32_t layer_mask) const; // sorted closest first
+			std::optional<raycast_hit> raycast(glm::vec3 origin, glm::vec3 direction, float max_distance, std::uint32_t layer_mask) const;
+
+			// bounce a batch of particles (not entities) off the indexed colliders and the player.
+			// note: one-way - the particles are moved out of the other colliders, but the colliders aren't affected.
+			void collide_particles(span<glm::vec3> positions, span<glm::vec3> velocities, float radius, float restitution, std::uint32_t layer_mask) const;
+
 		private:
 
+			void spatial_sort();
+
+			template<class F>
+			void for_each_query_grid(std::uint32_t layer_mask, F&& f) const;
+
+			template<class F>
+			void query_box(aabb const& box, std::uint32_t layer_mask, F&& f) const;
+
 			entt::registry& m_registry;
 
+			entt::group<entt::exclude_t<inactive_tag>, entt::get_t<>, rigidbody> m_rigidbodies;
+
 			high_res_duration_t m_update_time;
 			high_res_duration_t m_accumulator;
 
+			high_res_duration_t m_spatial_sort_period;
+			high_res_duration_t m_spatial_sort_accumulator;
+			glm::vec3 m_spatial_sort_origin;
+			float m_spatial_sort_cell_size;
+
 			bucket_grid m_bucket_grid_asteroids;
-			bucket_grid m_bucket_grid_particles;
+			bucket_grid m_bucket_grid_powerups;
 
 			struct hit_data
 			{
@@ -41,6 +86,7 @@ namespace bump
 
 			std::vector<std::pair<entt::entity, entt::entity>> m_frame_candidate_pairs;
 			std::vector<hit_data> m_frame_collisions;
+			std::vector<std::uint32_t> m_frame_sort_keys; // morton codes, indexed by entity
 		};
 
 	} // physics
@@ -0,0 +1,54 @@
+#include "bump_radix_sort.hpp"
+
+#include "bump_die.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+
+namespace bump
+{
+	
+	void radix_sort_indices(span<std::uint32_t const> keys, std::vector<std::uint32_t>& indices, std::vector<std::uint32_t>& scratch, std::uint32_t key_bits)
+	{
+		die_if(key_bits == 0 || key_bits > 32u);
+
+		auto const count = keys.size();
+		die_if(count > std::numeric_limits<std::uint32_t>::max()); // indices must fit
+
+		indices.resize(count);
+		scratch.resize(count);
+		std::iota(indices.begin(), indices.end(), std::uint32_t{ 0 });
+
+		for (auto shift = 0u; shift < key_bits; shift += 8u)
+		{
+			auto offsets = std::array<std::size_t, 256>();
+			offsets.fill(0);
+
+			for (auto k : keys)
+				++offsets[(k >> shift) & 0xffu];
+
+			// every key has the same digit, so this pass wouldn't change anything
+			if (std::find(offsets.begin(), offsets.end(), count) != offsets.end())
+				continue;
+
+			auto total = std::size_t{ 0 };
+
+			for (auto& o : offsets)
+			{
+				auto const n = o;
+				o = total;
+				total += n;
+			}
+
+			auto const key_data = keys.data();
+
+			for (auto i : indices)
+				scratch[offsets[(key_data[i] >> shift) & 0xffu]++] = i;
+
+			indices.swap(scratch);
+		}
+	}
+	
+} // bump
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "bump_span.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace bump
+{
+
+	// map a float to an unsigned int with the same ordering (negative values flip all bits, positive values flip the sign bit)
+	inline std::uint32_t float_to_radix_key(float f)
+	{
+		auto u = std::uint32_t{ 0 };
+		std::memcpy(&u, &f, sizeof(u));
+		return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+	}
+
+	// fill indices with the order that sorts keys ascending (stable, least significant digit first, 8 bits per pass).
+	// only the low key_bits of each key are used (e.g. 8 for keys in [0, 255], so it's a single pass).
+	// scratch is working space (kept by the caller to avoid reallocating every time).
+	void radix_sort_indices(span<std::uint32_t const> keys, std::vector<std::uint32_t>& indices, std::vector<std::uint32_t>& scratch, std::uint32_t key_bits = 32u);
+	
+} // bump
\ No newline at end of file
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "bump_die.hpp"
+#include "bump_span.hpp"
 
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
 
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <map>
 #include <random>
 
@@ -13,6 +18,101 @@ namespace bump
 	namespace random
 	{
 
+		// small, fast generators (usable anywhere a std:: engine is, e.g. with std::uniform_real_distribution).
+		// not for anything security related!
+
+		// pcg32 (xsh-rr variant): 64 bits of state, 32 bit output.
+		class pcg32
+		{
+		public:
+
+			using result_type = std::uint32_t;
+
+			explicit pcg32(std::uint64_t seed = 0x853c49e6748fea9bull, std::uint64_t stream = 0xda3e39cb94b95bdbull):
+				m_state(0u),
+				m_increment((stream << 1u) | 1u)
+			{
+				(*this)();
+				m_state += seed;
+				(*this)();
+			}
+
+			static constexpr result_type min() { return 0u; }
+			static constexpr result_type max() { return 0xffffffffu; }
+
+			result_type operator()()
+			{
+				auto const old = m_state;
+				m_state = old * 6364136223846793005ull + m_increment;
+
+				auto const xorshifted = std::uint32_t(((old >> 18u) ^ old) >> 27u);
+				auto const rotation = std::uint32_t(old >> 59u);
+
+				return (xorshifted >> rotation) | (xorshifted << ((0u - rotation) & 31u));
+			}
+
+		private:
+
+			std::uint64_t m_state;
+			std::uint64_t m_increment;
+		};
+
+		// xoshiro256+: 256 bits of state, 64 bit output (the low bits are weak, but the high bits are fine for floats).
+		class xoshiro256plus
+		{
+		public:
+
+			using result_type = std::uint64_t;
+
+			explicit xoshiro256plus(std::uint64_t seed = 0x9e3779b97f4a7c15ull)
+			{
+				// fill the state with splitmix64 (so it's never all zeros)
+				for (auto& s : m_state)
+				{
+					seed += 0x9e3779b97f4a7c15ull;
+
+					auto z = seed;
+					z = (z ^ (z >> 30u)) * 0xbf58476d1ce4e5b9ull;
+					z = (z ^ (z >> 27u)) * 0x94d049bb133111ebull;
+					s = z ^ (z >> 31u);
+				}
+			}
+
+			static constexpr result_type min() { return 0u; }
+			static constexpr result_type max() { return 0xffffffffffffffffull; }
+
+			result_type operator()()
+			{
+				auto const result = m_state[0] + m_state[3];
+				auto const t = m_state[1] << 17u;
+
+				m_state[2] ^= m_state[0];
+				m_state[3] ^= m_state[1];
+				m_state[1] ^= m_state[2];
+				m_state[0] ^= m_state[3];
+
+				m_state[2] ^= t;
+				m_state[3] = (m_state[3] << 45u) | (m_state[3] >> 19u);
+
+				return result;
+			}
+
+		private:
+
+			std::array<std::uint64_t, 4> m_state;
+		};
+
+		// get a uniformly distributed float in [0, 1) from the top 24 bits of one output
+		// (cheaper than std::uniform_real_distribution, which may call the generator more than once)
+		template<class RNG>
+		float uniform_float(RNG& rng)
+		{
+			static_assert(RNG::min() == 0u && (RNG::max() == 0xffffffffu || RNG::max() == 0xffffffffffffffffull), "generator must produce 32 or 64 full bits");
+
+			constexpr auto shift = (RNG::max() == 0xffffffffu) ? 8u : 40u;
+			return float(std::uint64_t(rng()) >> shift) * (1.f / 16777216.f);
+		}
+
 		// get a uniformly distributed random point in a ring
 		// min_radius -> inner radius of ring (points are outside this)
 		// max_radius -> outer radius of ring (points are inside this)
@@ -30,17 +130,17 @@ namespace bump
 			return { radius * std::cos(angle), radius * std::sin(angle) };
 		}
 
-		template<class RNG>
-		glm::vec3 point_in_ring_3d(RNG& rng, float min_radius, float max_radius)
+		// as point_in_ring_3d(), but from three uniformly distributed numbers in [0, 1)
+		// (so the random numbers can be generated in bulk)
+		inline glm::vec3 point_in_ring_3d_from_uniform(glm::vec3 u, float min_radius, float max_radius)
 		{
 			die_if(max_radius < min_radius);
 
-			auto d = std::uniform_real_distribution<float>(0.f, 1.f);
-			auto theta = d(rng) * 2.f * glm::pi<float>();
-			auto phi = std::acosf(d(rng) * 2.f - 1.f);
+			auto theta = u.x * 2.f * glm::pi<float>();
+			auto phi = std::acosf(u.y * 2.f - 1.f);
 			auto min_r3 = min_radius * min_radius * min_radius;
 			auto max_r3 = max_radius * max_radius * max_radius;
-			auto radius = std::sqrt(d(rng) * (max_r3 - min_r3) + min_r3);
+			auto radius = std::sqrt(u.z * (max_r3 - min_r3) + min_r3);
 
 			return { 
 				radius * std::cos(theta) * std::sin(phi),
@@ -49,6 +149,15 @@ namespace bump
 			};
 		}
 
+		template<class RNG>
+		glm::vec3 point_in_ring_3d(RNG& rng, float min_radius, float max_radius)
+		{
+			auto d = std::uniform_real_distribution<float>(0.f, 1.f);
+			auto u = glm::vec3{ d(rng), d(rng), d(rng) };
+
+			return point_in_ring_3d_from_uniform(u, min_radius, max_radius);
+		}
+
 		// get a random rgb color no more than max_offset from base_color
 		// each component of the result is clamped from 0.0 to 1.0
 		// todo: use hsv?
@@ -82,6 +191,57 @@ namespace bump
 			return bounds.lower_bound(dist(rng))->second;
 		}
 
+		// batch versions of the above (one call fills a whole array).
+		// these avoid the trig functions and distribution objects, so they're much cheaper per sample.
+
+		// the same distribution as point_in_ring_3d(): a uniformly distributed direction, with a radius of sqrt(u * (max^3 - min^3) + min^3).
+		// note: that radius isn't uniform by volume, and is only in [min_radius, max_radius] when they're 0 or 1
+		// (e.g. a max_radius of 0.2 gives points within ~0.09). the particle effects are tuned for it, so it's kept.
+		template<class RNG>
+		void points_in_ring_3d(RNG& rng, float min_radius, float max_radius, span<glm::vec3> output)
+		{
+			die_if(max_radius < min_radius);
+
+			auto const random_in_cube = [&] () { return glm::vec3{ uniform_float(rng), uniform_float(rng), uniform_float(rng) } * 2.f - 1.f; };
+
+			auto const min_r3 = min_radius * min_radius * min_radius;
+			auto const max_r3 = max_radius * max_radius * max_radius;
+
+			for (auto& p : output)
+			{
+				// a random direction (rejection sampled in the unit cube, ~52% of samples are accepted)
+				auto v = random_in_cube();
+				auto l2 = glm::dot(v, v);
+
+				while (l2 > 1.f || l2 < 1e-6f)
+				{
+					v = random_in_cube();
+					l2 = glm::dot(v, v);
+				}
+
+				auto const radius = std::sqrt(uniform_float(rng) * (max_r3 - min_r3) + min_r3);
+
+				p = v * (radius / std::sqrt(l2));
+			}
+		}
+
+		template<class RNG>
+		void color_offsets_rgb(RNG& rng, glm::vec3 base_color, glm::vec3 max_offset, span<glm::vec3> output)
+		{
+			for (auto& c : output)
+			{
+				auto const color = glm::vec3{ uniform_float(rng), uniform_float(rng), uniform_float(rng) } * 2.f - 1.f;
+				c = glm::clamp(base_color + color * max_offset, 0.f, 1.f);
+			}
+		}
+
+		template<class RNG>
+		void scales(RNG& rng, float base_scale, float max_offset, span<float> output)
+		{
+			for (auto& s : output)
+				s = base_scale + (uniform_float(rng) * 2.f - 1.f) * max_offset;
+		}
+
 	} // unnamed
 	
 } // bump
\ No newline at end of file
@@ -56,7 +56,6 @@ int main(int , char* [])
 
 	// misc fixes:
 		// player collision with powerup slows down player :(
-		// frustum culling when rendering?
 
 	// player controls:
 		// remove strafing / thrusters (-> classic asteroids controls)
@@ -0,0 +1,138 @@
+#include "bench.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bump
+{
+
+	namespace bench
+	{
+
+		namespace
+		{
+
+#if defined(__linux__)
+
+			int open_cache_counter(std::uint64_t cache)
+			{
+				auto attr = perf_event_attr{ };
+				attr.size = sizeof(attr);
+				attr.type = PERF_TYPE_HW_CACHE;
+				attr.config = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8u) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16u);
+				attr.disabled = 1;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+
+				return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+			}
+
+			void start_counter(int fd)
+			{
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+
+			std::uint64_t stop_counter(int fd)
+			{
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+				auto value = std::uint64_t{ 0 };
+				return (read(fd, &value, sizeof(value)) == sizeof(value)) ? value : 0;
+			}
+
+#endif
+
+			volatile float g_sink = 0.f;
+
+		} // unnamed
+
+#if defined(__linux__)
+
+		cache_counters::cache_counters():
+			m_l1d_fd(open_cache_counter(PERF_COUNT_HW_CACHE_L1D)),
+			m_llc_fd(open_cache_counter(PERF_COUNT_HW_CACHE_LL)),
+			m_l1d_misses(0),
+			m_llc_misses(0) { }
+
+		cache_counters::~cache_counters()
+		{
+			if (m_l1d_fd >= 0) close(m_l1d_fd);
+			if (m_llc_fd >= 0) close(m_llc_fd);
+		}
+
+		void cache_counters::start()
+		{
+			if (!is_available())
+				return;
+
+			start_counter(m_l1d_fd);
+			start_counter(m_llc_fd);
+		}
+
+		void cache_counters::stop()
+		{
+			if (!is_available())
+				return;
+
+			m_l1d_misses = stop_counter(m_l1d_fd);
+			m_llc_misses = stop_counter(m_llc_fd);
+		}
+
+#else
+
+		cache_counters::cache_counters():
+			m_l1d_fd(-1),
+			m_llc_fd(-1),
+			m_l1d_misses(0),
+			m_llc_misses(0) { }
+
+		cache_counters::~cache_counters() { }
+
+		void cache_counters::start() { }
+		void cache_counters::stop() { }
+
+#endif
+
+		void consume(float value)
+		{
+			g_sink = g_sink + value;
+		}
+
+		void print_section(std::string const& name)
+		{
+			std::cout << "\n" << name << ":\n";
+		}
+
+		void print_result(std::string const& name, result const& r)
+		{
+			std::cout << "  " << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(3)
+				<< "min " << std::setw(9) << r.m_min_ms << " ms, mean " << std::setw(9) << r.m_mean_ms << " ms";
+
+			if (r.m_has_counters)
+				std::cout << ", l1d misses " << std::setw(9) << r.m_l1d_misses << ", llc misses " << std::setw(9) << r.m_llc_misses;
+
+			std::cout << "\n";
+		}
+
+		void print_speedup(std::string const& name, result const& before, result const& after)
+		{
+			std::cout << "  " << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(2)
+				<< (before.m_min_ms / after.m_min_ms) << "x faster";
+
+			if (before.m_has_counters && after.m_has_counters && before.m_l1d_misses != 0)
+				std::cout << ", " << (100.f * float(after.m_l1d_misses) / float(before.m_l1d_misses)) << "% of the l1d misses";
+
+			std::cout << "\n";
+		}
+
+	} // bench
+
+} // bump
\ No newline at end of file
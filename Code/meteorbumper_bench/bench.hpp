@@ -0,0 +1,109 @@
+#pragma once
+
+#include "bump_time.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace bump
+{
+
+	namespace bench
+	{
+
+		// hardware cache miss counters for the calling thread.
+		// note: only implemented with linux perf events. elsewhere, is_available() is false (use a profiler, e.g. VTune or uProf).
+		// note: perf has no generic l2 event, so the second counter is the last level cache.
+		class cache_counters
+		{
+		public:
+
+			cache_counters();
+			~cache_counters();
+
+			cache_counters(cache_counters const&) = delete;
+			cache_counters& operator=(cache_counters const&) = delete;
+
+			bool is_available() const { return m_l1d_fd >= 0 && m_llc_fd >= 0; }
+
+			void start();
+			void stop();
+
+			std::uint64_t get_l1d_misses() const { return m_l1d_misses; }
+			std::uint64_t get_llc_misses() const { return m_llc_misses; }
+
+		private:
+
+			int m_l1d_fd;
+			int m_llc_fd;
+			std::uint64_t m_l1d_misses;
+			std::uint64_t m_llc_misses;
+		};
+
+		struct result
+		{
+			float m_min_ms = 0.f;
+			float m_mean_ms = 0.f;
+			bool m_has_counters = false;
+			std::uint64_t m_l1d_misses = 0; // per run
+			std::uint64_t m_llc_misses = 0; // per run
+		};
+
+		// stops the compiler throwing away work whose result isn't otherwise used
+		void consume(float value);
+
+		// calls f once to warm up, then run_count times
+		template<class F>
+		result run(std::size_t run_count, F&& f);
+
+		void print_section(std::string const& name);
+		void print_result(std::string const& name, result const& r);
+		void print_speedup(std::string const& name, result const& before, result const& after);
+
+		// the benchmarks (one per area of the game):
+		void run_physics_benchmarks();
+		void run_particle_benchmarks();
+		void run_random_benchmarks();
+		void run_lighting_benchmarks();
+
+		template<class F>
+		result run(std::size_t run_count, F&& f)
+		{
+			f();
+
+			auto counters = cache_counters();
+			auto out = result();
+			out.m_has_counters = counters.is_available();
+			out.m_min_ms = std::numeric_limits<float>::max();
+
+			auto total_ms = 0.f;
+
+			for (auto i = std::size_t{ 0 }; i != run_count; ++i)
+			{
+				counters.start();
+				auto const start = high_res_clock_t::now();
+
+				f();
+
+				auto const time_ms = high_res_duration_to_seconds(high_res_clock_t::now() - start) * 1000.f;
+				counters.stop();
+
+				out.m_min_ms = std::min(out.m_min_ms, time_ms);
+				total_ms += time_ms;
+				out.m_l1d_misses += counters.get_l1d_misses();
+				out.m_llc_misses += counters.get_llc_misses();
+			}
+
+			out.m_mean_ms = total_ms / float(run_count);
+			out.m_l1d_misses /= run_count;
+			out.m_llc_misses /= run_count;
+
+			return out;
+		}
+
+	} // bench
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "bench.hpp"
+
+#include "bump_camera.hpp"
+#include "bump_lighting_clusters.hpp"
+#include "bump_random.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace bump
+{
+
+	namespace bench
+	{
+
+		namespace
+		{
+
+			auto const run_count = std::size_t{ 200 };
+
+		} // unnamed
+
+		void run_lighting_benchmarks()
+		{
+			auto camera = perspective_camera();
+			camera.m_projection.m_size = { 1280.f, 720.f };
+			camera.m_projection.m_fov_degrees = 45.f;
+			camera.m_projection.m_near = 0.5f;
+			camera.m_projection.m_far = 200.f;
+
+			auto const matrices = camera_matrices(camera);
+
+			auto clusters = lighting::light_clusters({ 16, 9, 24 });
+			clusters.set_camera(matrices);
+
+			print_section("lighting - assigning point lights to " + std::to_string(clusters.get_cluster_count()) + " clusters");
+
+			for (auto const light_count : { std::size_t{ 64 }, std::size_t{ 256 }, std::size_t{ 1024 } })
+			{
+				// lights spread through the view frustum (the near plane point at a random ndc x and y, pushed out to a random depth)
+				auto rng = random::pcg32(12345u);
+				auto positions = std::vector<glm::vec3>();
+				auto radii = std::vector<float>();
+
+				for (auto i = std::size_t{ 0 }; i != light_count; ++i)
+				{
+					auto const ndc = glm::vec2(random::uniform_float(rng), random::uniform_float(rng)) * 2.f - 1.f;
+					auto const p = matrices.m_inv_projection * glm::vec4(ndc, -1.f, 1.f);
+					auto const near_point = glm::vec3(p) / p.w;
+					auto const depth = 1.f + random::uniform_float(rng) * 100.f;
+
+					positions.push_back(near_point * (depth / -near_point.z));
+					radii.push_back(1.f + random::uniform_float(rng) * 9.f);
+				}
+
+				auto const assign = run(run_count, [&] ()
+				{
+					clusters.assign_lights({ positions.data(), positions.size() }, { radii.data(), radii.size() });
+					consume(float(clusters.get_light_indices().size()));
+				});
+
+				print_result(std::to_string(light_count) + " lights (" + std::to_string(clusters.get_light_indices().size()) + " light indices)", assign);
+			}
+		}
+
+	} // bench
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// usage: meteorbumper_bench [name...]
+// runs the named benchmarks, or all of them if none are named.
+int main(int argc, char* argv[])
+{
+	using namespace bump;
+
+	auto const benchmarks = std::vector<std::pair<std::string, std::function<void()>>>
+	{
+		{ "physics", bench::run_physics_benchmarks },
+		{ "particles", bench::run_particle_benchmarks },
+		{ "random", bench::run_random_benchmarks },
+		{ "lighting", bench::run_lighting_benchmarks },
+	};
+
+	for (auto const& b : benchmarks)
+	{
+		auto const selected = (argc == 1) || std::any_of(argv + 1, argv + argc, [&] (char const* arg) { return b.first == arg; });
+
+		if (selected)
+			b.second();
+	}
+
+	std::cout << "\ndone!" << std::endl;
+}
\ No newline at end of file
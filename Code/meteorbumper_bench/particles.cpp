@@ -0,0 +1,512 @@
+#include "bench.hpp"
+
+#include "bump_color_map.hpp"
+#include "bump_entity_pool.hpp"
+#include "bump_physics_collider.hpp"
+#include "bump_physics_inertia_tensor.hpp"
+#include "bump_physics_rigidbody.hpp"
+#include "bump_random.hpp"
+#include "bump_span.hpp"
+#include "bump_time.hpp"
+#include "bump_transform.hpp"
+
+#include <entt.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bump
+{
+
+	namespace bench
+	{
+
+		namespace
+		{
+
+			// note: game::particle_effect needs a particle_system (and so a gl context), so both versions of the
+			// particle storage are reproduced here: registry entities (before) and packed parallel arrays (after).
+			// collisions aren't included (the entity path went through the physics system's broad phase).
+
+			auto const particle_count = std::size_t{ 10000 };
+			auto const run_count = std::size_t{ 50 };
+			auto const update_time = high_res_duration_from_seconds(1.f / 120.f);
+
+			// the player's engine effect
+			auto const max_lifetime = high_res_duration_from_seconds(0.75f);
+			auto const max_lifetime_random = high_res_duration_from_seconds(0.75f); // the whole lifetime, so particles die every update
+			auto const spawn_radius_m = 0.5f;
+			auto const base_velocity = glm::vec3{ 0.f, 0.f, 15.f };
+			auto const random_velocity = glm::vec3{ 10.f, 10.f, 0.5f };
+
+			std::map<float, glm::vec4> const color_map =
+			{
+				{ 0.0f, { 1.f, 0.85f, 0.42f, 1.f } },
+				{ 0.4f, { 0.75f, 0.20f, 0.09f, 0.95f } },
+				{ 0.7f, { 0.32f, 0.20f, 0.12f, 0.80f } },
+				{ 1.0f, { 0.0f, 0.0f, 0.0f, 0.25f } },
+			};
+
+			std::map<float, float> const size_map =
+			{
+				{ 0.0f, 4.5f },
+				{ 0.4f, 1.0f },
+				{ 1.0f, 0.f },
+			};
+
+			// gathered particle data (the instance buffer uploads)
+			struct render_data
+			{
+				std::vector<glm::vec3> m_positions;
+				std::vector<glm::vec4> m_colors;
+				std::vector<float> m_sizes;
+
+				float sum() const { return m_positions.empty() ? 0.f : m_positions.back().x + m_colors.back().x + m_sizes.back(); }
+
+				void clear()
+				{
+					m_positions.clear();
+					m_colors.clear();
+					m_sizes.clear();
+				}
+			};
+
+			// how particle values are generated and updated
+			enum class particle_math
+			{
+				BEFORE, // std::mt19937, point_in_ring_3d() per particle, and std::map curves through std::function (as particle_effect was)
+				AFTER,  // pcg32, points_in_ring_3d() for a batch, and curve_lut (as particle_effect is now)
+			};
+
+			// random values for a batch of particles (as particle_effect::spawn_bursts())
+			struct spawn_values
+			{
+				std::vector<glm::vec3> m_offsets;
+				std::vector<glm::vec3> m_velocities;
+				std::vector<float> m_lifetimes;
+
+				void generate(random::pcg32& rng, std::size_t count)
+				{
+					m_offsets.resize(count);
+					random::points_in_ring_3d(rng, 0.f, spawn_radius_m, { m_offsets.data(), count });
+
+					m_velocities.resize(count);
+					random::points_in_ring_3d(rng, 0.f, 1.f, { m_velocities.data(), count });
+
+					m_lifetimes.resize(count);
+
+					for (auto& l : m_lifetimes)
+						l = random::uniform_float(rng);
+				}
+
+				glm::vec3 get_position(std::size_t i) const { return m_offsets[i]; }
+				glm::vec3 get_velocity(std::size_t i) const { return base_velocity + random_velocity * m_velocities[i]; }
+				float get_lifetime_s(std::size_t i) const { return high_res_duration_to_seconds(max_lifetime_random) * m_lifetimes[i]; }
+			};
+
+			// particles as registry entities (as particle_effect was before)
+			// note: with particle_math::AFTER, only the storage differs from packed_particles
+			class entity_particles
+			{
+			public:
+
+				struct particle_data
+				{
+					high_res_duration_t m_lifetime = high_res_duration_from_seconds(2.f);
+					glm::vec4 m_color = glm::vec4(1.f);
+					float m_size = 1.f;
+				};
+
+				using color_update_fn_t = std::function<glm::vec4(entt::entity, particle_data const&)>;
+				using size_update_fn_t = std::function<float(entt::entity, particle_data const&)>;
+
+				entity_particles(entt::registry& registry, particle_math math):
+					m_registry(registry),
+					m_pool(registry),
+					m_group(registry.group<particle_data>(entt::get<physics::rigidbody, physics::collider>, entt::exclude<inactive_tag>)),
+					m_math(math),
+					m_color_update_fn(),
+					m_size_update_fn(),
+					m_color_curve(color_map),
+					m_size_curve(size_map),
+					m_rng_before(12345),
+					m_rng(12345)
+				{
+					m_color_update_fn = [] (entt::entity, particle_data const& p)
+					{
+						auto a = std::clamp(high_res_duration_to_seconds(p.m_lifetime) / high_res_duration_to_seconds(max_lifetime), 0.f, 1.f);
+						return get_color_from_map(color_map, a);
+					};
+
+					m_size_update_fn = [] (entt::entity, particle_data const& p)
+					{
+						auto a = std::clamp(high_res_duration_to_seconds(p.m_lifetime) / high_res_duration_to_seconds(max_lifetime), 0.f, 1.f);
+						return get_size_from_map(size_map, a);
+					};
+				}
+
+				~entity_particles()
+				{
+					clear();
+				}
+
+				std::size_t get_size() const { return m_particles.size(); }
+
+				void clear()
+				{
+					for (auto id : m_particles)
+						m_pool.release(id);
+
+					m_particles.clear();
+				}
+
+				void spawn(std::size_t count)
+				{
+					if (m_math == particle_math::BEFORE)
+					{
+						for (auto i = std::size_t{ 0 }; i != count; ++i)
+							spawn_particle();
+
+						return;
+					}
+
+					m_spawn_values.generate(m_rng, count);
+
+					for (auto i = std::size_t{ 0 }; i != count; ++i)
+						add_particle(m_spawn_values.get_position(i), m_spawn_values.get_velocity(i), high_res_duration_from_seconds(m_spawn_values.get_lifetime_s(i)));
+				}
+
+				void update(high_res_duration_t dt)
+				{
+					// integration (done by the physics_system for the entity particles)
+					auto const dt_s = high_res_duration_to_seconds(dt);
+
+					for (auto id : m_particles)
+					{
+						auto& rb = m_group.get<physics::rigidbody>(id);
+						rb.set_position(rb.get_position() + rb.get_velocity() * dt_s);
+					}
+
+					for (auto id : m_particles)
+					{
+						auto& p = m_group.get<particle_data>(id);
+						p.m_lifetime += dt;
+
+						if (m_math == particle_math::BEFORE)
+						{
+							p.m_color = m_color_update_fn ? m_color_update_fn(id, p) : p.m_color;
+							p.m_size = m_size_update_fn ? m_size_update_fn(id, p) : p.m_size;
+						}
+						else
+						{
+							auto const a = high_res_duration_to_seconds(p.m_lifetime) / high_res_duration_to_seconds(max_lifetime);
+							p.m_color = m_color_curve.evaluate(a);
+							p.m_size = m_size_curve.evaluate(a);
+						}
+					}
+
+					auto first_dead_particle = std::remove_if(m_particles.begin(), m_particles.end(),
+						[&] (entt::entity id)
+						{
+							auto const& p = m_group.get<particle_data>(id);
+
+							auto result = (p.m_lifetime > max_lifetime);
+
+							if (result)
+								m_pool.release(id);
+
+							return result;
+						});
+
+					m_particles.erase(first_dead_particle, m_particles.end());
+				}
+
+				void gather(render_data& out) const
+				{
+					out.m_positions.reserve(m_particles.size());
+					out.m_colors.reserve(m_particles.size());
+					out.m_sizes.reserve(m_particles.size());
+
+					for (auto id : m_particles)
+					{
+						auto [p, rb] = m_group.get<particle_data, physics::rigidbody>(id);
+						out.m_positions.push_back(rb.get_position());
+						out.m_colors.push_back(p.m_color);
+						out.m_sizes.push_back(p.m_size);
+					}
+				}
+
+			private:
+
+				void spawn_particle()
+				{
+					auto dl = std::uniform_real_distribution<float>(0.f, 1.f);
+					auto const l = high_res_duration_from_seconds(high_res_duration_to_seconds(max_lifetime_random) * dl(m_rng_before));
+
+					auto const p = random::point_in_ring_3d(m_rng_before, 0.f, spawn_radius_m);
+					auto const v = base_velocity + random_velocity * random::point_in_ring_3d(m_rng_before, 0.f, 1.f);
+
+					add_particle(transform_point_to_world(m_origin, p), transform_vector_to_world(m_origin, v), l);
+				}
+
+				void add_particle(glm::vec3 position, glm::vec3 velocity, high_res_duration_t lifetime)
+				{
+					auto id = m_pool.create();
+
+					auto const particle_mass_kg = 0.005f;
+					auto const particle_radius_m = 0.01f;
+
+					auto& rigidbody = m_registry.emplace_or_replace<physics::rigidbody>(id);
+					rigidbody.set_mass(particle_mass_kg);
+					rigidbody.set_local_inertia_tensor(physics::make_sphere_inertia_tensor(particle_mass_kg, particle_radius_m));
+					rigidbody.set_position(position);
+					rigidbody.set_velocity(velocity);
+
+					auto& collider = m_registry.emplace_or_replace<physics::collider>(id);
+					collider.set_shape({ physics::sphere_shape{ particle_radius_m } });
+					collider.set_collision_layer(physics::collision_layers::PARTICLES);
+					collider.set_collision_mask(physics::collision_layers::ASTEROIDS);
+
+					auto& particle = m_registry.emplace_or_replace<particle_data>(id);
+					particle.m_lifetime = lifetime;
+
+					if (m_math == particle_math::BEFORE)
+					{
+						particle.m_color = m_color_update_fn ? m_color_update_fn(id, particle) : glm::vec4(1.f);
+						particle.m_size = m_size_update_fn ? m_size_update_fn(id, particle) : 1.f;
+					}
+					else
+					{
+						auto const a = high_res_duration_to_seconds(lifetime) / high_res_duration_to_seconds(max_lifetime);
+						particle.m_color = m_color_curve.evaluate(a);
+						particle.m_size = m_size_curve.evaluate(a);
+					}
+
+					m_particles.push_back(id);
+				}
+
+				using particle_group = entt::group<entt::exclude_t<inactive_tag>, entt::get_t<physics::rigidbody, physics::collider>, particle_data>;
+
+				entt::registry& m_registry;
+				entity_pool m_pool;
+				particle_group m_group;
+				glm::mat4 m_origin = glm::mat4(1.f);
+				particle_math m_math;
+				color_update_fn_t m_color_update_fn;
+				size_update_fn_t m_size_update_fn;
+				curve_lut<glm::vec4> m_color_curve;
+				curve_lut<float> m_size_curve;
+				std::vector<entt::entity> m_particles;
+				spawn_values m_spawn_values;
+				std::mt19937 m_rng_before;
+				random::pcg32 m_rng;
+			};
+
+			// particles in packed parallel arrays (the same loops as particle_effect::update() and particle_effect::spawn_bursts())
+			class packed_particles
+			{
+			public:
+
+				packed_particles():
+					m_color_curve(color_map),
+					m_size_curve(size_map),
+					m_rng(12345) { }
+
+				std::size_t get_size() const { return m_positions.size(); }
+
+				void clear()
+				{
+					m_positions.clear();
+					m_velocities.clear();
+					m_lifetimes.clear();
+					m_colors.clear();
+					m_sizes.clear();
+				}
+
+				void spawn(std::size_t count)
+				{
+					m_spawn_values.generate(m_rng, count);
+
+					m_positions.reserve(get_size() + count);
+					m_velocities.reserve(get_size() + count);
+					m_lifetimes.reserve(get_size() + count);
+					m_colors.reserve(get_size() + count);
+					m_sizes.reserve(get_size() + count);
+
+					auto const max_lifetime_s = high_res_duration_to_seconds(max_lifetime);
+
+					for (auto i = std::size_t{ 0 }; i != count; ++i)
+					{
+						auto const l_s = m_spawn_values.get_lifetime_s(i);
+						auto const a = l_s / max_lifetime_s;
+
+						m_positions.push_back(m_spawn_values.get_position(i));
+						m_velocities.push_back(m_spawn_values.get_velocity(i));
+						m_lifetimes.push_back(high_res_duration_from_seconds(l_s));
+						m_colors.push_back(m_color_curve.evaluate(a));
+						m_sizes.push_back(m_size_curve.evaluate(a));
+					}
+				}
+
+				void update(high_res_duration_t dt)
+				{
+					auto const dt_s = high_res_duration_to_seconds(dt);
+
+					for (auto i = std::size_t{ 0 }; i != m_positions.size(); ++i)
+						m_positions[i] += m_velocities[i] * dt_s;
+
+					for (auto i = std::size_t{ 0 }; i != m_lifetimes.size(); ++i)
+						m_lifetimes[i] += dt;
+
+					auto const max_lifetime_s = high_res_duration_to_seconds(max_lifetime);
+
+					m_frame_ages.resize(m_lifetimes.size());
+
+					for (auto i = std::size_t{ 0 }; i != m_lifetimes.size(); ++i)
+						m_frame_ages[i] = high_res_duration_to_seconds(m_lifetimes[i]) / max_lifetime_s;
+
+					auto const ages = span<float const>(m_frame_ages.data(), m_frame_ages.size());
+					m_color_curve.evaluate(ages, { m_colors.data(), m_colors.size() });
+					m_size_curve.evaluate(ages, { m_sizes.data(), m_sizes.size() });
+
+					for (auto i = std::size_t{ 0 }; i != m_lifetimes.size(); )
+					{
+						if (m_lifetimes[i] > max_lifetime)
+							remove_particle(i);
+						else
+							++i;
+					}
+				}
+
+				void gather(render_data& out) const
+				{
+					out.m_positions.insert(out.m_positions.end(), m_positions.begin(), m_positions.end());
+					out.m_colors.insert(out.m_colors.end(), m_colors.begin(), m_colors.end());
+					out.m_sizes.insert(out.m_sizes.end(), m_sizes.begin(), m_sizes.end());
+				}
+
+			private:
+
+				void remove_particle(std::size_t index)
+				{
+					auto const swap_remove = [=] (auto& v)
+					{
+						v[index] = v.back();
+						v.pop_back();
+					};
+
+					swap_remove(m_positions);
+					swap_remove(m_velocities);
+					swap_remove(m_lifetimes);
+					swap_remove(m_colors);
+					swap_remove(m_sizes);
+				}
+
+				curve_lut<glm::vec4> m_color_curve;
+				curve_lut<float> m_size_curve;
+
+				std::vector<glm::vec3> m_positions;
+				std::vector<glm::vec3> m_velocities;
+				std::vector<high_res_duration_t> m_lifetimes;
+				std::vector<glm::vec4> m_colors;
+				std::vector<float> m_sizes;
+
+				std::vector<float> m_frame_ages;
+				spawn_values m_spawn_values;
+
+				random::pcg32 m_rng;
+			};
+
+			template<class ParticlesT>
+			result run_spawn(ParticlesT& particles)
+			{
+				return run(run_count, [&] ()
+				{
+					particles.clear();
+					particles.spawn(particle_count);
+				});
+			}
+
+			// an update, then top up the particles that died (so every run updates the same number of particles)
+			template<class ParticlesT>
+			result run_update(ParticlesT& particles)
+			{
+				particles.clear();
+				particles.spawn(particle_count);
+
+				return run(run_count, [&] ()
+				{
+					particles.update(update_time);
+					particles.spawn(particle_count - particles.get_size());
+				});
+			}
+
+			template<class ParticlesT>
+			result run_gather(ParticlesT& particles, render_data& data)
+			{
+				return run(run_count, [&] ()
+				{
+					particles.gather(data);
+					consume(data.sum());
+					data.clear();
+				});
+			}
+
+		} // unnamed
+
+		void run_particle_benchmarks()
+		{
+			auto packed = packed_particles();
+			auto data = render_data();
+
+			auto const compare = [&] (std::string const& name, particle_math math)
+			{
+				print_section("particles - " + name + " (" + std::to_string(particle_count) + " particles)");
+
+				// other entities with rigidbodies (as in the game), so the entity particles don't have the pools to themselves
+				auto registry = entt::registry();
+				auto entities = entity_particles(registry, math);
+				auto other_rng = std::mt19937(54321);
+				auto other_position = std::uniform_real_distribution<float>(-300.f, 300.f);
+
+				for (auto i = std::size_t{ 0 }; i != particle_count; ++i)
+					registry.emplace<physics::rigidbody>(registry.create()).set_position({ other_position(other_rng), 0.f, other_position(other_rng) });
+
+				auto const spawn_entities = run_spawn(entities);
+				auto const spawn_packed = run_spawn(packed);
+
+				print_result("spawn (entities)", spawn_entities);
+				print_result("spawn (packed)", spawn_packed);
+				print_speedup("spawn", spawn_entities, spawn_packed);
+
+				auto const update_entities = run_update(entities);
+				auto const update_packed = run_update(packed);
+
+				print_result("update (entities)", update_entities);
+				print_result("update (packed)", update_packed);
+				print_speedup("update", update_entities, update_packed);
+
+				auto const gather_entities = run_gather(entities, data);
+				auto const gather_packed = run_gather(packed, data);
+
+				print_result("render data (entities)", gather_entities);
+				print_result("render data (packed)", gather_packed);
+				print_speedup("render data", gather_entities, gather_packed);
+			};
+
+			// only the storage differs (the same rng, sampling and curves on both sides)
+			compare("registry entities vs. packed arrays", particle_math::AFTER);
+
+			// the whole change (including the curve_lut and pcg32 / batch sampling changes)
+			compare("entities with std::mt19937 and std::map curves vs. packed arrays", particle_math::BEFORE);
+		}
+
+	} // bench
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include "bench.hpp"
+
+#include "bump_entity_pool.hpp"
+#include "bump_morton.hpp"
+#include "bump_physics_bucket_grid.hpp"
+#include "bump_physics_collider.hpp"
+#include "bump_physics_rigidbody.hpp"
+
+#include <entt.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace bump
+{
+
+	namespace bench
+	{
+
+		namespace
+		{
+
+			using namespace physics;
+
+			// stand-in for game::asteroid_field::asteroid_data (which brings the renderer with it)
+			struct asteroid_data
+			{
+				float m_hit_points = 100.f;
+				std::uint32_t m_type = 0;
+			};
+
+			auto const asteroid_count = std::size_t{ 20000 };
+			auto const pooled_count = std::size_t{ 20000 }; // rigidbodies without colliders (e.g. pooled particles and fragments), half inactive
+			auto const run_count = std::size_t{ 50 };
+			auto const update_time_s = 1.f / 120.f;
+
+			// the same seed gives the same entities in the same order in every registry
+			void populate(entt::registry& registry)
+			{
+				auto rng = std::mt19937(12345);
+				auto position = std::uniform_real_distribution<float>(-300.f, 300.f);
+				auto velocity = std::uniform_real_distribution<float>(-10.f, 10.f);
+				auto radius = std::uniform_real_distribution<float>(1.f, 3.f);
+
+				auto asteroids = std::vector<entt::entity>();
+
+				auto const create_asteroid = [&] ()
+				{
+					auto const id = registry.create();
+
+					auto& rb = registry.emplace<rigidbody>(id);
+					rb.set_mass(10.f);
+					rb.set_position({ position(rng), 0.f, position(rng) });
+					rb.set_velocity({ velocity(rng), 0.f, velocity(rng) });
+
+					auto& c = registry.emplace<collider>(id);
+					c.set_shape(sphere_shape{ radius(rng) });
+					c.set_collision_layer(collision_layers::ASTEROIDS);
+					c.set_collision_mask(collision_layers::ASTEROIDS);
+
+					registry.emplace<asteroid_data>(id);
+					asteroids.push_back(id);
+				};
+
+				// interleave the asteroids with the pooled entities (as they're created in the game)
+				for (auto i = std::size_t{ 0 }; i != std::max(asteroid_count, pooled_count); ++i)
+				{
+					if (i < asteroid_count)
+						create_asteroid();
+
+					if (i < pooled_count)
+					{
+						auto const id = registry.create();
+						registry.emplace<rigidbody>(id).set_position({ position(rng), 0.f, position(rng) });
+
+						if (i % 2 == 0)
+							registry.emplace<inactive_tag>(id);
+					}
+				}
+
+				// destroy and replace a quarter of the asteroids (as they're split and respawned)
+				std::shuffle(asteroids.begin(), asteroids.end(), rng);
+				auto const replace_count = asteroid_count / 4;
+
+				for (auto i = std::size_t{ 0 }; i != replace_count; ++i)
+					registry.destroy(asteroids[i]);
+
+				for (auto i = std::size_t{ 0 }; i != replace_count; ++i)
+					create_asteroid();
+			}
+
+			// note: rigidbody::update() is private to physics_system, so this does a similar amount of work with the public interface
+			void update_rigidbody(rigidbody& rb)
+			{
+				rb.add_force(-rb.get_velocity() * 0.1f);
+				rb.set_velocity(rb.get_velocity() + rb.get_force() * rb.get_inverse_mass() * update_time_s);
+				rb.set_position(rb.get_position() + rb.get_velocity() * update_time_s);
+				rb.clear_force();
+				rb.clear_torque();
+			}
+
+			template<class ViewT>
+			float gather_asteroids(ViewT view)
+			{
+				auto sum = 0.f;
+
+				view.each([&] (asteroid_data const& a, rigidbody const& rb, collider const& c)
+				{
+					sum += a.m_hit_points * std::get<sphere_shape>(c.get_shape()).m_radius + rb.get_position().x;
+				});
+
+				return sum;
+			}
+
+			// the same as physics_system::spatial_sort()
+			auto const sort_origin = glm::vec3(-512.f);
+			auto const sort_cell_size = 1.f;
+
+			std::size_t get_entity_index(entt::entity id)
+			{
+				return std::size_t(entt::to_integral(id) & entt::entt_traits<entt::entity>::entity_mask);
+			}
+
+			template<class RigidbodyGroupT, class AsteroidGroupT>
+			void spatial_sort(entt::registry& registry, RigidbodyGroupT& rigidbodies, AsteroidGroupT& asteroids, std::vector<std::uint32_t>& keys)
+			{
+				keys.resize(registry.size());
+
+				registry.view<rigidbody>().each([&] (entt::entity id, rigidbody const& rb)
+				{
+					keys[get_entity_index(id)] = morton_encode_3d(rb.get_position(), sort_origin, sort_cell_size);
+				});
+
+				auto const morton_order = [&] (entt::entity a, entt::entity b) { return keys[get_entity_index(a)] < keys[get_entity_index(b)]; };
+
+				rigidbodies.sort(morton_order);
+				registry.sort<collider, rigidbody>();
+				asteroids.sort(morton_order);
+			}
+
+			// the asteroid part of the physics_system broad phase and narrow phase
+			template<class AsteroidGroupT>
+			float collide_asteroids(entt::registry& registry, AsteroidGroupT& asteroids, bucket_grid& grid, std::vector<std::pair<entt::entity, entt::entity>>& pairs)
+			{
+				auto colliders = registry.view<rigidbody, collider>();
+
+				grid.create(asteroids);
+				grid.get_collision_pairs(asteroids, std::back_inserter(pairs));
+
+				auto penetration = 0.f;
+
+				for (auto const& pair : pairs)
+				{
+					auto const& p1 = colliders.get<rigidbody>(pair.first);
+					auto const& p2 = colliders.get<rigidbody>(pair.second);
+					auto const& c1 = colliders.get<collider>(pair.first);
+					auto const& c2 = colliders.get<collider>(pair.second);
+
+					if ((c1.get_collision_mask() & c2.get_collision_layer()) == 0) continue;
+					if ((c2.get_collision_mask() & c1.get_collision_layer()) == 0) continue;
+
+					if (auto const hit = dispatch_find_collision(p1, c1, p2, c2))
+						penetration += hit->m_penetration;
+				}
+
+				pairs.clear();
+
+				return penetration;
+			}
+
+		} // unnamed
+
+		void run_physics_benchmarks()
+		{
+			// views (before) vs. owning groups (after):
+			{
+				print_section("physics - views vs. owning groups (" + std::to_string(asteroid_count) + " asteroids, " + std::to_string(pooled_count) + " pooled rigidbodies)");
+
+				auto views_registry = entt::registry();
+				populate(views_registry);
+
+				// groups are declared before any entities exist (as in the game)
+				auto groups_registry = entt::registry();
+				auto rigidbodies = groups_registry.group<rigidbody>(entt::exclude<inactive_tag>);
+				auto asteroids = groups_registry.group<asteroid_data>(entt::get<rigidbody, collider>);
+				populate(groups_registry);
+
+				auto const update_view = run(run_count, [&] () { views_registry.view<rigidbody>(entt::exclude<inactive_tag>).each(update_rigidbody); });
+				auto const update_group = run(run_count, [&] () { rigidbodies.each(update_rigidbody); });
+
+				print_result("update rigidbodies (view)", update_view);
+				print_result("update rigidbodies (group)", update_group);
+				print_speedup("update rigidbodies", update_view, update_group);
+
+				auto const gather_view = run(run_count, [&] () { consume(gather_asteroids(views_registry.view<asteroid_data, rigidbody, collider>())); });
+				auto const gather_group = run(run_count, [&] () { consume(gather_asteroids(asteroids)); });
+
+				print_result("asteroid_data + rigidbody + collider (view)", gather_view);
+				print_result("asteroid_data + rigidbody + collider (group)", gather_group);
+				print_speedup("asteroid_data + rigidbody + collider", gather_view, gather_group);
+			}
+
+			// creation order vs. morton order:
+			{
+				print_section("physics - creation order vs. spatially sorted pools (" + std::to_string(asteroid_count) + " asteroids)");
+
+				auto registry = entt::registry();
+				auto rigidbodies = registry.group<rigidbody>(entt::exclude<inactive_tag>);
+				auto asteroids = registry.group<asteroid_data>(entt::get<rigidbody, collider>);
+				populate(registry);
+
+				auto grid = bucket_grid(glm::vec3(8.f), glm::size3{ 80, 1, 80 });
+				auto pairs = std::vector<std::pair<entt::entity, entt::entity>>();
+				auto keys = std::vector<std::uint32_t>();
+
+				auto const unsorted = run(run_count, [&] () { consume(collide_asteroids(registry, asteroids, grid, pairs)); });
+
+				// sorting: a key per comparison (as it was first written) vs. a key per entity
+				auto const sort_per_comparison = run(run_count, [&] ()
+				{
+					auto const morton_order = [&] (rigidbody const& a, rigidbody const& b)
+					{
+						return morton_encode_3d(a.get_position(), sort_origin, sort_cell_size) < morton_encode_3d(b.get_position(), sort_origin, sort_cell_size);
+					};
+
+					rigidbodies.sort<rigidbody>(morton_order);
+					registry.sort<collider, rigidbody>();
+					asteroids.sort<rigidbody>(morton_order);
+				});
+
+				auto const sort_per_entity = run(run_count, [&] () { spatial_sort(registry, rigidbodies, asteroids, keys); });
+
+				auto const sorted = run(run_count, [&] () { consume(collide_asteroids(registry, asteroids, grid, pairs)); });
+
+				print_result("broad + narrow phase (creation order)", unsorted);
+				print_result("broad + narrow phase (morton order)", sorted);
+				print_speedup("broad + narrow phase", unsorted, sorted);
+
+				print_result("sort (key per comparison)", sort_per_comparison);
+				print_result("sort (key per entity)", sort_per_entity);
+				print_speedup("sort", sort_per_comparison, sort_per_entity);
+			}
+		}
+
+	} // bench
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "bench.hpp"
+
+#include "bump_random.hpp"
+
+#include <glm/glm.hpp>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bump
+{
+
+	namespace bench
+	{
+
+		namespace
+		{
+
+			auto const sample_count = std::size_t{ 100000 };
+			auto const run_count = std::size_t{ 50 };
+
+			template<class RNG>
+			float uniform_floats_std(RNG& rng)
+			{
+				auto d = std::uniform_real_distribution<float>(0.f, 1.f);
+				auto sum = 0.f;
+
+				for (auto i = std::size_t{ 0 }; i != sample_count; ++i)
+					sum += d(rng);
+
+				return sum;
+			}
+
+			template<class RNG>
+			float uniform_floats(RNG& rng)
+			{
+				auto sum = 0.f;
+
+				for (auto i = std::size_t{ 0 }; i != sample_count; ++i)
+					sum += random::uniform_float(rng);
+
+				return sum;
+			}
+
+			template<class RNG>
+			float points_in_ring(RNG& rng, std::vector<glm::vec3>& points, float min_radius)
+			{
+				for (auto& p : points)
+					p = random::point_in_ring_3d(rng, min_radius, 1.f);
+
+				return points.back().x;
+			}
+
+			template<class RNG>
+			float points_in_ring_batch(RNG& rng, std::vector<glm::vec3>& points, float min_radius)
+			{
+				random::points_in_ring_3d(rng, min_radius, 1.f, { points.data(), points.size() });
+
+				return points.back().x;
+			}
+
+		} // unnamed
+
+		void run_random_benchmarks()
+		{
+			auto mt = std::mt19937(12345u);
+			auto pcg = random::pcg32(12345u);
+			auto xoshiro = random::xoshiro256plus(12345u);
+
+			{
+				print_section("random - uniform floats (" + std::to_string(sample_count) + " samples)");
+
+				auto const mt_std = run(run_count, [&] () { consume(uniform_floats_std(mt)); });
+				auto const pcg_std = run(run_count, [&] () { consume(uniform_floats_std(pcg)); });
+				auto const pcg_float = run(run_count, [&] () { consume(uniform_floats(pcg)); });
+				auto const xoshiro_float = run(run_count, [&] () { consume(uniform_floats(xoshiro)); });
+
+				print_result("mt19937 + std::uniform_real_distribution", mt_std);
+				print_result("pcg32 + std::uniform_real_distribution", pcg_std);
+				print_result("pcg32 + uniform_float()", pcg_float);
+				print_result("xoshiro256plus + uniform_float()", xoshiro_float);
+				print_speedup("pcg32 + uniform_float()", mt_std, pcg_float);
+				print_speedup("xoshiro256plus + uniform_float()", mt_std, xoshiro_float);
+			}
+
+			// a solid ball (as the particle effects use) and a ring
+			for (auto const& [min_radius, min_radius_name] : std::vector<std::pair<float, std::string>>{ { 0.f, "0" }, { 0.5f, "0.5" } })
+			{
+				print_section("random - points in a ring (" + std::to_string(sample_count) + " samples, min radius " + min_radius_name + ")");
+
+				auto points = std::vector<glm::vec3>(sample_count);
+
+				auto const mt_single = run(run_count, [&] () { consume(points_in_ring(mt, points, min_radius)); });
+				auto const pcg_single = run(run_count, [&] () { consume(points_in_ring(pcg, points, min_radius)); });
+				auto const xoshiro_single = run(run_count, [&] () { consume(points_in_ring(xoshiro, points, min_radius)); });
+				auto const pcg_batch = run(run_count, [&] () { consume(points_in_ring_batch(pcg, points, min_radius)); });
+				auto const xoshiro_batch = run(run_count, [&] () { consume(points_in_ring_batch(xoshiro, points, min_radius)); });
+
+				print_result("mt19937 + point_in_ring_3d()", mt_single);
+				print_result("pcg32 + point_in_ring_3d()", pcg_single);
+				print_result("xoshiro256plus + point_in_ring_3d()", xoshiro_single);
+				print_result("pcg32 + points_in_ring_3d()", pcg_batch);
+				print_result("xoshiro256plus + points_in_ring_3d()", xoshiro_batch);
+				print_speedup("pcg32 + points_in_ring_3d()", mt_single, pcg_batch);
+				print_speedup("xoshiro256plus + points_in_ring_3d()", mt_single, xoshiro_batch);
+			}
+		}
+
+	} // bench
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "test.hpp"
+
+#include "bump_entity_command_buffer.hpp"
+
+#include <entt.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bump
+{
+
+	namespace test
+	{
+
+		namespace
+		{
+
+			struct thread_value
+			{
+				std::size_t m_thread;
+				std::size_t m_index;
+			};
+
+			struct hit_count
+			{
+				std::uint32_t m_count;
+			};
+
+			auto const thread_count = std::size_t{ 4 };
+			auto const creates_per_thread = std::size_t{ 1000 };
+			auto const existing_count = std::size_t{ 400 }; // each thread destroys a quarter, and adds a component to the others
+
+			// records from one thread per lane, and applies. returns the existing entities.
+			std::vector<entt::entity> record_and_apply(entt::registry& registry)
+			{
+				auto existing = std::vector<entt::entity>(existing_count);
+				registry.create(existing.begin(), existing.end());
+
+				auto commands = entity_command_buffer(thread_count);
+				auto threads = std::vector<std::thread>();
+
+				for (auto t = std::size_t{ 0 }; t != thread_count; ++t)
+				{
+					threads.emplace_back([&, t] ()
+					{
+						auto& lane = commands.get_lane(t);
+
+						for (auto i = std::size_t{ 0 }; i != creates_per_thread; ++i)
+						{
+							auto const id = lane.create();
+							lane.emplace<thread_value>(id, t, i);
+
+							if (i % 10 == 0)
+								lane.destroy(id); // created and destroyed in the same batch
+						}
+
+						for (auto i = t; i < existing.size(); i += thread_count)
+						{
+							if ((i / thread_count) % 4 == 0)
+								lane.destroy(existing[i]);
+							else
+								lane.emplace<hit_count>(existing[i], std::uint32_t(t));
+						}
+					});
+				}
+
+				for (auto& t : threads)
+					t.join();
+
+				check(!commands.is_empty(), "entity_command_buffer is empty after recording");
+
+				commands.apply(registry);
+
+				check(commands.is_empty(), "entity_command_buffer isn't empty after apply()");
+
+				return existing;
+			}
+
+		} // unnamed
+
+		void run_entity_command_buffer_tests()
+		{
+			print_section("entity_command_buffer");
+
+			auto registry = entt::registry();
+			auto const existing = record_and_apply(registry);
+
+			// created entities
+			{
+				auto const view = registry.view<thread_value>();
+				auto const expected = thread_count * (creates_per_thread - creates_per_thread / 10);
+
+				check(view.size() == expected, std::to_string(view.size()) + " created entities (expected " + std::to_string(expected) + ")");
+
+				auto bad_values = std::size_t{ 0 };
+
+				view.each([&] (thread_value const& v)
+				{
+					if (v.m_thread >= thread_count || v.m_index >= creates_per_thread || v.m_index % 10 == 0)
+						++bad_values;
+				});
+
+				check(bad_values == 0, std::to_string(bad_values) + " created entities have the wrong component values");
+			}
+
+			// existing entities
+			{
+				auto destroyed = std::size_t{ 0 };
+				auto wrong = std::size_t{ 0 };
+
+				for (auto i = std::size_t{ 0 }; i != existing.size(); ++i)
+				{
+					auto const should_be_destroyed = ((i / thread_count) % 4 == 0);
+
+					if (!registry.valid(existing[i]))
+					{
+						++destroyed;
+
+						if (!should_be_destroyed)
+							++wrong;
+					}
+					else if (should_be_destroyed || !registry.has<hit_count>(existing[i]) || registry.get<hit_count>(existing[i]).m_count != i % thread_count)
+					{
+						++wrong;
+					}
+				}
+
+				check(destroyed == existing_count / 4, std::to_string(destroyed) + " existing entities destroyed (expected " + std::to_string(existing_count / 4) + ")");
+				check(wrong == 0, std::to_string(wrong) + " existing entities weren't changed by the right thread");
+			}
+
+			// lanes are applied in order, so the same commands give the same entities, however the threads ran
+			{
+				auto other = entt::registry();
+				record_and_apply(other);
+
+				auto same = true;
+
+				registry.view<thread_value>().each([&] (entt::entity id, thread_value const& v)
+				{
+					same = same && other.valid(id) && other.has<thread_value>(id) && other.get<thread_value>(id).m_thread == v.m_thread && other.get<thread_value>(id).m_index == v.m_index;
+				});
+
+				check(same, "applying the same commands twice gave different entities");
+			}
+		}
+
+	} // test
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "test.hpp"
+
+#include "bump_camera.hpp"
+#include "bump_lighting_clusters.hpp"
+#include "bump_random.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bump
+{
+
+	namespace test
+	{
+
+		namespace
+		{
+
+			using lighting::light_clusters;
+
+			camera_matrices make_camera_matrices()
+			{
+				auto camera = perspective_camera();
+				camera.m_projection.m_size = { 1280.f, 720.f };
+				camera.m_projection.m_fov_degrees = 45.f;
+				camera.m_projection.m_near = 0.5f;
+				camera.m_projection.m_far = 200.f;
+
+				return camera_matrices(camera);
+			}
+
+			// the view space point at the given ndc x and y, and view depth (i.e. -z)
+			glm::vec3 unproject(camera_matrices const& matrices, glm::vec2 ndc, float depth)
+			{
+				auto const p = matrices.m_inv_projection * glm::vec4(ndc, -1.f, 1.f);
+				auto const near_point = glm::vec3(p) / p.w;
+
+				return near_point * (depth / -near_point.z);
+			}
+
+			// the cluster containing a view space point (worked out separately from light_clusters)
+			std::size_t get_cluster(camera_matrices const& matrices, glm::size3 grid_size, glm::vec3 point, float z_near, float z_far)
+			{
+				auto const clip = matrices.m_projection * glm::vec4(point, 1.f);
+				auto const ndc = glm::vec2(clip) / clip.w;
+
+				auto const tile = [] (float ndc, std::size_t count) { return std::min(std::size_t(std::max((ndc * 0.5f + 0.5f) * float(count), 0.f)), count - 1); };
+				auto const x = tile(ndc.x, grid_size.x);
+				auto const y = tile(ndc.y, grid_size.y);
+
+				auto const slice = std::floor(float(grid_size.z) * std::log(-point.z / z_near) / std::log(z_far / z_near));
+				auto const z = std::min(std::size_t(std::max(slice, 0.f)), grid_size.z - 1);
+
+				return x + grid_size.x * (y + grid_size.y * z);
+			}
+
+			std::size_t get_light_count(light_clusters const& clusters)
+			{
+				auto count = std::size_t{ 0 };
+
+				for (auto const& range : clusters.get_cluster_ranges())
+					count += range.y;
+
+				return count;
+			}
+
+			bool has_light(light_clusters const& clusters, std::size_t cluster, std::uint32_t light)
+			{
+				auto const range = clusters.get_cluster_ranges().data()[cluster];
+				auto const first = clusters.get_light_indices().data() + range.x;
+
+				return std::find(first, first + range.y, light) != first + range.y;
+			}
+
+		} // unnamed
+
+		void run_lighting_tests()
+		{
+			print_section("lighting");
+
+			auto const matrices = make_camera_matrices();
+			auto const z_near = 0.5f;
+			auto const z_far = 200.f;
+
+			auto clusters = light_clusters({ 16, 9, 24 });
+			clusters.set_camera(matrices);
+
+			auto const grid_size = clusters.get_grid_size();
+			auto const cluster_count = clusters.get_cluster_count();
+
+			// depth slices run from the near plane to the far plane
+			{
+				auto const slice = [&] (float depth) { return std::log(depth) * clusters.get_depth_slice_scale() + clusters.get_depth_slice_bias(); };
+
+				check(std::abs(slice(z_near)) < 1e-3f, "depth slice at the near plane is " + std::to_string(slice(z_near)) + " (expected 0)");
+				check(std::abs(slice(z_far) - float(grid_size.z)) < 1e-3f, "depth slice at the far plane is " + std::to_string(slice(z_far)) + " (expected " + std::to_string(grid_size.z) + ")");
+			}
+
+			// small lights in the middle of a cluster.
+			// note: the cluster bounds are boxes around the frustum-shaped clusters, so away from the view axis
+			// they overlap the neighbouring tiles, and a light can be assigned to them too (it's conservative).
+			{
+				auto const tile_size = glm::vec2(2.f) / glm::vec2(grid_size.x, grid_size.y);
+				auto const depth = z_near * std::pow(z_far / z_near, 10.5f / float(grid_size.z)); // middle of slice 10
+				auto const tile_center = [&] (std::size_t x, std::size_t y) { return glm::vec2(-1.f) + tile_size * (glm::vec2(x, y) + 0.5f); };
+
+				auto const positions = std::vector<glm::vec3>{ unproject(matrices, tile_center(8, 4), depth), unproject(matrices, tile_center(3, 4), depth) };
+				auto const radii = std::vector<float>{ 0.001f, 0.001f };
+
+				// next to the view axis, the light is only in its own cluster
+				{
+					clusters.assign_lights({ positions.data(), 1 }, { radii.data(), 1 });
+
+					auto const expected = 8 + grid_size.x * (4 + grid_size.y * 10);
+
+					check(clusters.get_light_indices().size() == 1, "small light on the view axis is in " + std::to_string(clusters.get_light_indices().size()) + " clusters (expected 1)");
+					check(get_light_count(clusters) == 1, "small light on the view axis: cluster ranges don't add up to one light");
+					check(clusters.get_cluster_ranges().data()[expected] == glm::u32vec2(0, 1), "small light on the view axis isn't in cluster " + std::to_string(expected));
+				}
+
+				// away from the view axis, the light is in its own cluster, and maybe the neighbouring tiles in the same slice
+				{
+					clusters.assign_lights({ positions.data() + 1, 1 }, { radii.data() + 1, 1 });
+
+					auto const expected = 3 + grid_size.x * (4 + grid_size.y * 10);
+					auto const ranges = clusters.get_cluster_ranges();
+					auto neighbours_only = true;
+
+					for (auto i = std::size_t{ 0 }; i != ranges.size(); ++i)
+					{
+						if (ranges.data()[i].y == 0)
+							continue;
+
+						auto const x = i % grid_size.x, y = (i / grid_size.x) % grid_size.y, z = i / (grid_size.x * grid_size.y);
+						neighbours_only = neighbours_only && (z == 10) && (y == 4) && (x >= 2 && x <= 4);
+					}
+
+					check(ranges.data()[expected].y == 1, "small light off the view axis isn't in cluster " + std::to_string(expected));
+					check(neighbours_only, "small light off the view axis is in clusters that aren't next to its own");
+				}
+			}
+
+			// lights outside the frustum depth range aren't in any cluster
+			{
+				auto const positions = std::vector<glm::vec3>{ { 0.f, 0.f, 5.f }, { 0.f, 0.f, -300.f } };
+				auto const radii = std::vector<float>{ 1.f, 1.f };
+				clusters.assign_lights({ positions.data(), positions.size() }, { radii.data(), radii.size() });
+
+				check(clusters.get_light_indices().empty(), "lights behind the camera / past the far plane are in " + std::to_string(clusters.get_light_indices().size()) + " clusters");
+				check(get_light_count(clusters) == 0, "lights outside the frustum: cluster ranges aren't empty");
+			}
+
+			// a light enclosing the frustum is in every cluster
+			{
+				auto const positions = std::vector<glm::vec3>{ { 0.f, 0.f, -100.f } };
+				auto const radii = std::vector<float>{ 1000.f };
+				clusters.assign_lights({ positions.data(), positions.size() }, { radii.data(), radii.size() });
+
+				auto const ranges = clusters.get_cluster_ranges();
+				auto const all = std::all_of(ranges.begin(), ranges.end(), [] (glm::u32vec2 r) { return r.y == 1; });
+
+				check(clusters.get_light_indices().size() == cluster_count, "huge light is in " + std::to_string(clusters.get_light_indices().size()) + " clusters (expected " + std::to_string(cluster_count) + ")");
+				check(all, "huge light: not every cluster has one light");
+			}
+
+			// random lights: each is in the cluster containing its center, and the ranges are packed in cluster order
+			{
+				auto rng = random::pcg32(12345u);
+				auto positions = std::vector<glm::vec3>();
+				auto radii = std::vector<float>();
+
+				for (auto i = 0; i != 200; ++i)
+				{
+					auto const ndc = glm::vec2(random::uniform_float(rng), random::uniform_float(rng)) * 1.9f - 0.95f;
+					auto const depth = z_near + 1.f + random::uniform_float(rng) * (z_far - z_near - 2.f);
+
+					positions.push_back(unproject(matrices, ndc, depth));
+					radii.push_back(0.1f + random::uniform_float(rng) * 5.f);
+				}
+
+				clusters.assign_lights({ positions.data(), positions.size() }, { radii.data(), radii.size() });
+
+				auto missing = std::size_t{ 0 };
+
+				for (auto l = std::size_t{ 0 }; l != positions.size(); ++l)
+					if (!has_light(clusters, get_cluster(matrices, grid_size, positions[l], z_near, z_far), std::uint32_t(l)))
+						++missing;
+
+				check(missing == 0, std::to_string(missing) + " random lights aren't in the cluster containing their center");
+
+				auto const ranges = clusters.get_cluster_ranges();
+				auto const indices = clusters.get_light_indices();
+				auto offset = std::uint32_t{ 0 };
+				auto packed = true;
+				auto sorted = true;
+
+				for (auto const& range : ranges)
+				{
+					packed = packed && (range.x == offset);
+					sorted = sorted && std::is_sorted(indices.data() + range.x, indices.data() + range.x + range.y);
+					offset += range.y;
+				}
+
+				check(packed && offset == indices.size(), "random lights: cluster ranges aren't packed in cluster order");
+				check(sorted, "random lights: light indices aren't in light order within a cluster");
+			}
+		}
+
+	} // test
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "test.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// usage: meteorbumper_test [name...]
+// runs the named tests, or all of them if none are named. returns non-zero if any check fails.
+int main(int argc, char* argv[])
+{
+	using namespace bump;
+
+	auto const tests = std::vector<std::pair<std::string, std::function<void()>>>
+	{
+		{ "random", test::run_random_tests },
+		{ "lighting", test::run_lighting_tests },
+		{ "entity_command_buffer", test::run_entity_command_buffer_tests },
+		{ "radix_sort", test::run_radix_sort_tests },
+		{ "program_cache", test::run_program_cache_tests },
+		{ "render_queue", test::run_render_queue_tests },
+	};
+
+	for (auto const& t : tests)
+	{
+		auto const selected = (argc == 1) || std::any_of(argv + 1, argv + argc, [&] (char const* arg) { return t.first == arg; });
+
+		if (selected)
+			t.second();
+	}
+
+	std::cout << "\n" << (test::get_check_count() - test::get_failure_count()) << " / " << test::get_check_count() << " checks passed" << std::endl;
+
+	return (test::get_failure_count() == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "test.hpp"
+
+#include "bump_gl_program_cache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace bump
+{
+
+	namespace test
+	{
+
+		namespace
+		{
+
+			auto const test_filename = std::string("meteorbumper_test_program_cache.bin");
+
+			gl::program_binary make_binary(GLenum format, std::vector<std::uint8_t> const& bytes)
+			{
+				auto binary = gl::program_binary();
+				binary.m_format = format;
+
+				for (auto b : bytes)
+					binary.m_data.push_back(std::byte{ b });
+
+				return binary;
+			}
+
+			bool is_same(gl::program_binary const* a, gl::program_binary const& b)
+			{
+				return a && a->m_format == b.m_format && a->m_data == b.m_data;
+			}
+
+			std::vector<char> read_bytes(std::string const& filename)
+			{
+				auto file = std::ifstream(filename, std::ios::binary);
+				return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			}
+
+			void write_bytes(std::string const& filename, std::vector<char> const& bytes)
+			{
+				auto file = std::ofstream(filename, std::ios::binary | std::ios::trunc);
+				file.write(bytes.data(), bytes.size());
+			}
+
+		} // unnamed
+
+		void run_program_cache_tests()
+		{
+			print_section("program_cache");
+
+			std::remove(test_filename.c_str());
+
+			auto const vertex = make_binary(0x1234u, { 0u, 1u, 2u, 0u, 255u });
+			auto const fragment = make_binary(0x5678u, { 42u });
+			auto const empty = make_binary(0x9abcu, { });
+
+			// no file gives an empty cache
+			{
+				auto cache = gl::program_cache(test_filename);
+
+				check(cache.get_size() == 0, "program_cache: missing file doesn't give an empty cache");
+				check(cache.find("vertex", 1u) == nullptr, "program_cache: empty cache finds a binary");
+			}
+
+			// round trip
+			{
+				{
+					auto cache = gl::program_cache(test_filename);
+					cache.insert("vertex", 1u, vertex);
+					cache.insert("fragment", 2u, fragment);
+					cache.insert("empty", 3u, empty);
+					check(cache.save(), "program_cache: save() failed");
+				}
+
+				auto cache = gl::program_cache(test_filename);
+
+				check(cache.get_size() == 3, "program_cache: round trip doesn't give 3 binaries");
+				check(is_same(cache.find("vertex", 1u), vertex), "program_cache: round trip changed the \"vertex\" binary");
+				check(is_same(cache.find("fragment", 2u), fragment), "program_cache: round trip changed the \"fragment\" binary");
+				check(is_same(cache.find("empty", 3u), empty), "program_cache: round trip changed the \"empty\" binary");
+				check(cache.find("vertex", 2u) == nullptr, "program_cache: found a binary with the wrong key");
+				check(cache.find("other", 1u) == nullptr, "program_cache: found a binary with the wrong name");
+			}
+
+			auto const good_file = read_bytes(test_filename);
+
+			// binaries that aren't used are dropped on save
+			{
+				{
+					auto cache = gl::program_cache(test_filename);
+					cache.find("vertex", 1u);
+					cache.find("fragment", 99u); // stale key, so not used
+					cache.insert("new", 4u, fragment);
+					check(cache.save(), "program_cache: save() failed");
+				}
+
+				auto cache = gl::program_cache(test_filename);
+
+				check(cache.get_size() == 2, "program_cache: unused binaries weren't dropped on save");
+				check(is_same(cache.find("vertex", 1u), vertex), "program_cache: used binary was dropped on save");
+				check(is_same(cache.find("new", 4u), fragment), "program_cache: inserted binary was dropped on save");
+				check(cache.find("fragment", 2u) == nullptr, "program_cache: unused binary wasn't dropped on save");
+			}
+
+			// truncated files give an empty cache
+			{
+				auto loaded_count = std::size_t{ 0 };
+
+				for (auto size = std::size_t{ 0 }; size != good_file.size(); ++size)
+				{
+					write_bytes(test_filename, std::vector<char>(good_file.begin(), good_file.begin() + size));
+
+					auto cache = gl::program_cache(test_filename);
+					loaded_count += cache.get_size();
+				}
+
+				check(loaded_count == 0, "program_cache: truncated file loaded binaries");
+			}
+
+			// corrupt files give an empty cache
+			{
+				auto const check_corrupt = [&] (std::size_t offset, std::vector<char> const& bytes, std::string const& what)
+				{
+					auto file = good_file;
+					std::copy(bytes.begin(), bytes.end(), file.begin() + offset);
+					write_bytes(test_filename, file);
+
+					auto cache = gl::program_cache(test_filename);
+					check(cache.get_size() == 0, "program_cache: file with " + what + " loaded binaries");
+				};
+
+				auto const huge = std::vector<char>(4, '\xff');
+
+				check_corrupt(0, { 'x' }, "bad magic");
+				check_corrupt(4, { 2 }, "bad version");
+				check_corrupt(8, { 4 }, "too many entries");
+				check_corrupt(12, huge, "huge name size");
+				check_corrupt(12 + 4 + static_cast<std::size_t>(good_file[12]) + 8 + 4, huge, "huge data size"); // after the first name, key, and format
+			}
+
+			std::remove(test_filename.c_str());
+		}
+
+	} // test
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "test.hpp"
+
+#include "bump_radix_sort.hpp"
+#include "bump_random.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace bump
+{
+
+	namespace test
+	{
+
+		namespace
+		{
+
+			std::vector<std::uint32_t> sort_indices(std::vector<std::uint32_t> const& keys, std::uint32_t key_bits = 32u)
+			{
+				auto indices = std::vector<std::uint32_t>();
+				auto scratch = std::vector<std::uint32_t>();
+				radix_sort_indices({ keys.data(), keys.size() }, indices, scratch, key_bits);
+				return indices;
+			}
+
+			// the order std::stable_sort gives (comparing only the low key_bits)
+			std::vector<std::uint32_t> stable_sort_indices(std::vector<std::uint32_t> const& keys, std::uint32_t key_bits = 32u)
+			{
+				auto const mask = (key_bits == 32u) ? 0xffffffffu : ((1u << key_bits) - 1u);
+
+				auto indices = std::vector<std::uint32_t>(keys.size());
+				std::iota(indices.begin(), indices.end(), std::uint32_t{ 0 });
+				std::stable_sort(indices.begin(), indices.end(), [&] (std::uint32_t a, std::uint32_t b) { return (keys[a] & mask) < (keys[b] & mask); });
+				return indices;
+			}
+
+		} // unnamed
+
+		void run_radix_sort_tests()
+		{
+			print_section("radix_sort");
+
+			// float keys order the same way as the floats, including negative values
+			{
+				auto const values = std::vector<float>{ 3.f, -1.f, 0.5f, -1000.f, std::numeric_limits<float>::max(), -0.25f, 1e-30f, -std::numeric_limits<float>::max(), 1000.f, -1e-30f };
+
+				auto keys = std::vector<std::uint32_t>();
+
+				for (auto v : values)
+					keys.push_back(float_to_radix_key(v));
+
+				auto const indices = sort_indices(keys);
+
+				auto sorted = true;
+
+				for (auto i = std::size_t{ 1 }; i < indices.size(); ++i)
+					if (values[indices[i - 1]] > values[indices[i]])
+						sorted = false;
+
+				check(indices.size() == values.size(), "radix_sort_indices() gives one index per key");
+				check(sorted, "float keys with negative values aren't sorted ascending");
+			}
+
+			// -0 and +0 are next to each other (-0 first), with nothing else between them
+			{
+				auto const tiny = std::numeric_limits<float>::denorm_min();
+
+				check(float_to_radix_key(-tiny) < float_to_radix_key(-0.f), "float_to_radix_key(): -denorm_min isn't below -0");
+				check(float_to_radix_key(-0.f) < float_to_radix_key(0.f), "float_to_radix_key(): -0 isn't below +0");
+				check(float_to_radix_key(-0.f) + 1u == float_to_radix_key(0.f), "float_to_radix_key(): -0 and +0 aren't adjacent");
+				check(float_to_radix_key(0.f) < float_to_radix_key(tiny), "float_to_radix_key(): +0 isn't below denorm_min");
+			}
+
+			// equal keys keep their input order
+			{
+				auto const keys = std::vector<std::uint32_t>{ 5u, 1u, 5u, 0xffffffffu, 1u, 5u, 0u, 0xffffffffu, 1u, 0u };
+				auto const expected = std::vector<std::uint32_t>{ 6u, 9u, 1u, 4u, 8u, 0u, 2u, 5u, 3u, 7u };
+
+				check(sort_indices(keys) == expected, "equal keys don't keep their input order");
+			}
+
+			// random keys (with lots of duplicates) match std::stable_sort
+			{
+				auto rng = random::pcg32(7u);
+
+				auto keys = std::vector<std::uint32_t>(10000);
+				auto small_keys = std::vector<std::uint32_t>(10000);
+
+				for (auto& k : keys)
+					k = rng();
+
+				for (auto& k : small_keys)
+					k = rng() & 0x0f0f00ffu; // some digits are the same for every key, so those passes are skipped
+
+				check(sort_indices(keys) == stable_sort_indices(keys), "random keys don't match std::stable_sort");
+				check(sort_indices(small_keys) == stable_sort_indices(small_keys), "random keys with constant digits don't match std::stable_sort");
+			}
+
+			// bucketed (8 bit) keys: a single pass, ignoring the high bits
+			{
+				auto rng = random::pcg32(11u);
+
+				auto keys = std::vector<std::uint32_t>(5000);
+
+				for (auto& k : keys)
+					k = rng(); // high bits set, but only the low 8 should be used
+
+				check(sort_indices(keys, 8u) == stable_sort_indices(keys, 8u), "8 bit keys don't match std::stable_sort on the low 8 bits");
+
+				auto buckets = std::vector<std::uint32_t>{ 255u, 0u, 128u, 0u, 255u, 1u, 128u };
+				auto const expected = std::vector<std::uint32_t>{ 1u, 3u, 5u, 2u, 6u, 0u, 4u };
+
+				check(sort_indices(buckets, 8u) == expected, "8 bit bucket keys aren't sorted stably");
+			}
+
+			// nothing to sort
+			{
+				check(sort_indices({ }).empty(), "radix_sort_indices() of no keys isn't empty");
+				check(sort_indices({ 42u }) == std::vector<std::uint32_t>{ 0u }, "radix_sort_indices() of one key isn't { 0 }");
+			}
+		}
+
+	} // test
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "test.hpp"
+
+#include "bump_random.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace bump
+{
+
+	namespace test
+	{
+
+		namespace
+		{
+
+			std::string to_hex(std::uint32_t value)
+			{
+				auto const digits = "0123456789abcdef";
+				auto out = std::string("0x");
+
+				for (auto shift = 28; shift >= 0; shift -= 4)
+					out += digits[(value >> shift) & 0xfu];
+
+				return out;
+			}
+
+			template<class RNG>
+			void check_uniform_floats(RNG& rng, std::string const& name)
+			{
+				auto min = 1.f;
+				auto max = 0.f;
+				auto sum = 0.;
+				auto const count = 100000;
+
+				for (auto i = 0; i != count; ++i)
+				{
+					auto const f = random::uniform_float(rng);
+					min = std::min(min, f);
+					max = std::max(max, f);
+					sum += f;
+				}
+
+				check(min >= 0.f && max < 1.f, name + ": uniform_float() out of [0, 1)");
+				check(min < 0.001f && max > 0.999f, name + ": uniform_float() doesn't cover [0, 1)");
+				check(std::abs(sum / count - 0.5) < 0.01, name + ": uniform_float() mean is " + std::to_string(sum / count));
+			}
+
+			struct radius_stats
+			{
+				float m_min = std::numeric_limits<float>::max();
+				float m_max = 0.f;
+				float m_mean = 0.f;
+				glm::vec3 m_center = glm::vec3(0.f);
+			};
+
+			radius_stats get_radius_stats(std::vector<glm::vec3> const& points)
+			{
+				auto out = radius_stats();
+
+				for (auto const& p : points)
+				{
+					auto const r = glm::length(p);
+					out.m_min = std::min(out.m_min, r);
+					out.m_max = std::max(out.m_max, r);
+					out.m_mean += r;
+					out.m_center += p;
+				}
+
+				out.m_mean /= float(points.size());
+				out.m_center /= float(points.size());
+
+				return out;
+			}
+
+			// the batch sampler should give the same distribution as the scalar one it replaced
+			template<class RNG>
+			void check_points_in_ring(RNG& rng, std::string const& name, float min_radius, float max_radius)
+			{
+				auto const count = std::size_t{ 100000 };
+
+				auto single = std::vector<glm::vec3>(count);
+
+				for (auto& p : single)
+					p = random::point_in_ring_3d(rng, min_radius, max_radius);
+
+				auto batch = std::vector<glm::vec3>(count);
+				random::points_in_ring_3d(rng, min_radius, max_radius, { batch.data(), batch.size() });
+
+				auto const s = get_radius_stats(single);
+				auto const b = get_radius_stats(batch);
+
+				// the radius is sqrt(u * (max^3 - min^3) + min^3)
+				auto const range_min = std::sqrt(min_radius * min_radius * min_radius);
+				auto const range_max = std::sqrt(max_radius * max_radius * max_radius);
+				auto const tolerance = 0.01f * range_max;
+
+				auto const ring = name + ": points_in_ring_3d(" + std::to_string(min_radius) + ", " + std::to_string(max_radius) + ")";
+				auto const range = [] (radius_stats const& r) { return "[" + std::to_string(r.m_min) + ", " + std::to_string(r.m_max) + "]"; };
+
+				check(s.m_min >= range_min - 1e-4f && s.m_max <= range_max + 1e-4f, ring + ": point_in_ring_3d() radius range is " + range(s));
+				check(b.m_min >= range_min - 1e-4f && b.m_max <= range_max + 1e-4f, ring + ": points_in_ring_3d() radius range is " + range(b));
+				check(std::abs(s.m_min - b.m_min) < tolerance && std::abs(s.m_max - b.m_max) < tolerance, ring + ": radius ranges differ, " + range(s) + " vs. " + range(b));
+				check(std::abs(s.m_mean - b.m_mean) < tolerance, ring + ": mean radius differs, " + std::to_string(s.m_mean) + " vs. " + std::to_string(b.m_mean));
+				check(glm::length(b.m_center) < tolerance, ring + ": points_in_ring_3d() isn't centered on the origin");
+			}
+
+		} // unnamed
+
+		void run_random_tests()
+		{
+			print_section("random");
+
+			// pcg32 against the reference implementation (pcg32-demo: pcg32_srandom_r(&rng, 42u, 54u))
+			{
+				auto const expected = std::vector<std::uint32_t>{ 0xa15c02b7u, 0x7b47f409u, 0xba1d3330u, 0x83d2f293u, 0xbfa4784bu, 0xcbed606eu };
+
+				auto rng = random::pcg32(42u, 54u);
+
+				for (auto i = std::size_t{ 0 }; i != expected.size(); ++i)
+				{
+					auto const value = rng();
+					check(value == expected[i], "pcg32 output " + std::to_string(i) + " is " + to_hex(value) + " (expected " + to_hex(expected[i]) + ")");
+				}
+			}
+
+			// different streams give different sequences
+			{
+				auto a = random::pcg32(42u, 54u);
+				auto b = random::pcg32(42u, 55u);
+
+				check(a() != b(), "pcg32 streams 54 and 55 give the same output");
+			}
+
+			{
+				auto pcg = random::pcg32(12345u);
+				auto xoshiro = random::xoshiro256plus(12345u);
+
+				check_uniform_floats(pcg, "pcg32");
+				check_uniform_floats(xoshiro, "xoshiro256plus");
+
+				check_points_in_ring(pcg, "pcg32", 0.f, 1.f);
+				check_points_in_ring(pcg, "pcg32", 0.f, 0.2f); // e.g. a hit effect spawn radius
+				check_points_in_ring(pcg, "pcg32", 0.5f, 2.f);
+				check_points_in_ring(xoshiro, "xoshiro256plus", 0.f, 1.f);
+				check_points_in_ring(xoshiro, "xoshiro256plus", 0.5f, 2.f);
+			}
+		}
+
+	} // test
+
+} // bump
\ No newline at end of file
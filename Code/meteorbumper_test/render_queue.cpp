@@ -0,0 +1,207 @@
+#include "test.hpp"
+
+#include "bump_gl_render_queue.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bump
+{
+
+	namespace test
+	{
+
+		namespace
+		{
+
+			// stand-ins for the gl objects (the queue only stores pointers to them)
+			struct test_program { };
+			struct test_vertex_array { };
+
+			using queue_type = gl::basic_render_queue<test_program, test_vertex_array>;
+			using backend_type = gl::basic_recording_backend<queue_type>;
+
+			struct test_instance
+			{
+				glm::mat4 m_transform;
+				glm::vec4 m_color;
+			};
+
+			std::vector<std::uint64_t> get_sort_keys(backend_type const& backend)
+			{
+				auto keys = std::vector<std::uint64_t>();
+
+				for (auto const& p : backend.get_packets())
+					keys.push_back(p.m_sort_key);
+
+				return keys;
+			}
+
+		} // unnamed
+
+		void run_render_queue_tests()
+		{
+			print_section("render_queue");
+
+			auto const programs = std::vector<test_program>(2);
+			auto vertex_arrays = std::vector<test_vertex_array>(2);
+
+			auto const blended = queue_type::render_state{ gl::renderer::blending::BLEND, gl::renderer::depth_test::LESS, gl::renderer::depth_write::DISABLED, gl::renderer::face_culling::NONE };
+
+			// sort key layout
+			{
+				check(queue_type::make_sort_key(0u, 0u) == 0u, "make_sort_key(0, 0) isn't 0");
+				check(queue_type::make_sort_key(1u, 2u, 3u, 4u) == ((std::uint64_t{ 4 } << 56) | (std::uint64_t{ 1 } << 40) | (std::uint64_t{ 2 } << 24) | 3u), "make_sort_key() doesn't put the pass, program, vertex array and order in the right bits");
+				check(queue_type::make_sort_key(0x10001u, 0x10002u, 0x1000003u) == queue_type::make_sort_key(1u, 2u, 3u), "make_sort_key() doesn't drop the high bits of the ids and order");
+				check(queue_type::make_sort_key(0u, 0u, 0u, 1u) > queue_type::make_sort_key(0xffffu, 0xffffu, 0xffffffu, 0u), "make_sort_key(): the pass doesn't come before the program");
+				check(queue_type::make_sort_key(1u, 0u) > queue_type::make_sort_key(0u, 0xffffu, 0xffffffu), "make_sort_key(): the program doesn't come before the vertex array");
+			}
+
+			// packets come out in sort key order, with equal keys in submission order
+			{
+				auto queue = queue_type();
+
+				auto const key_a0 = queue_type::make_sort_key(0u, 0u);
+				auto const key_a1 = queue_type::make_sort_key(0u, 1u);
+				auto const key_b0 = queue_type::make_sort_key(1u, 0u);
+				auto const key_b1 = queue_type::make_sort_key(1u, 1u);
+				auto const key_blended = queue_type::make_sort_key(0u, 0u, 7u, 1u);
+
+				// interleaved, so every packet changes the program or vertex array when drawn in submission order
+				queue.set_state(blended);
+				queue.submit_arrays(key_blended, programs[0], vertex_arrays[0], GL_TRIANGLES, 3);
+				queue.set_state({ });
+				queue.submit_arrays(key_b1, programs[1], vertex_arrays[1], GL_TRIANGLES, 3);
+				queue.submit_arrays(key_a0, programs[0], vertex_arrays[0], GL_TRIANGLES, 6);
+				queue.submit_arrays(key_b0, programs[1], vertex_arrays[0], GL_TRIANGLES, 3);
+				queue.submit_arrays(key_a1, programs[0], vertex_arrays[1], GL_TRIANGLES, 3);
+				queue.submit_arrays(key_a0, programs[0], vertex_arrays[0], GL_TRIANGLES, 9);
+				queue.submit_arrays(key_b1, programs[1], vertex_arrays[1], GL_TRIANGLES, 3);
+
+				check(queue.get_size() == 7, "render_queue: get_size() isn't the number of packets submitted");
+
+				// unsorted
+				{
+					auto backend = backend_type();
+					queue.execute(backend);
+
+					auto const& stats = backend.get_stats();
+
+					check(get_sort_keys(backend) == std::vector<std::uint64_t>{ key_blended, key_b1, key_a0, key_b0, key_a1, key_a0, key_b1 }, "render_queue: unsorted packets aren't in submission order");
+					check(stats.m_draws == 7, "render_queue: unsorted queue doesn't draw 7 packets");
+					check(stats.m_state_changes == 2, "render_queue: unsorted queue doesn't change state twice");
+					check(stats.m_program_changes == 6, "render_queue: unsorted queue doesn't change program 6 times");
+					check(stats.m_vertex_array_changes == 6, "render_queue: unsorted queue doesn't change vertex array 6 times");
+				}
+
+				queue.sort();
+
+				// sorted
+				{
+					auto backend = backend_type();
+					queue.execute(backend);
+
+					auto const& stats = backend.get_stats();
+					auto const& packets = backend.get_packets();
+
+					check(get_sort_keys(backend) == std::vector<std::uint64_t>{ key_a0, key_a0, key_a1, key_b0, key_b1, key_b1, key_blended }, "render_queue: sorted packets aren't in sort key order");
+					check(packets.size() == 7 && packets[0].m_element_count == 6 && packets[1].m_element_count == 9, "render_queue: packets with the same key aren't in submission order");
+					check(stats.m_draws == 7, "render_queue: sorted queue doesn't draw 7 packets");
+					check(stats.m_state_changes == 1, "render_queue: sorted queue doesn't change state once");
+					check(stats.m_program_changes == 3, "render_queue: sorted queue doesn't change program 3 times");
+					check(stats.m_vertex_array_changes == 5, "render_queue: sorted queue doesn't change vertex array 5 times");
+					check(packets.size() == 7 && packets[6].m_state.m_blending == gl::renderer::blending::BLEND && packets[0].m_state.m_blending == gl::renderer::blending::NONE, "render_queue: packets don't keep the render state they were submitted with");
+				}
+
+				queue.clear();
+
+				check(queue.is_empty(), "render_queue: clear() doesn't empty the queue");
+				check(queue.get_state().m_blending == gl::renderer::blending::NONE, "render_queue: clear() doesn't reset the render state");
+			}
+
+			// uniforms, instance data and attributes stay with their packet when sorted
+			{
+				auto queue = queue_type();
+
+				queue.add_uniform(0, 1.f);
+				queue.add_uniform(1, glm::vec3(2.f));
+
+				auto const first = queue.add_instances<test_instance>(3);
+
+				for (auto i = std::size_t{ 0 }; i != first.size(); ++i)
+					first.at(i) = { glm::mat4(1.f), glm::vec4(static_cast<float>(i)) };
+
+				queue.add_instance_attribute(4, 0, 4, 4);
+				queue.add_instance_attribute(8, sizeof(glm::mat4), 4, 1);
+				queue.submit_indexed(queue_type::make_sort_key(1u, 0u), programs[1], vertex_arrays[0], GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, first.size());
+
+				queue.add_uniform(2, std::int32_t{ 5 });
+				queue.submit_indexed(queue_type::make_sort_key(0u, 0u), programs[0], vertex_arrays[0], GL_TRIANGLES, 12, GL_UNSIGNED_SHORT);
+
+				queue.sort();
+
+				auto backend = backend_type();
+				queue.execute(backend);
+
+				auto const& stats = backend.get_stats();
+				auto const& packets = backend.get_packets();
+
+				check(packets.size() == 2, "render_queue: doesn't draw 2 packets");
+
+				if (packets.size() == 2)
+				{
+					auto const uniforms_0 = queue.get_uniforms(packets[0]);
+					auto const uniforms_1 = queue.get_uniforms(packets[1]);
+					auto const attributes_1 = queue.get_instance_attributes(packets[1]);
+					auto const data_1 = queue.get_instance_data(packets[1]);
+
+					check(uniforms_0.size() == 1 && uniforms_0.at(0).m_location == 2, "render_queue: sorted packet has the wrong uniforms");
+					check(uniforms_1.size() == 2 && uniforms_1.at(0).m_location == 0 && uniforms_1.at(1).m_location == 1, "render_queue: sorted packet has the wrong uniforms");
+					check(queue.get_instance_data(packets[0]).empty() && queue.get_instance_attributes(packets[0]).empty(), "render_queue: packet without instances has instance data");
+					check(packets[1].m_instance_size * sizeof(float) == sizeof(test_instance), "render_queue: instance size isn't the size of the instance type");
+					check(data_1.size_bytes() == 3 * sizeof(test_instance), "render_queue: instance data isn't 3 instances");
+					check(data_1.size_bytes() == 3 * sizeof(test_instance) && data_1.at(packets[1].m_instance_size * 2 + 16) == 2.f, "render_queue: instance data wasn't kept");
+					check(attributes_1.size() == 2 && attributes_1.at(0).m_location == 4 && attributes_1.at(1).m_offset_bytes == sizeof(glm::mat4), "render_queue: sorted packet has the wrong instance attributes");
+				}
+
+				check(stats.m_uniforms == 3, "render_queue: doesn't draw with 3 uniforms");
+				check(stats.m_instances == 4, "render_queue: doesn't draw 4 instances");
+				check(stats.m_instance_data_bytes == 3 * sizeof(test_instance), "render_queue: doesn't upload 3 instances");
+			}
+
+			// indirect draws
+			{
+				auto queue = queue_type();
+
+				auto const commands = std::vector<gl::draw_indexed_indirect_command>
+				{
+					{ 36, 2, 0, 0, 0 },
+					{ 12, 5, 36, 24, 2 },
+				};
+
+				auto instances = queue.add_instances<glm::vec4>(7);
+				std::fill(instances.begin(), instances.end(), glm::vec4(1.f));
+				queue.add_instance_attribute(3, 0, 4, 1);
+				queue.submit_indexed_indirect(queue_type::make_sort_key(0u, 0u), programs[0], vertex_arrays[0], GL_TRIANGLES, GL_UNSIGNED_INT, { commands.data(), commands.size() });
+				queue.submit_indexed(queue_type::make_sort_key(0u, 1u), programs[0], vertex_arrays[1], GL_TRIANGLES, 6, GL_UNSIGNED_INT, 3);
+
+				auto backend = backend_type();
+				queue.execute(backend);
+
+				auto const& stats = backend.get_stats();
+				auto const& packets = backend.get_packets();
+
+				check(stats.m_draws == 2, "render_queue: indirect packet isn't one draw");
+				check(stats.m_indirect_commands == 2, "render_queue: doesn't draw 2 indirect commands");
+				check(stats.m_instances == 10, "render_queue: indirect commands' instances aren't counted");
+				check(packets.size() == 2 && queue.get_commands(packets[0]).size() == 2 && queue.get_commands(packets[0]).at(1).m_base_instance == 2, "render_queue: indirect commands weren't copied into the queue");
+				check(packets.size() == 2 && queue.get_commands(packets[1]).empty(), "render_queue: indexed packet has indirect commands");
+			}
+		}
+
+	} // test
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "test.hpp"
+
+#include <iostream>
+
+namespace bump
+{
+
+	namespace test
+	{
+
+		namespace
+		{
+
+			std::size_t g_check_count = 0;
+			std::size_t g_failure_count = 0;
+
+		} // unnamed
+
+		void check(bool condition, std::string const& message)
+		{
+			++g_check_count;
+
+			if (condition)
+				return;
+
+			++g_failure_count;
+			std::cout << "  FAILED: " << message << "\n";
+		}
+
+		std::size_t get_check_count()
+		{
+			return g_check_count;
+		}
+
+		std::size_t get_failure_count()
+		{
+			return g_failure_count;
+		}
+
+		void print_section(std::string const& name)
+		{
+			std::cout << "\n" << name << ":\n";
+		}
+
+	} // test
+
+} // bump
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace bump
+{
+
+	namespace test
+	{
+
+		// records a failure (and prints the message) if condition is false.
+		// note: doesn't stop the test, so all the failures in a run are printed.
+		void check(bool condition, std::string const& message);
+
+		std::size_t get_check_count();
+		std::size_t get_failure_count();
+
+		void print_section(std::string const& name);
+
+		// the tests (one per area of the game):
+		void run_random_tests();
+		void run_lighting_tests();
+		void run_entity_command_buffer_tests();
+		void run_radix_sort_tests();
+		void run_program_cache_tests();
+		void run_render_queue_tests();
+
+	} // test
+
+} // bump
\ No newline at end of file
@@ -2,11 +2,13 @@
 
 in vec3 in_VertexPosition;
 in vec3 in_VertexNormal;
-in mat4 in_MVP;
-in mat3 in_NormalMatrix;
+in mat4 in_Transform;
 in vec3 in_Color;
 in float in_Scale;
 
+uniform mat4 u_ViewProjection;
+uniform mat4 u_View;
+
 out vec3 vert_Color;
 out vec3 vert_Normal;
 out vec2 vert_Depth;
@@ -14,8 +16,8 @@ out vec2 vert_Depth;
 void main()
 {
 	vert_Color = in_Color;
-	vert_Normal = in_NormalMatrix * in_VertexNormal;
+	vert_Normal = mat3(u_View) * mat3(in_Transform) * in_VertexNormal; // note: asteroid transforms are rigid (scale is separate)
 
-	gl_Position = in_MVP * vec4(in_VertexPosition * in_Scale, 1.0);
+	gl_Position = u_ViewProjection * in_Transform * vec4(in_VertexPosition * in_Scale, 1.0);
 	vert_Depth = gl_Position.zw;
 }
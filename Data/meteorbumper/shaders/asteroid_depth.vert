@@ -1,10 +1,12 @@
 #version 400
 
 in vec3 in_VertexPosition;
-in mat4 in_MVP;
+in mat4 in_Transform;
 in float in_Scale;
 
+uniform mat4 u_ViewProjection;
+
 void main()
 {
-	gl_Position = in_MVP * vec4(in_VertexPosition * in_Scale, 1.0);
+	gl_Position = u_ViewProjection * in_Transform * vec4(in_VertexPosition * in_Scale, 1.0);
 }
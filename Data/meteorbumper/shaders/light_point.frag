@@ -12,33 +12,67 @@ void g_get_material(const in vec2 tex_coords, out float metallic, out float roug
 float attenuation_inv_sqr(float l_distance);
 vec3 cook_torrance(vec3 n, vec3 v, vec3 l, vec3 l_color, vec3 albedo, float metallic, float roughness, float emissive);
 
-in vec3 vert_LightPosition; // vs
-in vec3 vert_LightColor;
-in float vert_LightRadius;
-
 uniform mat4 u_InvProjMatrix;
 
+// clusters (see lighting::light_clusters)
+uniform uvec3 u_ClusterGridSize;
+uniform float u_ClusterDepthScale; // depth slice = floor(log(depth) * scale + bias)
+uniform float u_ClusterDepthBias;
+uniform usamplerBuffer u_ClusterRanges; // offset, count in u_LightIndices
+uniform usamplerBuffer u_LightIndices;
+uniform samplerBuffer u_LightPositions; // vs position, radius
+uniform samplerBuffer u_LightColors;
+
 layout(location = 0) out vec4 out_Color;
 
 void main()
 {
 	vec2 uv = gl_FragCoord.xy / g_get_target_size();
 
-	vec3  c = vert_LightColor;
-	vec3  o = vert_LightPosition;
-	float r = vert_LightRadius;
+	vec3 p = g_get_vs_position(uv, g_get_depth(uv), u_InvProjMatrix);
+
+	if (-p.z <= 0.0)
+		discard;
+
+	float slice = floor(log(-p.z) * u_ClusterDepthScale + u_ClusterDepthBias);
+
+	if (slice < 0.0 || slice >= float(u_ClusterGridSize.z))
+		discard; // outside the clusters (e.g. the skybox)
+
+	uvec2 tile = min(uvec2(uv * vec2(u_ClusterGridSize.xy)), u_ClusterGridSize.xy - uvec2(1u));
+	uint cluster = tile.x + u_ClusterGridSize.x * (tile.y + u_ClusterGridSize.y * uint(slice));
+
+	uvec2 range = texelFetch(u_ClusterRanges, int(cluster)).xy;
+
+	if (range.y == 0u)
+		discard;
 
 	vec3 d = g_get_diffuse(uv);
 	vec3 n = g_get_normal(uv);
-	vec3 p = g_get_vs_position(uv, g_get_depth(uv), u_InvProjMatrix);
 	vec3 v = normalize(-p); // pixel to viewer
-	vec3 l = normalize(o - p); // pixel to light
 
 	float metallic, roughness, emissive;
 	g_get_material(uv, metallic, roughness, emissive);
-	
-	float a = attenuation_inv_sqr(length(o - p));
-	vec3 color = cook_torrance(n, v, l, c * a, d, metallic, roughness, emissive);
+
+	vec3 color = vec3(0.0);
+
+	for (uint i = range.x; i != range.x + range.y; ++i)
+	{
+		int light = int(texelFetch(u_LightIndices, int(i)).x);
+
+		vec4 o_r = texelFetch(u_LightPositions, light);
+		vec3 c = texelFetch(u_LightColors, light).rgb;
+
+		float l_distance = length(o_r.xyz - p);
+
+		if (l_distance > o_r.w)
+			continue; // outside the light's radius
+
+		vec3 l = (o_r.xyz - p) / l_distance; // pixel to light
+
+		float a = attenuation_inv_sqr(l_distance);
+		color += cook_torrance(n, v, l, c * a, d, metallic, roughness, emissive);
+	}
 
 	out_Color = vec4(color, 1.0);
 }
@@ -3,16 +3,22 @@
 in vec3 in_Position;
 in vec4 in_Color;
 in float in_Size;
+in uint in_EffectIndex;
 
 uniform mat4 u_MVP;
 
+const int effect_max = 16;
+uniform float u_EnableShadows[effect_max];
+
 out vec4 vert_Color;
 out vec3 vert_Position;
+flat out float vert_EnableShadows;
 
 void main()
 {
 	vert_Color = in_Color;
 	vert_Position = in_Position;
+	vert_EnableShadows = u_EnableShadows[in_EffectIndex];
 
 	gl_PointSize = in_Size;
 	gl_Position = u_MVP * vec4(in_Position, 1.0);
@@ -513,6 +513,49 @@ class PlatformMSVC:
 		normals_test.inc_dirs = [ glm.code_dir ]
 		self.write_exe(n, build_type, normals_test)
 
+		# benchmarks for game code that doesn't need a window or gpu (the game sources are compiled in directly)
+		meteorbumper_bench = ProjectExe.from_name('meteorbumper_bench', self, build_type)
+		meteorbumper_bench.defines = glm.defines
+		meteorbumper_bench.src_files += [ join_file(meteorbumper.code_dir, f) for f in [
+			'bump_camera.cpp',
+			'bump_color_map.cpp',
+			'bump_die.cpp',
+			'bump_entity_pool.cpp',
+			'bump_lighting_clusters.cpp',
+			'bump_log.cpp',
+			'bump_physics_collider.cpp',
+			'bump_physics_rigidbody.cpp',
+			'bump_transform.cpp',
+		] ]
+		meteorbumper_bench.inc_dirs = [
+			meteorbumper.code_dir,
+			entt.code_dir,
+			glm.code_dir,
+			tracy.code_dir,
+		]
+		self.write_exe(n, build_type, meteorbumper_bench)
+
+		# tests for game code that doesn't need a window or gpu (as above)
+		meteorbumper_test = ProjectExe.from_name('meteorbumper_test', self, build_type)
+		meteorbumper_test.defines = glew.defines + glm.defines
+		meteorbumper_test.src_files += [ join_file(meteorbumper.code_dir, f) for f in [
+			'bump_camera.cpp',
+			'bump_die.cpp',
+			'bump_entity_command_buffer.cpp',
+			'bump_gl_program_cache.cpp',
+			'bump_lighting_clusters.cpp',
+			'bump_log.cpp',
+			'bump_radix_sort.cpp',
+		] ]
+		meteorbumper_test.inc_dirs = [
+			meteorbumper.code_dir,
+			entt.code_dir,
+			glew.code_dir,
+			glm.code_dir,
+			tracy.code_dir,
+		]
+		self.write_exe(n, build_type, meteorbumper_test)
+
 
 class PlatformGCC:
 